@@ -12,15 +12,16 @@ if [[ $JOB_NAME == *"code-coverage" ]]; then
 fi
 
 if [[ $JOB_NAME != *"code-coverage" && $JOB_NAME != *"limited-build" ]]; then
-    # Build in release mode with tests
-    ./waf --color=yes configure --with-tests
+    # Build in release mode with tests and benchmarks
+    ./waf --color=yes configure --with-tests --with-benchmarks
     ./waf --color=yes build -j$WAF_JOBS
 
     # Cleanup
     ./waf --color=yes distclean
 
-    # Build in release mode without tests
-    ./waf --color=yes configure
+    # Build in release mode with benchmarks but without tests, as the benchmarks must not
+    # depend on the members that only tests can access
+    ./waf --color=yes configure --with-benchmarks
     ./waf --color=yes build -j$WAF_JOBS
 
     # Cleanup
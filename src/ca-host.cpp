@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "ca-host.hpp"
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+NDN_LOG_INIT(ndncert.ca.host);
+
+CaHost::CaHost(Face& face, security::KeyChain& keyChain, const std::string& configPath,
+               const std::string& storageType)
+  : m_face(face)
+{
+  m_config.load(configPath);
+  if (m_config.nWorkerThreads > 0) {
+    m_resources.workerPool = make_shared<WorkerPool>(m_config.nWorkerThreads);
+  }
+  m_resources.keyChains = make_shared<WorkerKeyChains>(keyChain, m_config.nWorkerThreads);
+  m_resources.eventBus = make_shared<EventBus>();
+  // with a single CA the storage stays where that CA alone would keep it
+  Name storageName("ca-host");
+  if (m_config.caConfigFiles.size() == 1) {
+    CaConfig caConfig;
+    caConfig.load(m_config.caConfigFiles.front());
+    storageName = caConfig.caProfile.caPrefix;
+  }
+  m_resources.storage = CaStorage::createCaStorage(storageType, storageName, m_config.storagePath);
+
+  for (const auto& caConfigFile : m_config.caConfigFiles) {
+    auto ca = std::make_unique<CaModule>(face, keyChain, caConfigFile, m_resources);
+    const auto& caPrefix = ca->getCaConf().caProfile.caPrefix;
+    if (m_cas.count(caPrefix) > 0) {
+      NDN_THROW(std::runtime_error("CA " + caPrefix.toUri() + " is configured more than once"));
+    }
+    m_cas.emplace(caPrefix, std::move(ca));
+  }
+
+  for (const auto& ca : m_cas) {
+    const CaModule& module = *ca.second;
+    m_registeredPrefixHandles.push_back(m_face.setInterestFilter(Name(ca.first).append("CA"),
+      [this, &module] (const InterestFilter&, const Interest& interest) { onInterest(module, interest); },
+      [this] (const Name& prefix, const std::string& reason) { onRegisterFailed(prefix, reason); }));
+  }
+  NDN_LOG_INFO("Hosting " << m_cas.size() << " CAs on " << m_config.nWorkerThreads << " worker threads");
+}
+
+CaHost::~CaHost()
+{
+  // the queued requests of all CAs must finish before any CA goes away
+  if (m_resources.workerPool != nullptr) {
+    m_resources.workerPool->join();
+  }
+  for (auto& handle : m_registeredPrefixHandles) {
+    handle.unregister();
+  }
+}
+
+void
+CaHost::forEachCa(const function<void(CaModule&)>& func)
+{
+  for (auto& ca : m_cas) {
+    func(*ca.second);
+  }
+}
+
+CaModule*
+CaHost::findCa(const Name& name) const
+{
+  for (size_t prefixLength = name.size() + 1; prefixLength-- > 0;) {
+    auto it = m_cas.find(name.getPrefix(prefixLength));
+    if (it != m_cas.end()) {
+      return it->second.get();
+    }
+  }
+  return nullptr;
+}
+
+std::vector<MetricSample>
+CaHost::collectMetrics() const
+{
+  std::vector<MetricSample> samples;
+  for (const auto& ca : m_cas) {
+    for (auto& sample : ca.second->collectMetrics()) {
+      sample.labels.emplace(sample.labels.begin(), "ca", ca.first.toUri());
+      samples.push_back(std::move(sample));
+    }
+  }
+  // the bus is shared by all hosted CAs, so its sample carries no CA label
+  samples.push_back({"ndncert_event_bus_dropped_total", {},
+                     static_cast<double>(m_resources.eventBus->getDroppedCount())});
+  return samples;
+}
+
+void
+CaHost::onInterest(const CaModule& ca, const Interest& interest)
+{
+  // the filters of nested CA prefixes may all match; only the CA with the longest prefix answers
+  auto target = findCa(interest.getName());
+  if (target != &ca) {
+    return;
+  }
+  target->handleInterest(interest);
+}
+
+void
+CaHost::onRegisterFailed(const Name& prefix, const std::string& reason)
+{
+  NDN_LOG_ERROR("Failed to register prefix " << prefix << " in local hub's daemon, REASON: " << reason);
+}
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_CA_HOST_HPP
+#define NDNCERT_CA_HOST_HPP
+
+#include "ca-module.hpp"
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+/**
+ * @brief Hosts several CAs on one face.
+ *
+ * The CAs listed in a CaHostConfig share the face, the worker threads with their KeyChains, and
+ * one storage, in which the requests of each CA are kept under its CA name. An Interest is
+ * handled by the CA with the longest prefix matching its name.
+ */
+class CaHost : noncopyable
+{
+public:
+  /**
+   * @param configPath a CaHostConfig file, or the configuration of a single CA
+   */
+  CaHost(Face& face, security::KeyChain& keyChain, const std::string& configPath,
+         const std::string& storageType = "ca-storage-sqlite3");
+
+  ~CaHost();
+
+  const CaHostConfig&
+  getConfig() const
+  {
+    return m_config;
+  }
+
+  size_t
+  getCaCount() const
+  {
+    return m_cas.size();
+  }
+
+  /**
+   * @brief Invoke @p func for each hosted CA, in the order of their prefixes.
+   */
+  void
+  forEachCa(const function<void(CaModule&)>& func);
+
+  /**
+   * @brief Find the CA whose prefix is the longest prefix of @p name.
+   * @return the CA, or nullptr if no CA prefix matches
+   */
+  CaModule*
+  findCa(const Name& name) const;
+
+  const shared_ptr<CaStorage>&
+  getCaStorage() const
+  {
+    return m_resources.storage;
+  }
+
+  /**
+   * @brief The bus shared by all hosted CAs for the status events of their requests.
+   */
+  EventBus&
+  getEventBus()
+  {
+    return *m_resources.eventBus;
+  }
+
+  /**
+   * @brief Collect the metrics of all hosted CAs, each sample labeled with its CA prefix,
+   *        and the number of events dropped by the shared event bus.
+   */
+  std::vector<MetricSample>
+  collectMetrics() const;
+
+private:
+  void
+  onInterest(const CaModule& ca, const Interest& interest);
+
+  void
+  onRegisterFailed(const Name& prefix, const std::string& reason);
+
+private:
+  Face& m_face;
+  CaHostConfig m_config;
+  CaSharedResources m_resources;
+  std::map<Name, unique_ptr<CaModule>> m_cas;
+  std::list<RegisteredPrefixHandle> m_registeredPrefixHandles;
+};
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_CA_HOST_HPP
@@ -25,6 +25,7 @@
 #include "detail/challenge-encoder.hpp"
 #include "detail/error-encoder.hpp"
 #include "detail/info-encoder.hpp"
+#include "detail/log-encoder.hpp"
 #include "detail/request-encoder.hpp"
 #include "detail/probe-encoder.hpp"
 #include <ndn-cxx/metadata-object.hpp>
@@ -33,33 +34,66 @@
 #include <ndn-cxx/util/io.hpp>
 #include <ndn-cxx/util/random.hpp>
 #include <ndn-cxx/util/string-helper.hpp>
+#include <boost/lexical_cast.hpp>
 
 namespace ndn {
 namespace ndncert {
 namespace ca {
 
 static const time::seconds DEFAULT_DATA_FRESHNESS_PERIOD = 1_s;
+// the INFO packet is versioned and never changes under the same version
+static const time::seconds INFO_DATA_FRESHNESS_PERIOD = 1_h;
+// the metadata points to the latest INFO version and must expire soon after a regeneration
+static const time::seconds METADATA_FRESHNESS_PERIOD = 1_s;
+// a metrics snapshot is reused for this long, so polling the dataset does not cost a signature each time
+static const time::seconds METRICS_SNAPSHOT_PERIOD = 1_s;
+static const size_t METRICS_SEGMENT_SIZE = 4096;
 static const time::seconds REQUEST_VALIDITY_PERIOD_NOT_BEFORE_GRACE_PERIOD = 120_s;
+// a RELOAD Interest is accepted only if its signature time is this close to the clock of the CA
+static const time::seconds RELOAD_SIGNATURE_TIME_GRACE_PERIOD = 60_s;
 
 NDN_LOG_INIT(ndncert.ca);
 
 CaModule::CaModule(Face& face, security::KeyChain& keyChain,
                    const std::string& configPath, const std::string& storageType)
   : m_face(face)
+  , m_configPath(configPath)
   , m_keyChain(keyChain)
 {
   // load the config and create storage
-  m_config.load(configPath);
-  m_storage = CaStorage::createCaStorage(storageType, m_config.caProfile.caPrefix, "");
-  random::generateSecureBytes(m_requestIdGenKey, 32);
-  if (m_config.nameAssignmentFuncs.size() == 0) {
-    m_config.nameAssignmentFuncs.push_back(NameAssignmentFunc::createNameAssignmentFunc("random"));
+  CaConfig config;
+  config.load(configPath);
+  CaSharedResources resources;
+  resources.storage = CaStorage::createCaStorage(storageType, config.caProfile.caPrefix, "");
+  if (config.nWorkerThreads > 0) {
+    resources.workerPool = make_shared<WorkerPool>(config.nWorkerThreads);
+    NDN_LOG_INFO("Processing requests on " << config.nWorkerThreads << " worker threads");
   }
+  resources.keyChains = make_shared<WorkerKeyChains>(m_keyChain, config.nWorkerThreads);
+  initialize(resources, std::move(config));
   registerPrefix();
 }
 
+CaModule::CaModule(Face& face, security::KeyChain& keyChain, const std::string& configPath,
+                   const CaSharedResources& resources)
+  : m_face(face)
+  , m_configPath(configPath)
+  , m_keyChain(keyChain)
+{
+  CaConfig config;
+  config.load(configPath);
+  initialize(resources, std::move(config));
+}
+
 CaModule::~CaModule()
 {
+  // a reload that has not been applied yet is not applied anymore, but its thread must finish
+  if (m_reloadThread.joinable()) {
+    m_reloadThread.join();
+  }
+  // finish the requests being processed while everything they use is still there;
+  // a pool shared with other CAs has already been joined by its host
+  m_workerPool.reset();
   for (auto& handle : m_interestFilterHandles) {
     handle.cancel();
   }
@@ -68,11 +102,154 @@ CaModule::~CaModule()
   }
 }
 
+void
+CaModule::initialize(const CaSharedResources& resources, CaConfig&& config)
+{
+  m_caPrefix = config.caProfile.caPrefix;
+  // encoded once, so the copies in request states and the storage share the encoding,
+  // and worker threads never encode it concurrently
+  m_caPrefix.wireEncode();
+  m_caPrefixSize = m_caPrefix.size();
+  m_storage = resources.storage;
+  m_workerPool = resources.workerPool;
+  m_keyChains = resources.keyChains;
+  if (m_keyChains == nullptr) {
+    m_keyChains = make_shared<WorkerKeyChains>(m_keyChain, 0);
+  }
+  m_eventBus = resources.eventBus;
+  if (m_eventBus == nullptr) {
+    m_eventBus = make_shared<EventBus>();
+  }
+  // the key is kept in the storage, so that request IDs stay valid across restarts and reloads
+  auto requestIdKey = m_storage->getRequestIdKey(m_caPrefix);
+  if (requestIdKey.size() != sizeof(m_requestIdGenKey)) {
+    NDN_THROW(std::runtime_error("The request ID key of " + m_caPrefix.toUri() + " has a wrong size"));
+  }
+  std::memcpy(m_requestIdGenKey, requestIdKey.data(), sizeof(m_requestIdGenKey));
+  if (!config.issuanceLogPath.empty()) {
+    m_issuanceLog = std::make_unique<IssuanceLog>(config.issuanceLogPath);
+  }
+  for (const auto& requestState : m_storage->listAllRequests(m_caPrefix)) {
+    if (requestState.requestType != RequestType::REVOKE) {
+      m_identityIndex.addPending(requestState.requestId, requestState.cert.getIdentity());
+    }
+  }
+  applyConfigState(makeConfigState(std::move(config)));
+}
+
+shared_ptr<const CaModule::ConfigState>
+CaModule::makeConfigState(CaConfig&& config) const
+{
+  auto state = make_shared<ConfigState>();
+  state->config = std::move(config);
+  if (state->config.nameAssignmentFuncs.size() == 0) {
+    state->config.nameAssignmentFuncs.push_back(NameAssignmentFunc::createNameAssignmentFunc("random"));
+  }
+  for (const auto& func : state->config.nameAssignmentFuncs) {
+    state->isProbeCacheable = state->isProbeCacheable && func->isDeterministic();
+  }
+  const auto& caProfile = state->config.caProfile;
+  state->challengeBlocks = requesttlv::encodeChallengeList(caProfile.supportedChallenges);
+  state->redirectionBlocks = probetlv::encodeRedirectionList(state->config.redirection);
+  // a challenge module may keep state, such as the parsed trust anchors, so threads do not share them
+  state->challenges.resize(getWorkerCount() + 1);
+  for (auto& challenges : state->challenges) {
+    std::vector<std::pair<std::string, unique_ptr<ChallengeModule>>> entries;
+    for (const auto& challengeType : caProfile.supportedChallenges) {
+      auto configPath = state->config.challengeConfigPaths.find(challengeType);
+      auto challenge = ChallengeModule::createChallengeModule(challengeType,
+        configPath == state->config.challengeConfigPaths.end() ? "" : configPath->second);
+      if (challenge != nullptr) {
+        entries.emplace_back(challengeType, std::move(challenge));
+      }
+    }
+    challenges = PerfectHashMap<unique_ptr<ChallengeModule>>(std::move(entries));
+  }
+  return state;
+}
+
+void
+CaModule::applyConfigState(shared_ptr<const ConfigState> state)
+{
+  bool isReload = m_configState != nullptr;
+  m_admissionController.setPolicy(state->config.admissionPolicy);
+  std::atomic_store(&m_configState, std::move(state));
+  invalidateCaProfileData();
+  if (isReload) {
+    // sign the new INFO packet right away rather than on the first request after the reload
+    getCaProfileData();
+    NDN_LOG_INFO("Configuration of " << m_caPrefix << " reloaded from " << m_configPath);
+  }
+}
+
+void
+CaModule::reloadConfig(const ReloadCallback& onDone)
+{
+  if (onDone) {
+    m_reloadCallbacks.push_back(onDone);
+  }
+  if (m_isReloading) {
+    // a reload requested while another one is running rereads the file once the current one is
+    // applied; any number of such requests are served by that single extra reload
+    m_isReloadQueued = true;
+    return;
+  }
+  m_isReloading = true;
+  // the callbacks of the requests made so far are answered with the outcome of this reload
+  auto callbacks = std::move(m_reloadCallbacks);
+  m_reloadCallbacks.clear();
+
+  // parsing the configuration and creating the challenge modules may take a while,
+  // so it is done on a thread of its own while requests keep being served
+  m_reloadThread = std::thread([this, callbacks, lifetime = weak_ptr<char>(m_lifetimeToken)] {
+    shared_ptr<const ConfigState> state;
+    std::string error;
+    try {
+      CaConfig config;
+      config.load(m_configPath);
+      if (config.caProfile.caPrefix != m_caPrefix) {
+        NDN_THROW(std::runtime_error("The CA prefix cannot be changed by a reload"));
+      }
+      state = makeConfigState(std::move(config));
+    }
+    catch (const std::exception& e) {
+      error = e.what();
+    }
+    m_face.getIoService().post([this, callbacks, lifetime, state, error] {
+      if (lifetime.expired()) {
+        return;
+      }
+      // the thread has nothing left to do but return, so this does not hold up the face
+      m_reloadThread.join();
+      m_isReloading = false;
+      if (state != nullptr) {
+        if (state->config.nWorkerThreads != getConfigState()->config.nWorkerThreads) {
+          NDN_LOG_WARN("The number of worker threads takes effect after a restart");
+        }
+        if (state->config.issuanceLogPath != getConfigState()->config.issuanceLogPath) {
+          NDN_LOG_WARN("The issuance log takes effect after a restart");
+        }
+        applyConfigState(state);
+      }
+      else {
+        NDN_LOG_ERROR("Cannot reload the configuration of " << m_caPrefix << ": " << error);
+      }
+      for (const auto& onDone : callbacks) {
+        onDone(error);
+      }
+      if (m_isReloadQueued) {
+        m_isReloadQueued = false;
+        reloadConfig();
+      }
+    });
+  });
+}
+
 void
 CaModule::registerPrefix()
 {
   // register prefixes
-  Name prefix = m_config.caProfile.caPrefix;
+  Name prefix = m_caPrefix;
   prefix.append("CA");
 
   auto prefixId = m_face.registerPrefix(
@@ -82,27 +259,66 @@ CaModule::registerPrefix()
       // register INFO RDR metadata prefix
       name::Component metaDataComp(32, reinterpret_cast<const uint8_t*>("metadata"), std::strlen("metadata"));
       auto filterId = m_face.setInterestFilter(Name(name).append("INFO").append(metaDataComp),
-                                               bind(&CaModule::onCaProfileDiscovery, this, _2));
+        [this] (const InterestFilter&, const Interest& request) {
+          RequestDeadline deadline(request);
+          onCaProfileDiscovery(request);
+          m_metrics.recordHandler(CaHandler::PROFILE_DISCOVERY, time::steady_clock::now() - deadline.getArrivalTime());
+        });
       m_interestFilterHandles.push_back(filterId);
 
       // register PROBE prefix
       filterId = m_face.setInterestFilter(Name(name).append("PROBE"),
-                                          bind(&CaModule::onProbe, this, _2));
+        [this] (const InterestFilter&, const Interest& request) {
+          dispatchRequest(request, AdmissionEndpoint::PROBE, CaHandler::PROBE,
+                          bind(&CaModule::onProbe, this, _1, _2));
+        });
       m_interestFilterHandles.push_back(filterId);
 
       // register NEW prefix
       filterId = m_face.setInterestFilter(Name(name).append("NEW"),
-                                          bind(&CaModule::onNewRenewRevoke, this, _2, RequestType::NEW));
+        [this] (const InterestFilter&, const Interest& request) {
+          dispatchRequest(request, AdmissionEndpoint::NEW, CaHandler::NEW_RENEW_REVOKE,
+                          bind(&CaModule::onNewRenewRevoke, this, _1, RequestType::NEW, _2));
+        });
+      m_interestFilterHandles.push_back(filterId);
+
+      // register BATCH-NEW prefix
+      filterId = m_face.setInterestFilter(Name(name).append("BATCH-NEW"),
+        [this] (const InterestFilter&, const Interest& request) {
+          dispatchRequest(request, AdmissionEndpoint::NEW, CaHandler::NEW_RENEW_REVOKE,
+                          bind(&CaModule::onBatchNew, this, _1, _2));
+        });
       m_interestFilterHandles.push_back(filterId);
 
       // register SELECT prefix
       filterId = m_face.setInterestFilter(Name(name).append("CHALLENGE"),
-                                          bind(&CaModule::onChallenge, this, _2));
+        [this] (const InterestFilter&, const Interest& request) {
+          dispatchRequest(request, AdmissionEndpoint::CHALLENGE, CaHandler::CHALLENGE,
+                          bind(&CaModule::onChallenge, this, _1, _2));
+        });
       m_interestFilterHandles.push_back(filterId);
 
       // register REVOKE prefix
       filterId = m_face.setInterestFilter(Name(name).append("REVOKE"),
-                                          bind(&CaModule::onNewRenewRevoke, this, _2, RequestType::REVOKE));
+        [this] (const InterestFilter&, const Interest& request) {
+          dispatchRequest(request, AdmissionEndpoint::NEW, CaHandler::NEW_RENEW_REVOKE,
+                          bind(&CaModule::onNewRenewRevoke, this, _1, RequestType::REVOKE, _2));
+        });
+      m_interestFilterHandles.push_back(filterId);
+
+      // register RELOAD prefix
+      filterId = m_face.setInterestFilter(Name(name).append("RELOAD"),
+                                          bind(&CaModule::onReload, this, _2));
+      m_interestFilterHandles.push_back(filterId);
+
+      // register issuance LOG prefix
+      filterId = m_face.setInterestFilter(Name(name).append("LOG"),
+                                          bind(&CaModule::onLog, this, _2));
+      m_interestFilterHandles.push_back(filterId);
+
+      // register STATUS dataset prefix
+      filterId = m_face.setInterestFilter(Name(name).append("STATUS").append("metrics"),
+                                          bind(&CaModule::onStatusMetrics, this, _2));
       m_interestFilterHandles.push_back(filterId);
       NDN_LOG_TRACE("Prefix " << name << " got registered");
     },
@@ -111,108 +327,305 @@ CaModule::registerPrefix()
 }
 
 void
-CaModule::setStatusUpdateCallback(const StatusUpdateCallback& onUpdateCallback)
+CaModule::handleInterest(const Interest& request)
+{
+  // /<ca-prefix>/CA/<PROBE|NEW|BATCH-NEW|CHALLENGE|REVOKE|INFO|STATUS|RELOAD|LOG>/...
+  const auto& name = request.getName();
+  size_t typeIndex = m_caPrefixSize + 1;
+  if (name.size() <= typeIndex || !m_caPrefix.isPrefixOf(name) ||
+      name[typeIndex - 1] != name::Component("CA")) {
+    return;
+  }
+  const auto& type = name[typeIndex];
+  if (type == name::Component("PROBE")) {
+    dispatchRequest(request, AdmissionEndpoint::PROBE, CaHandler::PROBE,
+                    bind(&CaModule::onProbe, this, _1, _2));
+  }
+  else if (type == name::Component("NEW")) {
+    dispatchRequest(request, AdmissionEndpoint::NEW, CaHandler::NEW_RENEW_REVOKE,
+                    bind(&CaModule::onNewRenewRevoke, this, _1, RequestType::NEW, _2));
+  }
+  else if (type == name::Component("BATCH-NEW")) {
+    // every entry costs as much as a NEW request, up to a full NEW bucket; a malformed batch pays
+    // for one and is rejected later
+    size_t nEntries = 1;
+    try {
+      if (request.hasApplicationParameters()) {
+        nEntries = std::max<size_t>(requesttlv::countBatchEntries(request.getApplicationParameters()), 1);
+      }
+    }
+    catch (const std::exception&) {
+    }
+    dispatchRequest(request, AdmissionEndpoint::NEW, CaHandler::NEW_RENEW_REVOKE,
+                    bind(&CaModule::onBatchNew, this, _1, _2), nEntries);
+  }
+  else if (type == name::Component("CHALLENGE")) {
+    dispatchRequest(request, AdmissionEndpoint::CHALLENGE, CaHandler::CHALLENGE,
+                    bind(&CaModule::onChallenge, this, _1, _2));
+  }
+  else if (type == name::Component("REVOKE")) {
+    dispatchRequest(request, AdmissionEndpoint::NEW, CaHandler::NEW_RENEW_REVOKE,
+                    bind(&CaModule::onNewRenewRevoke, this, _1, RequestType::REVOKE, _2));
+  }
+  else if (type == name::Component("INFO") && name.size() > typeIndex + 1 &&
+           name[typeIndex + 1] == name::Component(32, reinterpret_cast<const uint8_t*>("metadata"),
+                                                  std::strlen("metadata"))) {
+    RequestDeadline deadline(request);
+    onCaProfileDiscovery(request);
+    m_metrics.recordHandler(CaHandler::PROFILE_DISCOVERY, time::steady_clock::now() - deadline.getArrivalTime());
+  }
+  else if (type == name::Component("STATUS") && name.size() > typeIndex + 1 &&
+           name[typeIndex + 1] == name::Component("metrics")) {
+    onStatusMetrics(request);
+  }
+  else if (type == name::Component("RELOAD")) {
+    onReload(request);
+  }
+  else if (type == name::Component("LOG")) {
+    onLog(request);
+  }
+}
+
+void
+CaModule::invalidateCaProfileData()
 {
-  m_statusUpdateCallback = onUpdateCallback;
+  std::lock_guard<std::mutex> lock(m_profileMutex);
+  m_profileData.reset();
+  m_profileMetadata.reset();
+  m_profileCertName.clear();
+  m_probeCache.clear();
 }
 
 Data
 CaModule::getCaProfileData()
+{
+  std::lock_guard<std::mutex> lock(m_profileMutex);
+  generateCaProfileData();
+  return *m_profileData;
+}
+
+void
+CaModule::generateCaProfileData()
 {
   if (m_profileData == nullptr) {
-    const auto& pib = m_keyChain.getPib();
-    const auto& identity = pib.getIdentity(m_config.caProfile.caPrefix);
-    const auto& cert = identity.getDefaultKey().getDefaultCertificate();
-    Block contentTLV = infotlv::encodeDataContent(m_config.caProfile, cert);
+    auto cert = m_keyChains->use([this] (security::KeyChain& keyChain) {
+      return keyChain.getPib().getIdentity(m_caPrefix).getDefaultKey().getDefaultCertificate();
+    });
+    Block contentTLV = infotlv::encodeDataContent(getConfigState()->config.caProfile, cert);
 
     // set naming convention to be typed
     auto convention = name::getConventionEncoding();
     name::setConventionEncoding(name::Convention::TYPED);
 
-    Name infoPacketName(m_config.caProfile.caPrefix);
+    Name infoPacketName(m_caPrefix);
     auto segmentComp = name::Component::fromSegment(0);
     infoPacketName.append("CA").append("INFO").appendVersion().append(segmentComp);
     m_profileData = std::make_unique<Data>(infoPacketName);
     m_profileData->setFinalBlock(segmentComp);
     m_profileData->setContent(contentTLV);
-    m_profileData->setFreshnessPeriod(DEFAULT_DATA_FRESHNESS_PERIOD);
-    m_keyChain.sign(*m_profileData, signingByIdentity(m_config.caProfile.caPrefix));
+    m_profileData->setFreshnessPeriod(INFO_DATA_FRESHNESS_PERIOD);
+    m_keyChains->use([this] (security::KeyChain& keyChain) {
+      keyChain.sign(*m_profileData, signingByIdentity(m_caPrefix));
+    });
+    m_profileCertName = cert.getName();
+    // the metadata must point to the new version
+    m_profileMetadata.reset();
 
     // set back the convention
     name::setConventionEncoding(convention);
   }
-  return *m_profileData;
+}
+
+Data
+CaModule::getCaProfileMetadata()
+{
+  std::lock_guard<std::mutex> lock(m_profileMutex);
+  if (m_profileMetadata == nullptr) {
+    generateCaProfileData();
+    MetadataObject metadata;
+    metadata.setVersionedName(m_profileData->getName().getPrefix(-1));
+    Name discoveryInterestName(m_profileData->getName().getPrefix(-2));
+    name::Component metadataComponent(32, reinterpret_cast<const uint8_t*>("metadata"), std::strlen("metadata"));
+    discoveryInterestName.append(metadataComponent);
+    m_profileMetadata = m_keyChains->use([&] (security::KeyChain& keyChain) {
+      return std::make_unique<Data>(metadata.makeData(discoveryInterestName, keyChain,
+                                                      signingByIdentity(m_caPrefix),
+                                                      nullopt, METADATA_FRESHNESS_PERIOD));
+    });
+  }
+  return *m_profileMetadata;
+}
+
+bool
+CaModule::admitRequest(const Interest& request, AdmissionEndpoint endpoint, size_t nTokens)
+{
+  if (m_admissionController.admit(endpoint, nTokens)) {
+    return true;
+  }
+  if (m_admissionController.getShedAction() == ShedAction::NACK) {
+    NDN_LOG_DEBUG("Shedding " << endpoint << " request " << request.getName() << " with a congestion Nack");
+    lp::Nack nack(request);
+    nack.setReason(lp::NackReason::CONGESTION);
+    m_face.put(nack);
+  }
+  else {
+    NDN_LOG_DEBUG("Shedding " << endpoint << " request " << request.getName() << " by dropping it");
+  }
+  return false;
+}
+
+void
+CaModule::dispatchRequest(const Interest& request, AdmissionEndpoint endpoint, CaHandler handler,
+                          const function<void(const Interest&, const RequestDeadline&)>& handle,
+                          size_t nTokens)
+{
+  // the deadline of a request is stamped as soon as it arrives, and the handler latency
+  // is measured from the same time
+  RequestDeadline deadline(request);
+  if (!admitRequest(request, endpoint, nTokens)) {
+    return;
+  }
+  if (m_workerPool == nullptr) {
+    handle(request, deadline);
+    m_metrics.recordHandler(handler, time::steady_clock::now() - deadline.getArrivalTime());
+    return;
+  }
+
+  size_t workerIndex;
+  size_t requestIdIndex = m_caPrefixSize + 2;
+  if (endpoint == AdmissionEndpoint::CHALLENGE && request.getName().size() > requestIdIndex) {
+    // the request state and its IV counters are only touched by the worker that owns the request ID
+    const auto& requestId = request.getName()[requestIdIndex];
+    workerIndex = m_workerPool->getWorkerForKey(requestId.value(), requestId.value_size());
+  }
+  else {
+    workerIndex = m_workerPool->getNextWorker();
+  }
+  m_workerPool->post(workerIndex, [this, request, deadline, handler, handle] {
+    handle(request, deadline);
+    m_metrics.recordHandler(handler, time::steady_clock::now() - deadline.getArrivalTime());
+  });
+}
+
+void
+CaModule::putResponse(const Data& data)
+{
+  if (WorkerPool::getCurrentWorkerIndex() == WorkerPool::NOT_A_WORKER) {
+    m_face.put(data);
+    return;
+  }
+  // Face is not thread-safe; the face outlives this module, so capture only the face
+  m_face.getIoService().post([&face = m_face, data] { face.put(data); });
+}
+
+void
+CaModule::notifyStatusUpdate(const RequestState& requestState)
+{
+  // the bus is safe to publish to from any thread, and its subscribers run on their own
+  m_eventBus->publish(requestState);
+}
+
+bool
+CaModule::isPastDeadline(const Interest& request, const RequestDeadline& deadline, ProcessingStage stage)
+{
+  if (!deadline.hasExpired()) {
+    return false;
+  }
+  NDN_LOG_DEBUG("Deadline of " << request.getName() << " has passed, skipping " << stage);
+  m_deadlineStatistics.recordSkipped(stage);
+  return true;
 }
 
 void
 CaModule::onCaProfileDiscovery(const Interest& request)
 {
   NDN_LOG_TRACE("Received CA Profile MetaData discovery Interest");
-  if (m_profileData == nullptr) {
-    m_profileData = std::make_unique<Data>(getCaProfileData());
-  }
-  MetadataObject metadata;
-  metadata.setVersionedName(m_profileData->getName().getPrefix(-1));
-  Name discoveryInterestName(m_profileData->getName().getPrefix(-2));
-  name::Component metadataComponent(32, reinterpret_cast<const uint8_t*>("metadata"), std::strlen("metadata"));
-  discoveryInterestName.append(metadataComponent);
-  m_face.put(metadata.makeData(discoveryInterestName, m_keyChain, signingByIdentity(m_config.caProfile.caPrefix)));
+  m_face.put(getCaProfileMetadata());
 }
 
 void
-CaModule::onProbe(const Interest& request)
+CaModule::onProbe(const Interest& request, const RequestDeadline& deadline)
 {
   // PROBE Naming Convention: /<CA-Prefix>/CA/PROBE/[ParametersSha256DigestComponent]
   NDN_LOG_TRACE("Received PROBE request");
+  // the epoch is taken before the configuration, so a reply to an outdated one is not cached
+  auto cacheEpoch = m_probeCache.getEpoch();
+  auto configState = getConfigState();
+  const auto& config = configState->config;
+  if (configState->isProbeCacheable) {
+    auto cachedReply = m_probeCache.find(request.getName(),
+                                         [this] (const Name& name) { return m_identityIndex.isUsed(name); });
+    if (cachedReply != nullptr) {
+      NDN_LOG_TRACE("Handle PROBE: send out the cached PROBE response");
+      putResponse(*cachedReply);
+      return;
+    }
+  }
 
   // process PROBE requests: collect probe parameters
   auto parameters = probetlv::decodeApplicationParameters(request.getApplicationParameters());
   std::vector <PartialName> availableComponents;
-  for (auto& item : m_config.nameAssignmentFuncs) {
+  for (auto& item : config.nameAssignmentFuncs) {
     auto names = item->assignName(parameters);
     availableComponents.insert(availableComponents.end(), names.begin(), names.end());
   }
   if (availableComponents.size() == 0) {
-    m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
+    putResponse(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
                                        "Cannot generate available names from parameters provided."));
     return;
   }
   std::vector <Name> availableNames;
   for (const auto& component : availableComponents) {
-    Name newIdentityName = m_config.caProfile.caPrefix;
-    newIdentityName.append(component);
-    availableNames.push_back(newIdentityName);
+    auto newIdentityName = concatenateNames(m_caPrefix, component);
+    // names issued or being requested are not suggested again
+    if (!m_identityIndex.isUsed(newIdentityName)) {
+      availableNames.push_back(newIdentityName);
+    }
+  }
+  if (availableNames.empty()) {
+    putResponse(generateErrorDataPacket(request.getName(), ErrorCode::NO_AVAILABLE_NAMES,
+                                       "All the names generated from the parameters provided are in use."));
+    return;
   }
 
-  Data result;
-  result.setName(request.getName());
-  result.setContent(
-    probetlv::encodeDataContent(availableNames, m_config.caProfile.maxSuffixLength, m_config.redirection));
-  result.setFreshnessPeriod(DEFAULT_DATA_FRESHNESS_PERIOD);
-  m_keyChain.sign(result, signingByIdentity(m_config.caProfile.caPrefix));
-  m_face.put(result);
+  if (isPastDeadline(request, deadline, ProcessingStage::SIGNING)) {
+    return;
+  }
+  auto result = make_shared<Data>();
+  result->setName(request.getName());
+  result->setContent(
+    probetlv::encodeDataContent(availableNames, config.caProfile.maxSuffixLength, configState->redirectionBlocks));
+  result->setFreshnessPeriod(DEFAULT_DATA_FRESHNESS_PERIOD);
+  signResponse(*result);
+  if (configState->isProbeCacheable) {
+    m_probeCache.insert(request.getName(), result, availableNames, cacheEpoch);
+  }
+  putResponse(*result);
   NDN_LOG_TRACE("Handle PROBE: send out the PROBE response");
 }
 
 void
-CaModule::onNewRenewRevoke(const Interest& request, RequestType requestType)
+CaModule::onNewRenewRevoke(const Interest& request, RequestType requestType,
+                           const RequestDeadline& deadline)
 {
-
-  //verify ca cert validity
-  const auto& caCert = m_keyChain.getPib()
-                                 .getIdentity(m_config.caProfile.caPrefix)
-                                 .getDefaultKey()
-                                 .getDefaultCertificate();
-  if (!caCert.isValid()) {
-    NDN_LOG_ERROR("Server certificate invalid/expired");
-    m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::BAD_VALIDITY_PERIOD,
-                                       "Server certificate invalid/expired"));
-    return;
-  }
-
   // NEW Naming Convention: /<CA-prefix>/CA/NEW/[SignedInterestParameters_Digest]
   // REVOKE Naming Convention: /<CA-prefix>/CA/REVOKE/[SignedInterestParameters_Digest]
-  // get ECDH pub key and cert request
+  // The request is validated in stages ordered by cost, so that garbage is rejected before
+  // any signature verification or EC operation is spent on it.
+  auto configState = getConfigState();
+  auto stageStartTime = time::steady_clock::now();
+  auto finishStage = [&] (PipelineStage stage, bool isRejected) {
+    auto now = time::steady_clock::now();
+    m_pipelineStatistics.record(stage, now - stageStartTime, isRejected);
+    stageStartTime = now;
+  };
+  auto reject = [&] (PipelineStage stage, ErrorCode error, const std::string& errorInfo) {
+    finishStage(stage, true);
+    NDN_LOG_ERROR("Rejected at " << stage << " stage: " << errorInfo);
+    putResponse(generateErrorDataPacket(request.getName(), error, errorInfo));
+  };
+
+  // decode: get ECDH pub key and cert request
   const auto& parameterTLV = request.getApplicationParameters();
   std::vector <uint8_t> ecdhPub;
   shared_ptr <security::Certificate> clientCert;
@@ -221,158 +634,355 @@ CaModule::onNewRenewRevoke(const Interest& request, RequestType requestType)
   }
   catch (const std::exception& e) {
     if (!parameterTLV.hasValue()) {
-      NDN_LOG_ERROR("Empty TLV obtained from the Interest parameter.");
-      m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
-                                         "Empty TLV obtained from the Interest parameter."));
+      reject(PipelineStage::DECODE, ErrorCode::INVALID_PARAMETER, "Empty TLV obtained from the Interest parameter.");
       return;
     }
-
-    NDN_LOG_ERROR("Unrecognized self-signed certificate: " << e.what());
-    m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
-                                       "Unrecognized self-signed certificate."));
+    NDN_LOG_DEBUG("Cannot decode the certificate: " << e.what());
+    reject(PipelineStage::DECODE, ErrorCode::INVALID_PARAMETER, "Unrecognized self-signed certificate.");
     return;
   }
-
   if (ecdhPub.empty()) {
-    NDN_LOG_ERROR("Empty ECDH PUB obtained from the Interest parameter.");
-    m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
-                                       "Empty ECDH PUB obtained from the Interest parameter."));
+    reject(PipelineStage::DECODE, ErrorCode::INVALID_PARAMETER, "Empty ECDH PUB obtained from the Interest parameter.");
     return;
   }
+  finishStage(PipelineStage::DECODE, false);
 
-  // get server's ECDH pub key
-  ECDHState ecdh;
-  std::vector <uint8_t> sharedSecret;
-  try {
-    sharedSecret = ecdh.deriveSecret(ecdhPub);
+  // policy, signature, and ecdh
+  auto validated = validateRequest(request, false, requestType, ecdhPub, *clientCert,
+                                   configState->config, deadline);
+  if (validated.isAbandoned) {
+    return;
   }
-  catch (const std::exception& e) {
-    NDN_LOG_ERROR("Cannot derive a shared secret using the provided ECDH key: " << e.what());
-    m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
-                                       "Cannot derive a shared secret using the provided ECDH key."));
+  if (validated.error != ErrorCode::NO_ERROR) {
+    putResponse(generateErrorDataPacket(request.getName(), validated.error, validated.errorInfo));
     return;
   }
+  stageStartTime = time::steady_clock::now();
 
-  // verify identity name
-  if (!m_config.caProfile.caPrefix.isPrefixOf(clientCert->getIdentity())
-      || !security::Certificate::isValidName(clientCert->getName())
-      || clientCert->getIdentity().size() <= m_config.caProfile.caPrefix.size()) {
-    NDN_LOG_ERROR("An invalid certificate name is being requested " << clientCert->getName());
-    m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::NAME_NOT_ALLOWED,
-                                       "An invalid certificate name is being requested."));
+  // storage: once the request state is stored, the reply is always sent to keep both sides consistent
+  if (isPastDeadline(request, deadline, ProcessingStage::STORAGE)) {
     return;
   }
-  if (m_config.caProfile.maxSuffixLength) {
-    if (clientCert->getIdentity().size() > m_config.caProfile.caPrefix.size() + *m_config.caProfile.maxSuffixLength) {
-      NDN_LOG_ERROR("An invalid certificate name is being requested " << clientCert->getName());
-      m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::NAME_NOT_ALLOWED,
-                                         "An invalid certificate name is being requested."));
-      return;
-    }
+  try {
+    ScopedStageTimer timer(m_metrics, ProcessingStage::STORAGE);
+    m_storage->addRequest(validated.requestState);
   }
+  catch (const std::runtime_error& e) {
+    reject(PipelineStage::STORAGE, ErrorCode::INVALID_PARAMETER,
+           "Duplicate Request ID: The same request has been seen before.");
+    return;
+  }
+  if (requestType != RequestType::REVOKE) {
+    m_identityIndex.addPending(validated.requestState.requestId, clientCert->getIdentity());
+  }
+  finishStage(PipelineStage::STORAGE, false);
 
+  Data result;
+  result.setName(request.getName());
+  result.setFreshnessPeriod(DEFAULT_DATA_FRESHNESS_PERIOD);
+  result.setContent(requesttlv::encodeDataContent(validated.ecdhPub, validated.salt,
+                                                  validated.requestState.requestId,
+                                                  configState->challengeBlocks));
+  signResponse(result);
+  putResponse(result);
+  notifyStatusUpdate(validated.requestState);
+}
+
+CaModule::ValidatedRequest
+CaModule::validateRequest(const Interest& request, bool isInterestVerified, RequestType requestType,
+                          const std::vector<uint8_t>& ecdhPub, const security::Certificate& clientCert,
+                          const CaConfig& config, const RequestDeadline& deadline)
+{
+  ValidatedRequest validated;
+  auto stageStartTime = time::steady_clock::now();
+  auto finishStage = [&] (PipelineStage stage, bool isRejected) {
+    auto now = time::steady_clock::now();
+    m_pipelineStatistics.record(stage, now - stageStartTime, isRejected);
+    stageStartTime = now;
+  };
+  auto reject = [&] (PipelineStage stage, ErrorCode error, const std::string& errorInfo) {
+    finishStage(stage, true);
+    NDN_LOG_ERROR("Rejected at " << stage << " stage: " << errorInfo);
+    validated.error = error;
+    validated.errorInfo = errorInfo;
+    return validated;
+  };
+
+  // policy: verify identity name and validity period
+  if (!m_caPrefix.isPrefixOf(clientCert.getIdentity())
+      || !security::Certificate::isValidName(clientCert.getName())
+      || clientCert.getIdentity().size() <= m_caPrefixSize) {
+    NDN_LOG_DEBUG("An invalid certificate name is being requested " << clientCert.getName());
+    return reject(PipelineStage::POLICY, ErrorCode::NAME_NOT_ALLOWED, "An invalid certificate name is being requested.");
+  }
+  if (config.caProfile.maxSuffixLength) {
+    if (clientCert.getIdentity().size() > m_caPrefixSize + *config.caProfile.maxSuffixLength) {
+      NDN_LOG_DEBUG("An invalid certificate name is being requested " << clientCert.getName());
+      return reject(PipelineStage::POLICY, ErrorCode::NAME_NOT_ALLOWED, "An invalid certificate name is being requested.");
+    }
+  }
   if (requestType == RequestType::NEW) {
-    // check the validity period
-    auto expectedPeriod = clientCert->getValidityPeriod().getPeriod();
+    auto expectedPeriod = clientCert.getValidityPeriod().getPeriod();
     auto currentTime = time::system_clock::now();
     if (expectedPeriod.first < currentTime - REQUEST_VALIDITY_PERIOD_NOT_BEFORE_GRACE_PERIOD ||
-        expectedPeriod.second > currentTime + m_config.caProfile.maxValidityPeriod ||
+        expectedPeriod.second > currentTime + config.caProfile.maxValidityPeriod ||
         expectedPeriod.second <= expectedPeriod.first) {
-      NDN_LOG_ERROR("An invalid validity period is being requested.");
-      m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::BAD_VALIDITY_PERIOD,
-                                         "An invalid validity period is being requested."));
-      return;
+      return reject(PipelineStage::POLICY, ErrorCode::BAD_VALIDITY_PERIOD, "An invalid validity period is being requested.");
     }
+  }
+  // verify ca cert validity
+  auto caCert = m_keyChains->use([this] (security::KeyChain& keyChain) {
+    return keyChain.getPib().getIdentity(m_caPrefix).getDefaultKey().getDefaultCertificate();
+  });
+  if (!caCert.isValid()) {
+    return reject(PipelineStage::POLICY, ErrorCode::BAD_VALIDITY_PERIOD, "Server certificate invalid/expired");
+  }
+  bool isCaCertChanged = false;
+  {
+    std::lock_guard<std::mutex> lock(m_profileMutex);
+    isCaCertChanged = m_profileData != nullptr && caCert.getName() != m_profileCertName;
+  }
+  if (isCaCertChanged) {
+    NDN_LOG_TRACE("CA certificate changed to " << caCert.getName() << ", regenerating the CA profile");
+    invalidateCaProfileData();
+  }
+  finishStage(PipelineStage::POLICY, false);
 
-    // verify signature
-    if (!security::verifySignature(*clientCert, *clientCert)) {
-      NDN_LOG_ERROR("Invalid signature in the self-signed certificate.");
-      m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::BAD_SIGNATURE,
-                                         "Invalid signature in the self-signed certificate."));
-      return;
+  // signature: the Interest signature first, as it is checked against the key in the request
+  if (requestType == RequestType::NEW) {
+    if (!isInterestVerified && !security::verifySignature(request, clientCert)) {
+      return reject(PipelineStage::SIGNATURE, ErrorCode::BAD_SIGNATURE, "Invalid signature in the Interest packet.");
     }
-    if (!security::verifySignature(request, *clientCert)) {
-      NDN_LOG_ERROR("Invalid signature in the Interest packet.");
-      m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::BAD_SIGNATURE,
-                                         "Invalid signature in the Interest packet."));
-      return;
+    if (!security::verifySignature(clientCert, clientCert)) {
+      return reject(PipelineStage::SIGNATURE, ErrorCode::BAD_SIGNATURE, "Invalid signature in the self-signed certificate.");
     }
   }
   else if (requestType == RequestType::REVOKE) {
     //verify cert is from this CA
-    if (!security::verifySignature(*clientCert, caCert)) {
-      NDN_LOG_ERROR("Invalid signature in the certificate to revoke.");
-      m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::BAD_SIGNATURE,
-                                         "Invalid signature in the certificate to revoke."));
-      return;
+    if (!security::verifySignature(clientCert, caCert)) {
+      return reject(PipelineStage::SIGNATURE, ErrorCode::BAD_SIGNATURE, "Invalid signature in the certificate to revoke.");
     }
   }
+  finishStage(PipelineStage::SIGNATURE, false);
 
-  // create new request instance
+  // ecdh: get server's ECDH pub key, the request ID, and the encryption key
+  if (isPastDeadline(request, deadline, ProcessingStage::ECDH)) {
+    validated.isAbandoned = true;
+    return validated;
+  }
+  ECDHState ecdh;
+  std::vector <uint8_t> sharedSecret;
+  try {
+    ScopedStageTimer timer(m_metrics, ProcessingStage::ECDH);
+    sharedSecret = ecdh.deriveSecret(ecdhPub);
+  }
+  catch (const std::exception& e) {
+    NDN_LOG_DEBUG("Cannot derive a shared secret: " << e.what());
+    return reject(PipelineStage::ECDH, ErrorCode::INVALID_PARAMETER,
+                  "Cannot derive a shared secret using the provided ECDH key.");
+  }
   uint8_t requestIdData[32];
-  Block certNameTlv = clientCert->getName().wireEncode();
+  Block certNameTlv = clientCert.getName().wireEncode();
   try {
     hmacSha256(certNameTlv.wire(), certNameTlv.size(), m_requestIdGenKey, 32, requestIdData);
   }
   catch (const std::runtime_error& e) {
-    NDN_LOG_ERROR("Error computing the request ID: " << std::string(e.what()));
-    m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
-                                       "Error computing the request ID."));
-    return;
+    NDN_LOG_DEBUG("Error computing the request ID: " << e.what());
+    return reject(PipelineStage::ECDH, ErrorCode::INVALID_PARAMETER, "Error computing the request ID.");
   }
   RequestId id;
   std::memcpy(id.data(), requestIdData, id.size());
   // initialize request state
-  RequestState requestState;
-  requestState.caPrefix = m_config.caProfile.caPrefix;
+  auto& requestState = validated.requestState;
+  requestState.caPrefix = m_caPrefix;
   requestState.requestId = id;
   requestState.requestType = requestType;
-  requestState.cert = *clientCert;
+  requestState.cert = clientCert;
   // generate salt for HKDF
-  std::array<uint8_t, 32> salt;
-  random::generateSecureBytes(salt.data(), salt.size());
+  random::generateSecureBytes(validated.salt.data(), validated.salt.size());
   // hkdf
   std::array<uint8_t, 16> aesKey;
-  hkdf(sharedSecret.data(), sharedSecret.size(), salt.data(), salt.size(),
+  hkdf(sharedSecret.data(), sharedSecret.size(), validated.salt.data(), validated.salt.size(),
        aesKey.data(), aesKey.size(), id.data(), id.size());
   requestState.encryptionKey = aesKey;
+  validated.ecdhPub = ecdh.getSelfPubKey();
+  finishStage(PipelineStage::ECDH, false);
+  return validated;
+}
+
+void
+CaModule::onBatchNew(const Interest& request, const RequestDeadline& deadline)
+{
+  // BATCH-NEW Naming Convention: /<CA-prefix>/CA/BATCH-NEW/[SignedInterestParameters_Digest]
+  // Each entry is a NEW request. The Interest is signed by the key of the first entry, and each
+  // certificate request proves the possession of its own key with its self-signature.
+  struct BatchState
+  {
+    shared_ptr<const ConfigState> configState;
+    std::vector<std::vector<uint8_t>> ecdhPubs;
+    std::vector<shared_ptr<security::Certificate>> certRequests;
+    std::vector<ValidatedRequest> entries;
+    std::atomic<size_t> nPendingChunks{0};
+  };
+  auto batch = make_shared<BatchState>();
+  batch->configState = getConfigState();
+
+  auto decodeStartTime = time::steady_clock::now();
+  auto reject = [&] (PipelineStage stage, ErrorCode error, const std::string& errorInfo) {
+    m_pipelineStatistics.record(stage, time::steady_clock::now() - decodeStartTime, true);
+    NDN_LOG_ERROR("Rejected BATCH-NEW at " << stage << " stage: " << errorInfo);
+    putResponse(generateErrorDataPacket(request.getName(), error, errorInfo));
+  };
   try {
-    m_storage->addRequest(requestState);
+    requesttlv::decodeBatchApplicationParameters(request.getApplicationParameters(),
+                                                 batch->ecdhPubs, batch->certRequests);
   }
-  catch (const std::runtime_error& e) {
-    NDN_LOG_ERROR("Duplicate Request ID: The same request has been seen before.");
-    m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
-                                       "Duplicate Request ID: The same request has been seen before."));
+  catch (const std::exception& e) {
+    NDN_LOG_DEBUG("Cannot decode the BATCH-NEW entries: " << e.what());
+    reject(PipelineStage::DECODE, ErrorCode::INVALID_PARAMETER, "Cannot decode the entries of the batch.");
     return;
   }
-  Data result;
-  result.setName(request.getName());
-  result.setFreshnessPeriod(DEFAULT_DATA_FRESHNESS_PERIOD);
-  result.setContent(requesttlv::encodeDataContent(ecdh.getSelfPubKey(),
-                                                  salt, requestState.requestId,
-                                                  m_config.caProfile.supportedChallenges));
-  m_keyChain.sign(result, signingByIdentity(m_config.caProfile.caPrefix));
-  m_face.put(result);
-  if (m_statusUpdateCallback) {
-    m_statusUpdateCallback(requestState);
+  if (batch->certRequests.empty()) {
+    reject(PipelineStage::DECODE, ErrorCode::INVALID_PARAMETER, "Empty batch obtained from the Interest parameter.");
+    return;
+  }
+  for (const auto& ecdhPub : batch->ecdhPubs) {
+    if (ecdhPub.empty()) {
+      reject(PipelineStage::DECODE, ErrorCode::INVALID_PARAMETER, "Empty ECDH PUB obtained from the Interest parameter.");
+      return;
+    }
+  }
+  m_pipelineStatistics.record(PipelineStage::DECODE, time::steady_clock::now() - decodeStartTime, false);
+  // the batch is rejected as a whole if the Interest has been tampered with
+  if (!security::verifySignature(request, *batch->certRequests.front())) {
+    reject(PipelineStage::SIGNATURE, ErrorCode::BAD_SIGNATURE, "Invalid signature in the Interest packet.");
+    return;
+  }
+
+  size_t nEntries = batch->certRequests.size();
+  batch->entries.resize(nEntries);
+  auto validateEntries = [this, batch, request, deadline] (size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      // an entry that throws fails on its own; letting the exception out of a chunk would leave
+      // the batch waiting for that chunk forever, with no reply to the requester
+      try {
+        batch->entries[i] = validateRequest(request, true, RequestType::NEW, batch->ecdhPubs[i],
+                                            *batch->certRequests[i], batch->configState->config, deadline);
+      }
+      catch (const std::exception& e) {
+        NDN_LOG_ERROR("Cannot validate entry " << i << " of BATCH-NEW: " << e.what());
+        batch->entries[i] = ValidatedRequest();
+        batch->entries[i].error = ErrorCode::INVALID_PARAMETER;
+        batch->entries[i].errorInfo = "Cannot validate the request.";
+      }
+    }
+  };
+  auto finishBatch = [this, batch, request, deadline] {
+    if (isPastDeadline(request, deadline, ProcessingStage::STORAGE)) {
+      return;
+    }
+    std::vector<RequestState> requestStates;
+    for (const auto& entry : batch->entries) {
+      if (entry.isAbandoned) {
+        return;
+      }
+      if (entry.error == ErrorCode::NO_ERROR) {
+        requestStates.push_back(entry.requestState);
+      }
+    }
+    // all the accepted entries are stored with a single commit
+    auto storageStartTime = time::steady_clock::now();
+    std::vector<bool> isAdded;
+    try {
+      ScopedStageTimer timer(m_metrics, ProcessingStage::STORAGE);
+      isAdded = m_storage->addRequests(requestStates);
+    }
+    catch (const std::runtime_error& e) {
+      NDN_LOG_ERROR("Cannot store the BATCH-NEW requests: " << e.what());
+      m_pipelineStatistics.record(PipelineStage::STORAGE, time::steady_clock::now() - storageStartTime, true);
+      putResponse(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
+                                          "Cannot store the requests of the batch."));
+      return;
+    }
+    m_pipelineStatistics.record(PipelineStage::STORAGE, time::steady_clock::now() - storageStartTime, false);
+
+    std::vector<requesttlv::BatchResult> results(batch->entries.size());
+    std::vector<const RequestState*> addedStates;
+    size_t stateIndex = 0;
+    for (size_t i = 0; i < batch->entries.size(); i++) {
+      const auto& entry = batch->entries[i];
+      auto& result = results[i];
+      if (entry.error != ErrorCode::NO_ERROR) {
+        result.error = entry.error;
+        result.errorInfo = entry.errorInfo;
+        m_metrics.recordError(entry.error);
+        continue;
+      }
+      if (!isAdded[stateIndex++]) {
+        result.error = ErrorCode::INVALID_PARAMETER;
+        result.errorInfo = "Duplicate Request ID: The same request has been seen before.";
+        m_metrics.recordError(result.error);
+        continue;
+      }
+      result.ecdhKey = entry.ecdhPub;
+      result.salt = entry.salt;
+      result.requestId = entry.requestState.requestId;
+      addedStates.push_back(&entry.requestState);
+      m_identityIndex.addPending(entry.requestState.requestId, entry.requestState.cert.getIdentity());
+    }
+    NDN_LOG_TRACE("Handle BATCH-NEW: " << addedStates.size() << " of " << results.size() << " requests accepted");
+
+    Data result;
+    result.setName(request.getName());
+    result.setFreshnessPeriod(DEFAULT_DATA_FRESHNESS_PERIOD);
+    result.setContent(requesttlv::encodeBatchDataContent(results, batch->configState->challengeBlocks));
+    signResponse(result);
+    putResponse(result);
+    for (const auto* requestState : addedStates) {
+      notifyStatusUpdate(*requestState);
+    }
+  };
+
+  if (m_workerPool == nullptr || WorkerPool::getCurrentWorkerIndex() == WorkerPool::NOT_A_WORKER ||
+      nEntries == 1) {
+    validateEntries(0, nEntries);
+    finishBatch();
+    return;
+  }
+  // the EC operations of the entries are spread over the workers, and whichever finishes its
+  // chunk last stores the batch and replies
+  size_t nChunks = std::min(getWorkerCount(), nEntries);
+  batch->nPendingChunks = nChunks;
+  for (size_t i = 0; i < nChunks; i++) {
+    size_t begin = nEntries * i / nChunks;
+    size_t end = nEntries * (i + 1) / nChunks;
+    m_workerPool->post(i, [batch, validateEntries, finishBatch, begin, end] {
+      validateEntries(begin, end);
+      if (batch->nPendingChunks.fetch_sub(1) == 1) {
+        finishBatch();
+      }
+    });
   }
 }
 
 void
-CaModule::onChallenge(const Interest& request)
+CaModule::onChallenge(const Interest& request, const RequestDeadline& deadline)
 {
   // get certificate request state
+  if (isPastDeadline(request, deadline, ProcessingStage::STORAGE)) {
+    return;
+  }
   auto requestState = getCertificateRequest(request);
   if (requestState == nullptr) {
     NDN_LOG_ERROR("No certificate request state can be found.");
-    m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
+    putResponse(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
                                        "No certificate request state can be found."));
     return;
   }
   // verify signature
   if (!security::verifySignature(request, requestState->cert)) {
     NDN_LOG_ERROR("Invalid Signature in the Interest packet.");
-    m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::BAD_SIGNATURE,
+    putResponse(generateErrorDataPacket(request.getName(), ErrorCode::BAD_SIGNATURE,
                                        "Invalid Signature in the Interest packet."));
     return;
   }
@@ -385,15 +995,15 @@ CaModule::onChallenge(const Interest& request)
   }
   catch (const std::exception& e) {
     NDN_LOG_ERROR("Interest paramaters decryption failed: " << e.what());
-    m_storage->deleteRequest(requestState->requestId);
-    m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
+    deleteRequest(*requestState);
+    putResponse(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
                                        "Interest paramaters decryption failed."));
     return;
   }
   if (paramTLVPayload.size() == 0) {
     NDN_LOG_ERROR("No parameters are found after decryption.");
-    m_storage->deleteRequest(requestState->requestId);
-    m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
+    deleteRequest(*requestState);
+    putResponse(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
                                        "No parameters are found after decryption."));
     return;
   }
@@ -402,20 +1012,40 @@ CaModule::onChallenge(const Interest& request)
 
   // load the corresponding challenge module
   std::string challengeType = readString(paramTLV.get(tlv::SelectedChallenge));
-  auto challenge = ChallengeModule::createChallengeModule(challengeType);
+  auto configState = getConfigState();
+  const auto& challenges = configState->challenges[std::min(WorkerPool::getCurrentWorkerIndex(),
+                                                            configState->challenges.size() - 1)];
+  ChallengeModule* challenge = nullptr;
+  unique_ptr<ChallengeModule> unlistedChallenge;
+  auto search = challenges.find(challengeType);
+  if (search != nullptr) {
+    challenge = search->get();
+  }
+  else {
+    unlistedChallenge = ChallengeModule::createChallengeModule(challengeType);
+    challenge = unlistedChallenge.get();
+  }
   if (challenge == nullptr) {
     NDN_LOG_TRACE("Unrecognized challenge type: " << challengeType);
-    m_storage->deleteRequest(requestState->requestId);
-    m_face.put(
+    deleteRequest(*requestState);
+    putResponse(
       generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER, "Unrecognized challenge type."));
     return;
   }
 
   NDN_LOG_TRACE("CHALLENGE module to be load: " << challengeType);
-  auto errorInfo = challenge->handleChallengeRequest(paramTLV, *requestState);
+  // the challenge module changes the request state, after which the reply is always sent
+  if (isPastDeadline(request, deadline, ProcessingStage::CHALLENGE)) {
+    return;
+  }
+  std::tuple<ErrorCode, std::string> errorInfo;
+  {
+    ScopedStageTimer timer(m_metrics, ProcessingStage::CHALLENGE);
+    errorInfo = challenge->handleChallengeRequest(paramTLV, *requestState);
+  }
   if (std::get<0>(errorInfo) != ErrorCode::NO_ERROR) {
-    m_storage->deleteRequest(requestState->requestId);
-    m_face.put(generateErrorDataPacket(request.getName(), std::get<0>(errorInfo), std::get<1>(errorInfo)));
+    deleteRequest(*requestState);
+    putResponse(generateErrorDataPacket(request.getName(), std::get<0>(errorInfo), std::get<1>(errorInfo)));
     return;
   }
 
@@ -423,17 +1053,29 @@ CaModule::onChallenge(const Interest& request)
   if (requestState->status == Status::PENDING) {
     // if challenge succeeded
     if (requestState->requestType == RequestType::NEW || requestState->requestType == RequestType::RENEW) {
-      auto issuedCert = issueCertificate(*requestState);
+      security::Certificate issuedCert;
+      try {
+        issuedCert = issueCertificate(*requestState);
+      }
+      catch (const std::runtime_error& e) {
+        NDN_LOG_ERROR("Cannot issue the certificate: " << e.what());
+        deleteRequest(*requestState);
+        putResponse(generateErrorDataPacket(request.getName(), ErrorCode::INVALID_PARAMETER,
+                                            "The certificate cannot be issued."));
+        return;
+      }
       requestState->cert = issuedCert;
       requestState->status = Status::SUCCESS;
-      m_storage->deleteRequest(requestState->requestId);
+      deleteRequest(*requestState);
+      m_identityIndex.addIssued(issuedCert.getIdentity(), issuedCert.getKeyName());
 
       payload = challengetlv::encodeDataContent(*requestState, issuedCert.getName());
       NDN_LOG_TRACE("Challenge succeeded. Certificate has been issued: " << issuedCert.getName());
     }
     else if (requestState->requestType == RequestType::REVOKE) {
       requestState->status = Status::SUCCESS;
-      m_storage->deleteRequest(requestState->requestId);
+      deleteRequest(*requestState);
+      m_identityIndex.removeIssued(requestState->cert.getIdentity(), requestState->cert.getKeyName());
       // TODO: where is the code to revoke?
       payload = challengetlv::encodeDataContent(*requestState);
       NDN_LOG_TRACE("Challenge succeeded. Certificate has been revoked");
@@ -441,6 +1083,7 @@ CaModule::onChallenge(const Interest& request)
   }
   else {
     payload = challengetlv::encodeDataContent(*requestState);
+    ScopedStageTimer timer(m_metrics, ProcessingStage::STORAGE);
     m_storage->updateRequest(*requestState);
     NDN_LOG_TRACE("No failure no success. Challenge moves on");
   }
@@ -449,11 +1092,9 @@ CaModule::onChallenge(const Interest& request)
   result.setName(request.getName());
   result.setFreshnessPeriod(DEFAULT_DATA_FRESHNESS_PERIOD);
   result.setContent(payload);
-  m_keyChain.sign(result, signingByIdentity(m_config.caProfile.caPrefix));
-  m_face.put(result);
-  if (m_statusUpdateCallback) {
-    m_statusUpdateCallback(*requestState);
-  }
+  signResponse(result);
+  putResponse(result);
+  notifyStatusUpdate(*requestState);
 }
 
 security::Certificate
@@ -471,10 +1112,18 @@ CaModule::issueCertificate(const RequestState& requestState)
   SignatureInfo signatureInfo;
   signatureInfo.setValidityPeriod(period);
   security::SigningInfo signingInfo(security::SigningInfo::SIGNER_TYPE_ID,
-                                    m_config.caProfile.caPrefix, signatureInfo);
+                                    m_caPrefix, signatureInfo);
 
-  m_keyChain.sign(newCert, signingInfo);
+  {
+    ScopedStageTimer timer(m_metrics, ProcessingStage::SIGNING);
+    m_keyChains->use([&] (security::KeyChain& keyChain) { keyChain.sign(newCert, signingInfo); });
+  }
   NDN_LOG_TRACE("new cert got signed" << newCert);
+  if (m_issuanceLog != nullptr) {
+    // a certificate missing from the log is not handed out
+    auto index = m_issuanceLog->append(newCert);
+    NDN_LOG_TRACE("Certificate " << newCert.getName() << " is entry " << index << " of the issuance log");
+  }
   return newCert;
 }
 
@@ -483,7 +1132,7 @@ CaModule::getCertificateRequest(const Interest& request)
 {
   RequestId requestId;
   try {
-    auto& component = request.getName().at(m_config.caProfile.caPrefix.size() + 2);
+    auto& component = request.getName().at(m_caPrefixSize + 2);
     std::memcpy(requestId.data(), component.value(), component.value_size());
   }
   catch (const std::exception& e) {
@@ -492,7 +1141,15 @@ CaModule::getCertificateRequest(const Interest& request)
   }
   try {
     NDN_LOG_TRACE("Request Id to query the database " << toHex(requestId.data(), requestId.size()));
-    return std::make_unique<RequestState>(m_storage->getRequest(requestId));
+    ScopedStageTimer timer(m_metrics, ProcessingStage::STORAGE);
+    auto requestState = std::make_unique<RequestState>(m_storage->getRequest(requestId));
+    // the storage may be shared with other CAs, whose requests this CA must not act upon
+    if (requestState->caPrefix != m_caPrefix) {
+      NDN_LOG_ERROR("The request " << toHex(requestId.data(), requestId.size())
+                    << " belongs to the CA " << requestState->caPrefix);
+      return nullptr;
+    }
+    return requestState;
   }
   catch (const std::exception& e) {
     NDN_LOG_ERROR("Cannot get certificate request record from the storage: " << e.what());
@@ -500,6 +1157,204 @@ CaModule::getCertificateRequest(const Interest& request)
   }
 }
 
+void
+CaModule::deleteRequest(const RequestState& requestState)
+{
+  m_storage->deleteRequest(requestState.requestId);
+  m_identityIndex.removePending(requestState.requestId);
+}
+
+std::vector<MetricSample>
+CaModule::collectMetrics() const
+{
+  std::vector<MetricSample> samples;
+  m_metrics.collect(samples);
+  for (size_t i = 0; i < ADMISSION_ENDPOINT_COUNT; i++) {
+    auto endpoint = static_cast<AdmissionEndpoint>(i);
+    std::pair<std::string, std::string> label("endpoint",
+      boost::algorithm::to_lower_copy(boost::lexical_cast<std::string>(endpoint)));
+    samples.push_back({"ndncert_admission_admitted_total", {label},
+                       static_cast<double>(m_admissionController.getAdmittedCount(endpoint))});
+    samples.push_back({"ndncert_admission_shed_total", {label},
+                       static_cast<double>(m_admissionController.getShedCount(endpoint))});
+  }
+  samples.push_back({"ndncert_probe_cache_hits_total", {},
+                     static_cast<double>(m_probeCache.getHitCount())});
+  samples.push_back({"ndncert_probe_cache_misses_total", {},
+                     static_cast<double>(m_probeCache.getMissCount())});
+  if (m_issuanceLog != nullptr) {
+    samples.push_back({"ndncert_issuance_log_entries", {}, static_cast<double>(m_issuanceLog->size())});
+  }
+  for (size_t i = 0; i < PROCESSING_STAGE_COUNT; i++) {
+    auto stage = static_cast<ProcessingStage>(i);
+    samples.push_back({"ndncert_deadline_skipped_total", {{"stage", boost::lexical_cast<std::string>(stage)}},
+                       static_cast<double>(m_deadlineStatistics.getSkippedCount(stage))});
+  }
+  for (size_t i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+    auto stage = static_cast<PipelineStage>(i);
+    const auto& entry = m_pipelineStatistics.get(stage);
+    std::pair<std::string, std::string> label("stage", boost::lexical_cast<std::string>(stage));
+    samples.push_back({"ndncert_pipeline_processed_total", {label}, static_cast<double>(entry.nProcessed)});
+    samples.push_back({"ndncert_pipeline_rejected_total", {label}, static_cast<double>(entry.nRejected)});
+    samples.push_back({"ndncert_pipeline_latency_seconds_sum", {label}, entry.totalTime.count() / 1e9});
+    samples.push_back({"ndncert_pipeline_latency_seconds_max", {label}, entry.maxTime.count() / 1e9});
+  }
+  return samples;
+}
+
+void
+CaModule::onStatusMetrics(const Interest& request)
+{
+  // the dataset is named /<ca-prefix>/CA/STATUS/metrics/<version>/<segment>
+  const auto& name = request.getName();
+  size_t datasetPrefixLength = m_caPrefixSize + 3;
+  if (name.size() == datasetPrefixLength + 2) {
+    // continue fetching the snapshot that segment 0 was served from
+    if (!name[-2].isVersion() || !name[-1].isSegment() || m_metricsSegments.empty() ||
+        name[-2] != m_metricsSegments.front().getName()[-2]) {
+      NDN_LOG_TRACE("Metrics dataset version is not available: " << name);
+      return;
+    }
+    auto segment = name[-1].toSegment();
+    if (segment < m_metricsSegments.size()) {
+      m_face.put(m_metricsSegments[segment]);
+    }
+    return;
+  }
+  if (name.size() != datasetPrefixLength) {
+    return;
+  }
+
+  auto now = time::steady_clock::now();
+  if (m_metricsSegments.empty() || now >= m_metricsExpiry) {
+    auto content = encodeMetricsJson(m_caPrefix, collectMetrics());
+    Name versionedName = Name(name).appendVersion();
+    size_t nSegments = std::max<size_t>(1, (content.size() + METRICS_SEGMENT_SIZE - 1) / METRICS_SEGMENT_SIZE);
+    auto finalBlockId = name::Component::fromSegment(nSegments - 1);
+    m_metricsSegments.clear();
+    for (size_t i = 0; i < nSegments; i++) {
+      size_t offset = i * METRICS_SEGMENT_SIZE;
+      size_t length = std::min(METRICS_SEGMENT_SIZE, content.size() - offset);
+      Data segment(Name(versionedName).appendSegment(i));
+      segment.setFreshnessPeriod(METRICS_SNAPSHOT_PERIOD);
+      segment.setFinalBlock(finalBlockId);
+      segment.setContent(reinterpret_cast<const uint8_t*>(content.data()) + offset, length);
+      signResponse(segment);
+      m_metricsSegments.push_back(std::move(segment));
+    }
+    m_metricsExpiry = now + METRICS_SNAPSHOT_PERIOD;
+  }
+  m_face.put(m_metricsSegments.front());
+}
+
+void
+CaModule::onLog(const Interest& request)
+{
+  // /<ca-prefix>/CA/LOG/<HEAD|PROOF/<index>/<tree-size>|ENTRY/<index>>
+  if (m_issuanceLog == nullptr) {
+    return;
+  }
+  const auto& name = request.getName();
+  size_t typeIndex = m_caPrefixSize + 2;
+  if (name.size() <= typeIndex) {
+    return;
+  }
+  const auto& type = name[typeIndex];
+
+  if (type == name::Component("HEAD") && name.size() == typeIndex + 1) {
+    auto treeSize = m_issuanceLog->size();
+    if (m_logHead == nullptr || m_logHead->getName()[-1].toVersion() != treeSize) {
+      logtlv::TreeHead head;
+      head.treeSize = treeSize;
+      head.rootHash = m_issuanceLog->getRootHash(treeSize);
+      head.timestamp = time::system_clock::now();
+      m_logHead = std::make_unique<Data>(Name(name).appendVersion(treeSize));
+      m_logHead->setFreshnessPeriod(DEFAULT_DATA_FRESHNESS_PERIOD);
+      m_logHead->setContent(logtlv::encodeTreeHead(head));
+      signResponse(*m_logHead);
+    }
+    m_face.put(*m_logHead);
+    return;
+  }
+
+  Data result(name);
+  result.setFreshnessPeriod(DEFAULT_DATA_FRESHNESS_PERIOD);
+  try {
+    if (type == name::Component("PROOF") && name.size() == typeIndex + 3 &&
+        name[typeIndex + 1].isNumber() && name[typeIndex + 2].isNumber()) {
+      auto treeSize = name[typeIndex + 2].toNumber();
+      auto proof = m_issuanceLog->getInclusionProof(name[typeIndex + 1].toNumber(), treeSize);
+      result.setContent(logtlv::encodeInclusionProof(proof, m_issuanceLog->getRootHash(treeSize)));
+    }
+    else if (type == name::Component("ENTRY") && name.size() == typeIndex + 2 && name[typeIndex + 1].isNumber()) {
+      result.setContent(m_issuanceLog->getEntry(name[typeIndex + 1].toNumber()));
+    }
+    else {
+      return;
+    }
+  }
+  catch (const std::out_of_range& e) {
+    m_face.put(generateErrorDataPacket(name, ErrorCode::INVALID_PARAMETER, e.what()));
+    return;
+  }
+  m_keyChains->use([&] (security::KeyChain& keyChain) { keyChain.sign(result, security::signingWithSha256()); });
+  m_face.put(result);
+}
+
+void
+CaModule::onReload(const Interest& request)
+{
+  // RELOAD Naming Convention: /<CA-prefix>/CA/RELOAD/[ParametersSha256DigestComponent]
+  // only the holder of the CA's key may reload its configuration, with a signed Interest
+  // carrying the time it was signed at and a nonce, so that a captured one cannot be replayed
+  auto sigInfo = request.getSignatureInfo();
+  if (!sigInfo || !sigInfo->getTime() || !sigInfo->getNonce()) {
+    NDN_LOG_ERROR("No signature time or nonce in the RELOAD Interest " << request.getName());
+    m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::BAD_INTEREST_FORMAT,
+                                       "The Interest packet must carry a signature time and nonce."));
+    return;
+  }
+  // the checks below only compare numbers, so a replayed or stale Interest costs no verification
+  auto signatureTime = *sigInfo->getTime();
+  auto now = time::system_clock::now();
+  if (signatureTime < now - RELOAD_SIGNATURE_TIME_GRACE_PERIOD ||
+      signatureTime > now + RELOAD_SIGNATURE_TIME_GRACE_PERIOD ||
+      (m_lastReloadSignatureTime && signatureTime <= *m_lastReloadSignatureTime) ||
+      (m_lastReloadSeqNum && sigInfo->getSeqNum() && *sigInfo->getSeqNum() <= *m_lastReloadSeqNum)) {
+    NDN_LOG_ERROR("Stale or replayed RELOAD Interest " << request.getName());
+    m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::BAD_SIGNATURE,
+                                       "The Interest packet is stale or has been replayed."));
+    return;
+  }
+  auto caCert = m_keyChains->use([this] (security::KeyChain& keyChain) {
+    return keyChain.getPib().getIdentity(m_caPrefix).getDefaultKey().getDefaultCertificate();
+  });
+  if (!security::verifySignature(request, caCert)) {
+    NDN_LOG_ERROR("Invalid signature in the RELOAD Interest " << request.getName());
+    m_face.put(generateErrorDataPacket(request.getName(), ErrorCode::BAD_SIGNATURE,
+                                       "Invalid signature in the Interest packet."));
+    return;
+  }
+  // the signature time is strictly increasing across the accepted Interests, which together with
+  // the grace period rules out replays; the sequence number, if the signer keeps one, must grow too
+  m_lastReloadSignatureTime = signatureTime;
+  if (sigInfo->getSeqNum()) {
+    m_lastReloadSeqNum = *sigInfo->getSeqNum();
+  }
+
+  NDN_LOG_INFO("Reloading the configuration of " << m_caPrefix << " on request");
+  reloadConfig([this, name = request.getName()] (const std::string& error) {
+    if (!error.empty()) {
+      m_face.put(generateErrorDataPacket(name, ErrorCode::INVALID_PARAMETER, error));
+      return;
+    }
+    Data result(name);
+    result.setFreshnessPeriod(DEFAULT_DATA_FRESHNESS_PERIOD);
+    signResponse(result);
+    m_face.put(result);
+  });
+}
+
 void
 CaModule::onRegisterFailed(const std::string& reason)
 {
@@ -513,10 +1368,20 @@ CaModule::generateErrorDataPacket(const Name& name, ErrorCode error, const std::
   result.setName(name);
   result.setFreshnessPeriod(DEFAULT_DATA_FRESHNESS_PERIOD);
   result.setContent(errortlv::encodeDataContent(error, errorInfo));
-  m_keyChain.sign(result, signingByIdentity(m_config.caProfile.caPrefix));
+  signResponse(result);
+  m_metrics.recordError(error);
   return result;
 }
 
+void
+CaModule::signResponse(Data& data)
+{
+  ScopedStageTimer timer(m_metrics, ProcessingStage::SIGNING);
+  m_keyChains->use([&] (security::KeyChain& keyChain) {
+    keyChain.sign(data, signingByIdentity(m_caPrefix));
+  });
+}
+
 } // namespace ca
 } // namespace ndncert
 } // namespace ndn
@@ -21,62 +21,342 @@
 #ifndef NDNCERT_CA_MODULE_HPP
 #define NDNCERT_CA_MODULE_HPP
 
+#include "detail/ca-admission-control.hpp"
 #include "detail/ca-configuration.hpp"
+#include "detail/ca-event-bus.hpp"
+#include "detail/ca-identity-index.hpp"
+#include "detail/ca-issuance-log.hpp"
+#include "detail/ca-metrics.hpp"
+#include "detail/ca-probe-cache.hpp"
+#include "detail/ca-request-deadline.hpp"
+#include "detail/ca-request-pipeline.hpp"
 #include "detail/crypto-helpers.hpp"
 #include "detail/ca-storage.hpp"
+#include "detail/ca-worker-pool.hpp"
+#include "detail/perfect-hash-map.hpp"
+#include "challenge/challenge-module.hpp"
+
+#include <mutex>
 
 namespace ndn {
 namespace ndncert {
 namespace ca {
 
 /**
- * @brief The function would be invoked whenever the certificate request status is updated.
- * The callback is used to notice the CA application or CA command line tool. The callback is
- * fired whenever a request instance is created, challenge status is updated, and when certificate
- * is issued.
+ * @brief The function invoked when a configuration reload has finished.
  *
- * @param RequestState The state of the certificate request whose status is updated.
+ * @param error why the new configuration was not applied, empty if it was
  */
-using StatusUpdateCallback = function<void(const RequestState&)>;
+using ReloadCallback = function<void(const std::string& error)>;
+
+/**
+ * @brief Resources that the CAs hosted on the same face share.
+ */
+struct CaSharedResources
+{
+  shared_ptr<CaStorage> storage;
+  /**
+   * Processes the requests of all the CAs, nullptr to process them on the face thread
+   */
+  shared_ptr<WorkerPool> workerPool;
+  shared_ptr<WorkerKeyChains> keyChains;
+  /**
+   * Receives the status updates of the requests of all the CAs, nullptr for one bus per CA
+   */
+  shared_ptr<EventBus> eventBus;
+};
 
+/**
+ * @brief The CA side of NDNCERT.
+ *
+ * By default all requests are processed on the thread of the face. When the configuration sets
+ * "worker-threads", the face thread only runs admission control and sends packets, and PROBE,
+ * NEW/REVOKE, and CHALLENGE requests are processed by a pool of worker threads. All CHALLENGE
+ * requests of one certificate request go to the same worker, chosen by the request ID, so they
+ * are handled in order. Replies are sent on the face thread in either mode, while status updates
+ * are delivered to the subscribers of the EventBus on their own threads.
+ */
 class CaModule : noncopyable
 {
 public:
   CaModule(Face& face, security::KeyChain& keyChain, const std::string& configPath,
            const std::string& storageType = "ca-storage-sqlite3");
 
+  /**
+   * @brief Create a CA hosted along with other CAs, see CaHost.
+   *
+   * The CA registers no prefix; its Interests are passed to handleInterest(). The worker pool in
+   * @p resources must be joined before the CA is destroyed.
+   */
+  CaModule(Face& face, security::KeyChain& keyChain, const std::string& configPath,
+           const CaSharedResources& resources);
+
   ~CaModule();
 
-  CaConfig&
-  getCaConf()
+  /**
+   * @brief The current configuration, replaced by a reload.
+   *
+   * Call this from the thread of the face, where reloads are applied.
+   */
+  const CaConfig&
+  getCaConf() const
   {
-    return m_config;
+    return m_configState->config;
   }
 
-  const unique_ptr<CaStorage>&
+  const shared_ptr<CaStorage>&
   getCaStorage()
   {
     return m_storage;
   }
 
+  const AdmissionController&
+  getAdmissionController() const
+  {
+    return m_admissionController;
+  }
+
+  const DeadlineStatistics&
+  getDeadlineStatistics() const
+  {
+    return m_deadlineStatistics;
+  }
+
+  /**
+   * @brief Per-stage rejection counters and latency of NEW/REVOKE request validation.
+   */
+  const PipelineStatistics&
+  getPipelineStatistics() const
+  {
+    return m_pipelineStatistics;
+  }
+
+  const CaMetrics&
+  getMetrics() const
+  {
+    return m_metrics;
+  }
+
+  /**
+   * @brief Collect the samples of all runtime metrics of the CA.
+   *
+   * The same samples are published as the /<ca-prefix>/CA/STATUS/metrics dataset and can be
+   * written to a Prometheus text file with writePrometheusFile().
+   */
+  std::vector<MetricSample>
+  collectMetrics() const;
+
+  /**
+   * @brief The bus of the status events of the requests, published whenever a request is
+   *        created, its challenge status is updated, or its certificate is issued.
+   */
+  EventBus&
+  getEventBus()
+  {
+    return *m_eventBus;
+  }
+
+  /**
+   * @brief Handle an Interest under /<ca-prefix>/CA, as the Interest filters of the CA would.
+   */
   void
-  setStatusUpdateCallback(const StatusUpdateCallback& onUpdateCallback);
+  handleInterest(const Interest& request);
+
+  /**
+   * @brief Number of threads processing requests, zero if they are processed on the face thread.
+   */
+  size_t
+  getWorkerCount() const
+  {
+    return m_workerPool == nullptr ? 0 : m_workerPool->getWorkerCount();
+  }
 
   Data
   getCaProfileData();
 
+  /**
+   * @brief Drop the cached INFO packet, its metadata, and the cached PROBE replies.
+   *
+   * They are signed once and served from the cache afterwards. They are regenerated on the next
+   * request, so call this after the CA certificate has changed. A certificate change is also
+   * detected automatically when the next NEW or REVOKE request is handled.
+   */
+  void
+  invalidateCaProfileData();
+
+  /**
+   * @brief Load the configuration file again in the background and switch to it.
+   *
+   * The new configuration takes effect on the thread of the face, after which the INFO packet is
+   * signed again and @p onDone is invoked there. Requests already being processed finish with
+   * the configuration they started with, and the request ID key is kept, so requests in progress
+   * continue under the new configuration. The CA prefix and the number of worker threads cannot
+   * be changed by a reload. If the file cannot be loaded, the current configuration is kept.
+   *
+   * Call this from the thread of the face. A call made while a reload is running does not wait
+   * for it: all such calls are coalesced into one more reload, started once the current one is
+   * applied, and their @p onDone callbacks are invoked with its outcome.
+   */
+  void
+  reloadConfig(const ReloadCallback& onDone = nullptr);
+
 NDNCERT_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  /**
+   * @brief A configuration of the CA with everything derived from it, replaced as a whole.
+   */
+  struct ConfigState
+  {
+    CaConfig config;
+    /**
+     * Constant TLV fragments of the NEW/REVOKE and PROBE responses
+     */
+    std::vector<Block> challengeBlocks;
+    std::vector<Block> redirectionBlocks;
+    /**
+     * Modules of the supported challenges, one set per worker thread plus one for the face thread
+     */
+    std::vector<PerfectHashMap<unique_ptr<ChallengeModule>>> challenges;
+    /**
+     * Whether PROBE replies may be cached, which requires deterministic name assignment functions
+     */
+    bool isProbeCacheable = true;
+  };
+
+  void
+  initialize(const CaSharedResources& resources, CaConfig&& config);
+
+  /**
+   * @brief The current configuration, safe to call from any thread.
+   */
+  shared_ptr<const ConfigState>
+  getConfigState() const
+  {
+    return std::atomic_load(&m_configState);
+  }
+
+  shared_ptr<const ConfigState>
+  makeConfigState(CaConfig&& config) const;
+
+  void
+  applyConfigState(shared_ptr<const ConfigState> state);
+
+  Data
+  getCaProfileMetadata();
+
+  /**
+   * @brief Sign the INFO packet if it is not cached.
+   * @pre m_profileMutex is locked
+   */
+  void
+  generateCaProfileData();
+
+  /**
+   * @brief Run admission control for @p request; a shed request is Nacked or dropped here.
+   * @param nTokens the tokens the request costs
+   * @return whether the request should be processed
+   */
+  bool
+  admitRequest(const Interest& request, AdmissionEndpoint endpoint, size_t nTokens = 1);
+
+  /**
+   * @brief Admit @p request and process it with @p handle, on the worker chosen for it if any.
+   */
+  void
+  dispatchRequest(const Interest& request, AdmissionEndpoint endpoint, CaHandler handler,
+                  const function<void(const Interest&, const RequestDeadline&)>& handle,
+                  size_t nTokens = 1);
+
+  /**
+   * @brief Send @p data from the face thread.
+   */
+  void
+  putResponse(const Data& data);
+
+  void
+  notifyStatusUpdate(const RequestState& requestState);
+
   void
   onCaProfileDiscovery(const Interest& request);
 
+  /**
+   * @brief Check the deadline of @p request before starting @p stage.
+   * @return true if the deadline has passed and the request should be abandoned
+   */
+  bool
+  isPastDeadline(const Interest& request, const RequestDeadline& deadline, ProcessingStage stage);
+
+  void
+  onProbe(const Interest& request, const RequestDeadline& deadline);
+
+  /**
+   * @brief A NEW/REVOKE request after the policy, signature, and ECDH stages of validation.
+   */
+  struct ValidatedRequest
+  {
+    ErrorCode error = ErrorCode::NO_ERROR;
+    std::string errorInfo;
+    /**
+     * The deadline passed during validation, so no reply should be sent
+     */
+    bool isAbandoned = false;
+    RequestState requestState;
+    /**
+     * The CA's ECDH public key and the HKDF salt for the reply
+     */
+    std::vector<uint8_t> ecdhPub;
+    std::array<uint8_t, 32> salt;
+  };
+
+  void
+  onNewRenewRevoke(const Interest& request, RequestType requestType, const RequestDeadline& deadline);
+
+  /**
+   * @brief Validate a decoded NEW/REVOKE request up to the point where it can be stored.
+   *
+   * @param isInterestVerified whether the signature of @p request has been verified already;
+   *        if not, a NEW request must be signed by the key of @p clientCert
+   */
+  ValidatedRequest
+  validateRequest(const Interest& request, bool isInterestVerified, RequestType requestType,
+                  const std::vector<uint8_t>& ecdhPub, const security::Certificate& clientCert,
+                  const CaConfig& config, const RequestDeadline& deadline);
+
+  /**
+   * @brief Handle a BATCH-NEW request carrying many NEW requests.
+   *
+   * The entries are validated on all worker threads if there are any, stored in one transaction,
+   * and answered with one Data packet.
+   */
   void
-  onProbe(const Interest& request);
+  onBatchNew(const Interest& request, const RequestDeadline& deadline);
 
   void
-  onNewRenewRevoke(const Interest& request, RequestType requestType);
+  onChallenge(const Interest& request, const RequestDeadline& deadline);
 
   void
-  onChallenge(const Interest& request);
+  onStatusMetrics(const Interest& request);
+
+  /**
+   * @brief Serve the issuance log under /<ca-prefix>/CA/LOG.
+   *
+   * HEAD is answered with the signed tree head, named with the tree size as its version.
+   * PROOF/<index>/<tree-size> is answered with the inclusion proof of an entry and
+   * ENTRY/<index> with the entry itself; both are signed with a SHA-256 digest only, since
+   * they are checked against a signed tree head.
+   */
+  void
+  onLog(const Interest& request);
+
+  /**
+   * @brief Reload the configuration on a RELOAD Interest signed by the CA's own key.
+   *
+   * The Interest must be signed in the v0.3 format with a signature time and a nonce, e.g., by
+   * security::InterestSigner. Its signature time must be within a grace period of the clock of
+   * the CA and later than that of the last accepted RELOAD Interest, and its sequence number,
+   * if any, greater than the last accepted one, so that a captured Interest cannot be replayed.
+   */
+  void
+  onReload(const Interest& request);
 
   void
   onRegisterFailed(const std::string& reason);
@@ -84,6 +364,12 @@ NDNCERT_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   std::unique_ptr<RequestState>
   getCertificateRequest(const Interest& request);
 
+  /**
+   * @brief Delete a request from the storage and from the identity index.
+   */
+  void
+  deleteRequest(const RequestState& requestState);
+
   security::Certificate
   issueCertificate(const RequestState& requestState);
 
@@ -93,20 +379,84 @@ NDNCERT_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   Data
   generateErrorDataPacket(const Name& name, ErrorCode error, const std::string& errorInfo);
 
+  void
+  signResponse(Data& data);
+
 NDNCERT_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   Face& m_face;
-  CaConfig m_config;
-  unique_ptr<CaStorage> m_storage;
+  const std::string m_configPath;
+  /**
+   * The CA prefix, which stays the same across reloads, kept wire-encoded along with its size
+   */
+  Name m_caPrefix;
+  size_t m_caPrefixSize = 0;
+  /**
+   * Accessed with std::atomic_load and std::atomic_store, replaced on the face thread only
+   */
+  shared_ptr<const ConfigState> m_configState;
+  shared_ptr<CaStorage> m_storage;
+  /**
+   * Identity names issued since the CA started and those of the stored NEW requests
+   */
+  IdentityIndex m_identityIndex;
   security::KeyChain& m_keyChain;
+  /**
+   * Gives each thread a KeyChain it may use
+   */
+  shared_ptr<WorkerKeyChains> m_keyChains;
   uint8_t m_requestIdGenKey[32];
+  /**
+   * Protects the cached INFO packet and its metadata
+   */
+  std::mutex m_profileMutex;
   std::unique_ptr<Data> m_profileData;
+  std::unique_ptr<Data> m_profileMetadata;
+  /**
+   * Name of the CA certificate carried in the cached INFO packet
+   */
+  Name m_profileCertName;
+  shared_ptr<EventBus> m_eventBus;
+  AdmissionController m_admissionController;
+  /**
+   * Signed PROBE replies, cleared together with the cached INFO packet
+   */
+  ProbeCache m_probeCache;
+  DeadlineStatistics m_deadlineStatistics;
+  PipelineStatistics m_pipelineStatistics;
+  CaMetrics m_metrics;
+  /**
+   * Segments of the latest snapshot of the metrics dataset
+   */
+  std::vector<Data> m_metricsSegments;
+  time::steady_clock::TimePoint m_metricsExpiry;
   /**
-   * StatusUpdate Callback function
+   * Log of the issued certificates, if enabled in the configuration
    */
-  StatusUpdateCallback m_statusUpdateCallback;
+  unique_ptr<IssuanceLog> m_issuanceLog;
+  /**
+   * The latest signed tree head of the issuance log, used on the thread of the face only
+   */
+  unique_ptr<Data> m_logHead;
 
   std::list<RegisteredPrefixHandle> m_registeredPrefixHandles;
   std::list<InterestFilterHandle> m_interestFilterHandles;
+  shared_ptr<WorkerPool> m_workerPool;
+  std::thread m_reloadThread;
+  /**
+   * State of the reloads, used on the thread of the face only
+   */
+  bool m_isReloading = false;
+  bool m_isReloadQueued = false;
+  std::vector<ReloadCallback> m_reloadCallbacks;
+  /**
+   * Signature time and sequence number of the last accepted RELOAD Interest
+   */
+  optional<time::system_clock::TimePoint> m_lastReloadSignatureTime;
+  optional<uint64_t> m_lastReloadSeqNum;
+  /**
+   * Expires when the module is destroyed, so that a pending reload is not applied to it
+   */
+  shared_ptr<char> m_lifetimeToken = make_shared<char>();
 };
 
 } // namespace ca
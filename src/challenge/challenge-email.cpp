@@ -104,7 +104,7 @@ ChallengeEmail::handleChallengeRequest(const Block& params, ca::RequestState& re
 
 // For Client
 std::multimap<std::string, std::string>
-ChallengeEmail::getRequestedParameterList(Status status, const std::string& challengeStatus)
+ChallengeEmail::getRequestedParameterList(Status status, const std::string& challengeStatus) const
 {
   std::multimap<std::string, std::string> result;
   if (status == Status::BEFORE_CHALLENGE && challengeStatus == "") {
@@ -124,7 +124,7 @@ ChallengeEmail::getRequestedParameterList(Status status, const std::string& chal
 
 Block
 ChallengeEmail::genChallengeRequestTLV(Status status, const std::string& challengeStatus,
-                                       const std::multimap<std::string, std::string>& params)
+                                       const std::multimap<std::string, std::string>& params) const
 {
   Block request(tlv::EncryptedPayload);
   if (status == Status::BEFORE_CHALLENGE) {
@@ -36,17 +36,46 @@ ChallengeModule::ChallengeModule(const std::string& challengeType,
 bool
 ChallengeModule::isChallengeSupported(const std::string& challengeType)
 {
-  ChallengeFactory& factory = getFactory();
-  auto i = factory.find(challengeType);
-  return i == factory.end() ? false : true;
+  return getChallengeModule(challengeType) != nullptr;
+}
+
+std::string
+ChallengeModule::findChallengeType(const std::string& challengeType)
+{
+  for (const auto& item : getFactory()) {
+    if (boost::algorithm::iequals(item.first, challengeType)) {
+      return item.first;
+    }
+  }
+  return "";
 }
 
 unique_ptr<ChallengeModule>
-ChallengeModule::createChallengeModule(const std::string& challengeType)
+ChallengeModule::createChallengeModule(const std::string& challengeType, const std::string& configPath)
 {
   ChallengeFactory& factory = getFactory();
   auto i = factory.find(challengeType);
-  return i == factory.end() ? nullptr : i->second();
+  return i == factory.end() ? nullptr : i->second(configPath);
+}
+
+const ChallengeModule*
+ChallengeModule::getChallengeModule(const std::string& challengeType)
+{
+  auto challenge = getRegistry().find(challengeType);
+  return challenge == nullptr ? nullptr : challenge->get();
+}
+
+const PerfectHashMap<unique_ptr<ChallengeModule>>&
+ChallengeModule::getRegistry()
+{
+  static const PerfectHashMap<unique_ptr<ChallengeModule>> registry([] {
+    std::vector<std::pair<std::string, unique_ptr<ChallengeModule>>> entries;
+    for (const auto& item : getFactory()) {
+      entries.emplace_back(item.first, item.second(""));
+    }
+    return PerfectHashMap<unique_ptr<ChallengeModule>>(std::move(entries));
+  }());
+  return registry;
 }
 
 ChallengeModule::ChallengeFactory&
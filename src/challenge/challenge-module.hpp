@@ -22,6 +22,7 @@
 #define NDNCERT_CHALLENGE_MODULE_HPP
 
 #include "detail/ca-request-state.hpp"
+#include "detail/perfect-hash-map.hpp"
 
 namespace ndn {
 namespace ndncert {
@@ -40,14 +41,38 @@ public:
   {
     ChallengeFactory& factory = getFactory();
     BOOST_ASSERT(factory.count(typeName) == 0);
-    factory[typeName] = [] { return std::make_unique<ChallengeType>(); };
+    factory[typeName] = [] (const std::string& configPath) {
+      return makeChallengeModule<ChallengeType>(configPath,
+                                                std::is_constructible<ChallengeType, const std::string&>());
+    };
   }
 
   static bool
   isChallengeSupported(const std::string& challengeType);
 
+  /**
+   * @return the registered challenge type equal to @p challengeType regardless of case,
+   *         or an empty string if the challenge is not supported
+   */
+  static std::string
+  findChallengeType(const std::string& challengeType);
+
+  /**
+   * @param configPath the file the challenge reads its configuration from, such as the trust
+   *        anchors of the possession challenge; empty for the default of the challenge
+   */
   static unique_ptr<ChallengeModule>
-  createChallengeModule(const std::string& challengeType);
+  createChallengeModule(const std::string& challengeType, const std::string& configPath = "");
+
+  /**
+   * @brief Get the shared instance of a registered challenge, for the requester side operations.
+   *
+   * The instances are created once, at the first lookup, which must come after all challenges are
+   * registered. A lookup is a single probe of a perfect hash table and does not allocate.
+   * @return nullptr if the challenge is not supported
+   */
+  static const ChallengeModule*
+  getChallengeModule(const std::string& challengeType);
 
   // For CA
   virtual std::tuple<ErrorCode, std::string>
@@ -55,11 +80,11 @@ public:
 
   // For Client
   virtual std::multimap<std::string, std::string>
-  getRequestedParameterList(Status status, const std::string& challengeStatus) = 0;
+  getRequestedParameterList(Status status, const std::string& challengeStatus) const = 0;
 
   virtual Block
   genChallengeRequestTLV(Status status, const std::string& challengeStatus,
-                         const std::multimap<std::string, std::string>& params) = 0;
+                         const std::multimap<std::string, std::string>& params) const = 0;
 
   // helpers
   static std::string
@@ -83,11 +108,28 @@ public:
   const time::seconds m_secretLifetime;
 
 private:
-  typedef function<unique_ptr<ChallengeModule>()> ChallengeCreateFunc;
+  template <class ChallengeType>
+  static unique_ptr<ChallengeModule>
+  makeChallengeModule(const std::string& configPath, std::true_type)
+  {
+    return configPath.empty() ? std::make_unique<ChallengeType>() : std::make_unique<ChallengeType>(configPath);
+  }
+
+  template <class ChallengeType>
+  static unique_ptr<ChallengeModule>
+  makeChallengeModule(const std::string&, std::false_type)
+  {
+    return std::make_unique<ChallengeType>();
+  }
+
+  typedef function<unique_ptr<ChallengeModule>(const std::string& configPath)> ChallengeCreateFunc;
   typedef std::map<std::string, ChallengeCreateFunc> ChallengeFactory;
 
   static ChallengeFactory&
   getFactory();
+
+  static const PerfectHashMap<unique_ptr<ChallengeModule>>&
+  getRegistry();
 };
 
 #define NDNCERT_REGISTER_CHALLENGE(C, T)                              \
@@ -85,7 +85,7 @@ ChallengePin::handleChallengeRequest(const Block& params, ca::RequestState& requ
 
 // For Client
 std::multimap<std::string, std::string>
-ChallengePin::getRequestedParameterList(Status status, const std::string& challengeStatus)
+ChallengePin::getRequestedParameterList(Status status, const std::string& challengeStatus) const
 {
   std::multimap<std::string, std::string> result;
   if (status == Status::BEFORE_CHALLENGE) {
@@ -105,7 +105,7 @@ ChallengePin::getRequestedParameterList(Status status, const std::string& challe
 
 Block
 ChallengePin::genChallengeRequestTLV(Status status, const std::string& challengeStatus,
-                                     const std::multimap<std::string, std::string>& params)
+                                     const std::multimap<std::string, std::string>& params) const
 {
   Block request(tlv::EncryptedPayload);
   if (status == Status::BEFORE_CHALLENGE) {
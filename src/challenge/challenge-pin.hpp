@@ -56,11 +56,11 @@ public:
 
   // For Client
   std::multimap<std::string, std::string>
-  getRequestedParameterList(Status status, const std::string& challengeStatus) override;
+  getRequestedParameterList(Status status, const std::string& challengeStatus) const override;
 
   Block
   genChallengeRequestTLV(Status status, const std::string& challengeStatus,
-                         const std::multimap<std::string, std::string>& params) override;
+                         const std::multimap<std::string, std::string>& params) const override;
 
   // challenge status
   static const std::string NEED_CODE;
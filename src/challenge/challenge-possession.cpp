@@ -165,7 +165,7 @@ ChallengePossession::handleChallengeRequest(const Block& params, ca::RequestStat
 
 // For Client
 std::multimap<std::string, std::string>
-ChallengePossession::getRequestedParameterList(Status status, const std::string& challengeStatus)
+ChallengePossession::getRequestedParameterList(Status status, const std::string& challengeStatus) const
 {
   std::multimap<std::string, std::string> result;
   if (status == Status::BEFORE_CHALLENGE) {
@@ -182,7 +182,7 @@ ChallengePossession::getRequestedParameterList(Status status, const std::string&
 
 Block
 ChallengePossession::genChallengeRequestTLV(Status status, const std::string& challengeStatus,
-                                            const std::multimap<std::string, std::string>& params)
+                                            const std::multimap<std::string, std::string>& params) const
 {
   Block request(tlv::EncryptedPayload);
   if (status == Status::BEFORE_CHALLENGE) {
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "challenge-token.hpp"
+#include "detail/crypto-helpers.hpp"
+#include <ndn-cxx/util/string-helper.hpp>
+
+namespace ndn {
+namespace ndncert {
+
+NDN_LOG_INIT(ndncert.challenge.token);
+NDNCERT_REGISTER_CHALLENGE(ChallengeToken, "token");
+
+const std::string ChallengeToken::PARAMETER_KEY_TOKEN = "token";
+const size_t ChallengeToken::MIN_HMAC_KEY_SIZE = 16;
+
+ChallengeToken::ChallengeToken(const std::string& configPath)
+    : ChallengeModule("token", 1, time::seconds(0))
+{
+  if (configPath.empty()) {
+    m_configFile = std::string(NDNCERT_SYSCONFDIR) + "/ndncert/challenge-token.conf";
+  }
+  else {
+    m_configFile = configPath;
+    // a CA names the file in its configuration, so a broken one is reported when the CA is built
+    parseConfigFile();
+  }
+}
+
+void
+ChallengeToken::parseConfigFile()
+{
+  JsonSection config;
+  try {
+    boost::property_tree::read_json(m_configFile, config);
+  }
+  catch (const boost::property_tree::json_parser_error& error) {
+    NDN_THROW(std::runtime_error("Failed to parse configuration file " + m_configFile +
+                                 " " + error.message() + " line " + std::to_string(error.line())));
+  }
+
+  auto hexKey = config.get("hmac-key", "");
+  shared_ptr<Buffer> key;
+  try {
+    key = fromHex(hexKey);
+  }
+  catch (const StringHelperError&) {
+    NDN_THROW(std::runtime_error("Error processing configuration file: " + m_configFile +
+                                 " hmac-key is not a hex string"));
+  }
+  if (key->size() < MIN_HMAC_KEY_SIZE) {
+    NDN_THROW(std::runtime_error("Error processing configuration file: " + m_configFile +
+                                 " hmac-key must be at least " + std::to_string(MIN_HMAC_KEY_SIZE) + " octets"));
+  }
+  m_hmacKey = std::move(*key);
+}
+
+std::array<uint8_t, 32>
+ChallengeToken::computeTokenMac(const Buffer& hmacKey, const Name& identityName, const std::string& expiration)
+{
+  const auto& nameWire = identityName.wireEncode();
+  Buffer input(nameWire.wire(), nameWire.size());
+  input.insert(input.end(), expiration.begin(), expiration.end());
+  std::array<uint8_t, 32> mac;
+  hmacSha256(input.data(), input.size(), hmacKey.data(), hmacKey.size(), mac.data());
+  return mac;
+}
+
+std::string
+ChallengeToken::generateToken(const Buffer& hmacKey, const Name& identityName,
+                              const time::system_clock::TimePoint& expiration)
+{
+  auto expirationString = std::to_string(time::toUnixTimestamp(expiration).count() / 1000);
+  auto mac = computeTokenMac(hmacKey, identityName, expirationString);
+  return expirationString + ":" + toHex(mac.data(), mac.size(), false);
+}
+
+// For CA
+std::tuple<ErrorCode, std::string>
+ChallengeToken::handleChallengeRequest(const Block& params, ca::RequestState& request)
+{
+  params.parse();
+  if (m_hmacKey.empty()) {
+    try {
+      parseConfigFile();
+    }
+    catch (const std::exception& e) {
+      NDN_LOG_ERROR("Cannot load the token challenge configuration: " << e.what());
+      return returnWithError(request, ErrorCode::INVALID_PARAMETER, "Token challenge is not configured");
+    }
+  }
+  if (request.status != Status::BEFORE_CHALLENGE) {
+    return returnWithError(request, ErrorCode::INVALID_PARAMETER, "Unexpected status or challenge status");
+  }
+
+  std::string token;
+  const auto& elements = params.elements();
+  for (size_t i = 0; i + 1 < elements.size(); i++) {
+    if (elements[i].type() == tlv::ParameterKey && elements[i + 1].type() == tlv::ParameterValue &&
+        readString(elements[i]) == PARAMETER_KEY_TOKEN) {
+      token = readString(elements[i + 1]);
+    }
+  }
+  auto separator = token.find(':');
+  if (separator == std::string::npos || separator == 0) {
+    return returnWithError(request, ErrorCode::INVALID_PARAMETER, "Cannot find a well-formed token");
+  }
+  auto expirationString = token.substr(0, separator);
+  shared_ptr<Buffer> givenMac;
+  uint64_t expiration = 0;
+  try {
+    expiration = std::stoull(expirationString);
+    givenMac = fromHex(token.substr(separator + 1));
+  }
+  catch (const std::exception&) {
+    return returnWithError(request, ErrorCode::INVALID_PARAMETER, "Cannot find a well-formed token");
+  }
+
+  auto expectedMac = computeTokenMac(m_hmacKey, request.cert.getIdentity(), expirationString);
+  // compare in constant time, so the MAC cannot be guessed byte by byte
+  uint8_t difference = givenMac->size() == expectedMac.size() ? 0 : 1;
+  for (size_t i = 0; i < expectedMac.size() && i < givenMac->size(); i++) {
+    difference |= (*givenMac)[i] ^ expectedMac[i];
+  }
+  if (difference != 0) {
+    NDN_LOG_TRACE("Token does not match " << request.cert.getIdentity());
+    return returnWithError(request, ErrorCode::INVALID_PARAMETER, "Token cannot be verified");
+  }
+  auto now = time::toUnixTimestamp(time::system_clock::now()).count() / 1000;
+  if (now < 0 || static_cast<uint64_t>(now) >= expiration) {
+    return returnWithError(request, ErrorCode::OUT_OF_TIME, "Token expired");
+  }
+  NDN_LOG_TRACE("Valid token for " << request.cert.getIdentity() << ". Challenge succeeded.");
+  return returnWithSuccess(request);
+}
+
+// For Client
+std::multimap<std::string, std::string>
+ChallengeToken::getRequestedParameterList(Status status, const std::string& challengeStatus) const
+{
+  std::multimap<std::string, std::string> result;
+  if (status == Status::BEFORE_CHALLENGE) {
+    result.emplace(PARAMETER_KEY_TOKEN, "Please input your enrollment token");
+  }
+  else {
+    NDN_THROW(std::runtime_error("Unexpected status or challenge status."));
+  }
+  return result;
+}
+
+Block
+ChallengeToken::genChallengeRequestTLV(Status status, const std::string& challengeStatus,
+                                       const std::multimap<std::string, std::string>& params) const
+{
+  Block request(tlv::EncryptedPayload);
+  if (status == Status::BEFORE_CHALLENGE) {
+    if (params.size() != 1 || params.find(PARAMETER_KEY_TOKEN) == params.end()) {
+      NDN_THROW(std::runtime_error("Wrong parameter provided."));
+    }
+    request.push_back(makeStringBlock(tlv::SelectedChallenge, CHALLENGE_TYPE));
+    request.push_back(makeStringBlock(tlv::ParameterKey, PARAMETER_KEY_TOKEN));
+    request.push_back(makeStringBlock(tlv::ParameterValue, params.find(PARAMETER_KEY_TOKEN)->second));
+  }
+  else {
+    NDN_THROW(std::runtime_error("Unexpected status or challenge status."));
+  }
+  request.encode();
+  return request;
+}
+
+} // namespace ndncert
+} // namespace ndn
@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_CHALLENGE_TOKEN_HPP
+#define NDNCERT_CHALLENGE_TOKEN_HPP
+
+#include "challenge-module.hpp"
+
+namespace ndn {
+namespace ndncert {
+
+/**
+ * @brief Provide pre-authorized enrollment token based challenge
+ *
+ * An enrollment token is issued out of band, e.g., when a device is flashed on the factory floor.
+ * It is an HMAC-SHA256 over the identity name the token authorizes and its expiration time,
+ * keyed with a secret the CA shares with the token issuer. The token is written as
+ * "<expiration time in seconds since the Unix epoch>:<hex HMAC>".
+ *
+ * The main process of this challenge module is:
+ *   1. End entity provides the token together with the challenge selection.
+ *   2. The challenge module verifies the token against the identity of the certificate request.
+ *
+ * The challenge completes in a single CHALLENGE round trip and keeps no secret in the request
+ * state, so the CA does not update the stored request for it.
+ *
+ * The CA loads the HMAC key from a JSON file with a hex "hmac-key" of at least 16 octets.
+ * A file given to the constructor is loaded right away, so a malformed one throws there;
+ * the default file is loaded on the first CHALLENGE request.
+ *
+ * Failure info when application fails:
+ *   INVALID_PARAMETER: When the token is malformed or does not match the requested identity,
+ *                      or when the HMAC key cannot be loaded.
+ *   OUT_OF_TIME: When the token has expired.
+ */
+class ChallengeToken : public ChallengeModule
+{
+public:
+  ChallengeToken(const std::string& configPath = "");
+
+  // For CA
+  std::tuple<ErrorCode, std::string>
+  handleChallengeRequest(const Block& params, ca::RequestState& request) override;
+
+  // For Client
+  std::multimap<std::string, std::string>
+  getRequestedParameterList(Status status, const std::string& challengeStatus) const override;
+
+  Block
+  genChallengeRequestTLV(Status status, const std::string& challengeStatus,
+                         const std::multimap<std::string, std::string>& params) const override;
+
+  // For token issuer
+  /**
+   * @brief Issue a token that authorizes @p identityName until @p expiration.
+   */
+  static std::string
+  generateToken(const Buffer& hmacKey, const Name& identityName,
+                const time::system_clock::TimePoint& expiration);
+
+  // challenge parameters
+  static const std::string PARAMETER_KEY_TOKEN;
+  static const size_t MIN_HMAC_KEY_SIZE;
+
+NDNCERT_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  void
+  parseConfigFile();
+
+  static std::array<uint8_t, 32>
+  computeTokenMac(const Buffer& hmacKey, const Name& identityName, const std::string& expiration);
+
+NDNCERT_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  Buffer m_hmacKey;
+  std::string m_configFile;
+};
+
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_CHALLENGE_TOKEN_HPP
@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_DETAIL_BOUNDED_QUEUE_HPP
+#define NDNCERT_DETAIL_BOUNDED_QUEUE_HPP
+
+#include "detail/ndncert-common.hpp"
+
+#include <atomic>
+
+namespace ndn {
+namespace ndncert {
+
+/**
+ * @brief A fixed-capacity lock-free queue for any number of producers and consumers.
+ *
+ * Each slot carries a sequence number telling whether it is ready to be written or read in the
+ * current lap around the ring (D. Vyukov's bounded MPMC queue). A push or pop claims its slot
+ * with a single compare-and-swap and never blocks; a full or empty queue is reported instead.
+ */
+template<typename T>
+class BoundedQueue : noncopyable
+{
+public:
+  /**
+   * @param capacity the maximum number of elements, rounded up to a power of two
+   */
+  explicit
+  BoundedQueue(size_t capacity)
+  {
+    size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    m_mask = size - 1;
+    m_slots = std::make_unique<Slot[]>(size);
+    for (size_t i = 0; i < size; i++) {
+      m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    m_enqueuePos.store(0, std::memory_order_relaxed);
+    m_dequeuePos.store(0, std::memory_order_relaxed);
+  }
+
+  size_t
+  capacity() const
+  {
+    return m_mask + 1;
+  }
+
+  /**
+   * @return false if the queue is full, in which case @p value is left untouched
+   */
+  bool
+  tryPush(T& value)
+  {
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+      slot = &m_slots[pos & m_mask];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      }
+      else if (diff < 0) {
+        return false;
+      }
+      else {
+        pos = m_enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+    slot->value = std::move(value);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @return false if the queue is empty
+   */
+  bool
+  tryPop(T& value)
+  {
+    size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+      slot = &m_slots[pos & m_mask];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+      if (diff == 0) {
+        if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      }
+      else if (diff < 0) {
+        return false;
+      }
+      else {
+        pos = m_dequeuePos.load(std::memory_order_relaxed);
+      }
+    }
+    value = std::move(slot->value);
+    slot->value = T();
+    slot->sequence.store(pos + m_mask + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  struct Slot
+  {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  size_t m_mask;
+  unique_ptr<Slot[]> m_slots;
+  // producers and consumers touch different cache lines
+  alignas(64) std::atomic<size_t> m_enqueuePos;
+  alignas(64) std::atomic<size_t> m_dequeuePos;
+};
+
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_DETAIL_BOUNDED_QUEUE_HPP
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/ca-admission-control.hpp"
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+static const std::array<std::string, ADMISSION_ENDPOINT_COUNT> ENDPOINT_CONFIG_KEYS = {
+  "probe", "new", "challenge"
+};
+
+std::ostream&
+operator<<(std::ostream& os, AdmissionEndpoint endpoint)
+{
+  switch (endpoint) {
+    case AdmissionEndpoint::PROBE:
+      return os << "PROBE";
+    case AdmissionEndpoint::NEW:
+      return os << "NEW";
+    case AdmissionEndpoint::CHALLENGE:
+      return os << "CHALLENGE";
+  }
+  return os << "UNKNOWN";
+}
+
+TokenBucket::TokenBucket(double rate, double burst)
+  : m_rate(rate)
+  , m_burst(burst > 0.0 ? burst : rate)
+  , m_tokens(m_burst)
+  , m_lastRefill(time::steady_clock::now())
+{
+  if (m_burst < 1.0) {
+    m_burst = 1.0;
+    m_tokens = m_burst;
+  }
+}
+
+void
+TokenBucket::refill(const time::steady_clock::TimePoint& now)
+{
+  if (now <= m_lastRefill) {
+    return;
+  }
+  auto elapsed = time::duration_cast<time::nanoseconds>(now - m_lastRefill);
+  m_tokens = std::min(m_burst, m_tokens + m_rate * elapsed.count() / 1e9);
+  m_lastRefill = now;
+}
+
+bool
+TokenBucket::consume(const time::steady_clock::TimePoint& now, size_t nTokens)
+{
+  if (isUnlimited()) {
+    return true;
+  }
+  refill(now);
+  // a request costing more than the bucket can hold would never be admitted; it takes a full bucket
+  auto cost = std::min(static_cast<double>(nTokens), m_burst);
+  if (m_tokens < cost) {
+    return false;
+  }
+  m_tokens -= cost;
+  return true;
+}
+
+void
+TokenBucket::setLimit(const time::steady_clock::TimePoint& now, double rate, double burst)
+{
+  TokenBucket updated(rate, burst);
+  if (!isUnlimited()) {
+    // the tokens gathered so far accrue at the old rate
+    refill(now);
+    updated.m_tokens = std::min(m_tokens, updated.m_burst);
+  }
+  updated.m_lastRefill = now;
+  *this = updated;
+}
+
+AdmissionPolicy
+AdmissionPolicy::fromJson(const JsonSection& json)
+{
+  AdmissionPolicy policy;
+  auto action = json.get(CONFIG_ADMISSION_ACTION, "nack");
+  boost::algorithm::to_lower(action);
+  if (action == "nack") {
+    policy.shedAction = ShedAction::NACK;
+  }
+  else if (action == "drop") {
+    policy.shedAction = ShedAction::DROP;
+  }
+  else {
+    NDN_THROW(std::runtime_error("Unknown admission control action: " + action));
+  }
+
+  for (size_t i = 0; i < ADMISSION_ENDPOINT_COUNT; i++) {
+    auto limitSection = json.get_child_optional(ENDPOINT_CONFIG_KEYS[i]);
+    if (!limitSection) {
+      continue;
+    }
+    policy.limits[i].rate = limitSection->get(CONFIG_ADMISSION_RATE, 0.0);
+    policy.limits[i].burst = limitSection->get(CONFIG_ADMISSION_BURST, 0.0);
+    if (policy.limits[i].rate < 0.0 || policy.limits[i].burst < 0.0) {
+      NDN_THROW(std::runtime_error("Admission control rate and burst of " + ENDPOINT_CONFIG_KEYS[i] +
+                                   " cannot be negative"));
+    }
+  }
+  return policy;
+}
+
+AdmissionController::AdmissionController()
+{
+  m_admitted.fill(0);
+  m_shed.fill(0);
+}
+
+void
+AdmissionController::setPolicy(const AdmissionPolicy& policy)
+{
+  m_shedAction = policy.shedAction;
+  // a reload must not hand out a full bucket, or reloading would lift the limits
+  auto now = time::steady_clock::now();
+  for (size_t i = 0; i < ADMISSION_ENDPOINT_COUNT; i++) {
+    m_buckets[i].setLimit(now, policy.limits[i].rate, policy.limits[i].burst);
+  }
+}
+
+bool
+AdmissionController::admit(AdmissionEndpoint endpoint, size_t nTokens)
+{
+  auto now = time::steady_clock::now();
+  bool isAdmitted = getBucket(endpoint).consume(now, nTokens);
+  if (!isAdmitted && endpoint == AdmissionEndpoint::CHALLENGE &&
+      !getBucket(AdmissionEndpoint::NEW).isUnlimited()) {
+    // continuations of ongoing sessions take precedence over fresh NEW requests;
+    // an unlimited NEW bucket has nothing to lend, or the CHALLENGE limit would never apply
+    isAdmitted = getBucket(AdmissionEndpoint::NEW).consume(now);
+  }
+
+  if (isAdmitted) {
+    m_admitted[static_cast<size_t>(endpoint)]++;
+  }
+  else {
+    m_shed[static_cast<size_t>(endpoint)]++;
+  }
+  return isAdmitted;
+}
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_DETAIL_CA_ADMISSION_CONTROL_HPP
+#define NDNCERT_DETAIL_CA_ADMISSION_CONTROL_HPP
+
+#include "detail/ndncert-common.hpp"
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+// used in parsing the admission-control section of the CA configuration file
+const std::string CONFIG_ADMISSION_CONTROL = "admission-control";
+const std::string CONFIG_ADMISSION_ACTION = "action";
+const std::string CONFIG_ADMISSION_RATE = "rate";
+const std::string CONFIG_ADMISSION_BURST = "burst";
+
+/**
+ * @brief The CA endpoints that are rate limited separately.
+ *
+ * REVOKE requests share the bucket of NEW requests.
+ */
+enum class AdmissionEndpoint : size_t {
+  PROBE = 0,
+  NEW = 1,
+  CHALLENGE = 2
+};
+
+const size_t ADMISSION_ENDPOINT_COUNT = 3;
+
+std::ostream&
+operator<<(std::ostream& os, AdmissionEndpoint endpoint);
+
+/**
+ * @brief What to do with a request that is not admitted.
+ */
+enum class ShedAction {
+  NACK, ///< reply with an NDNLPv2 Nack with reason Congestion
+  DROP  ///< drop the Interest silently
+};
+
+/**
+ * @brief A token bucket refilled at a constant rate.
+ */
+class TokenBucket
+{
+public:
+  /**
+   * @param rate tokens added per second, zero for an unlimited bucket
+   * @param burst capacity of the bucket, defaults to one second worth of tokens
+   */
+  explicit
+  TokenBucket(double rate = 0.0, double burst = 0.0);
+
+  bool
+  isUnlimited() const
+  {
+    return m_rate <= 0.0;
+  }
+
+  /**
+   * @brief Take @p nTokens tokens from the bucket, all or none.
+   *
+   * A cost larger than the burst is capped at the burst, so that such a request is admitted
+   * whenever the bucket is full rather than never.
+   * @return false if the bucket holds fewer tokens
+   */
+  bool
+  consume(const time::steady_clock::TimePoint& now, size_t nTokens = 1);
+
+  /**
+   * @brief Change the rate and burst of the bucket.
+   *
+   * The tokens in the bucket are kept, up to the new burst, so that changing the limits does not
+   * refill the bucket. A bucket that was unlimited starts full.
+   */
+  void
+  setLimit(const time::steady_clock::TimePoint& now, double rate, double burst);
+
+private:
+  void
+  refill(const time::steady_clock::TimePoint& now);
+
+private:
+  double m_rate;
+  double m_burst;
+  double m_tokens;
+  time::steady_clock::TimePoint m_lastRefill;
+};
+
+/**
+ * @brief The admission policy of a CA.
+ *
+ * The format of the policy in JSON, as part of the CA configuration:
+ * "admission-control":
+ * {
+ *   "action": "nack",   // or "drop"
+ *   "probe": { "rate": "100", "burst": "200" },
+ *   "new": { "rate": "50", "burst": "100" },
+ *   "challenge": { "rate": "200", "burst": "400" }
+ * }
+ * Rates are in requests per second. An endpoint without a rate is not limited.
+ */
+class AdmissionPolicy
+{
+public:
+  /**
+   * @throw std::runtime_error when the section cannot be correctly parsed.
+   */
+  static AdmissionPolicy
+  fromJson(const JsonSection& json);
+
+public:
+  struct Limit
+  {
+    double rate = 0.0;
+    double burst = 0.0;
+  };
+
+  ShedAction shedAction = ShedAction::NACK;
+  std::array<Limit, ADMISSION_ENDPOINT_COUNT> limits;
+};
+
+/**
+ * @brief Admission control of the CA's PROBE, NEW/REVOKE, and CHALLENGE endpoints.
+ *
+ * Each endpoint has its own token bucket. A CHALLENGE that finds its bucket empty may borrow a
+ * token from a limited NEW bucket, so sessions that already paid for a NEW can finish while
+ * fresh NEW requests are shed.
+ */
+class AdmissionController : noncopyable
+{
+public:
+  AdmissionController();
+
+  /**
+   * @brief Apply a new policy. Counters and the tokens left in the buckets are preserved.
+   */
+  void
+  setPolicy(const AdmissionPolicy& policy);
+
+  /**
+   * @brief Decide whether a request to @p endpoint should be processed.
+   * @param nTokens the cost of the request, e.g., the number of entries of a BATCH-NEW request
+   */
+  bool
+  admit(AdmissionEndpoint endpoint, size_t nTokens = 1);
+
+  ShedAction
+  getShedAction() const
+  {
+    return m_shedAction;
+  }
+
+  uint64_t
+  getAdmittedCount(AdmissionEndpoint endpoint) const
+  {
+    return m_admitted[static_cast<size_t>(endpoint)];
+  }
+
+  uint64_t
+  getShedCount(AdmissionEndpoint endpoint) const
+  {
+    return m_shed[static_cast<size_t>(endpoint)];
+  }
+
+private:
+  TokenBucket&
+  getBucket(AdmissionEndpoint endpoint)
+  {
+    return m_buckets[static_cast<size_t>(endpoint)];
+  }
+
+private:
+  ShedAction m_shedAction = ShedAction::NACK;
+  std::array<TokenBucket, ADMISSION_ENDPOINT_COUNT> m_buckets;
+  std::array<uint64_t, ADMISSION_ENDPOINT_COUNT> m_admitted;
+  std::array<uint64_t, ADMISSION_ENDPOINT_COUNT> m_shed;
+};
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_DETAIL_CA_ADMISSION_CONTROL_HPP
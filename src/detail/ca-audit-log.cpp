@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/ca-audit-log.hpp"
+
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+NDN_LOG_INIT(ndncert.ca.audit);
+
+static void
+writeJsonString(std::ostream& os, const std::string& value)
+{
+  os << '"';
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      case '\r':
+        os << "\\r";
+        break;
+      case '\t':
+        os << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        }
+        else {
+          os << c;
+        }
+    }
+  }
+  os << '"';
+}
+
+AuditLogWriter::AuditLogWriter(const std::string& fileName, size_t syncBatchSize)
+  : m_fileName(fileName)
+  , m_syncBatchSize(std::max<size_t>(syncBatchSize, 1))
+{
+  m_fd = ::open(m_fileName.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0640);
+  if (m_fd < 0) {
+    NDN_THROW(std::runtime_error("Cannot open the audit log " + m_fileName + ": " + std::strerror(errno)));
+  }
+}
+
+AuditLogWriter::~AuditLogWriter()
+{
+  try {
+    sync();
+  }
+  catch (const std::exception& e) {
+    NDN_LOG_ERROR(e.what() << "; " << m_nBuffered << " records are lost");
+  }
+  ::close(m_fd);
+}
+
+EventBus::SubscriptionId
+AuditLogWriter::attach(EventBus& bus, const std::string& fileName, OverflowPolicy overflowPolicy)
+{
+  auto writer = make_shared<AuditLogWriter>(fileName);
+  SubscriptionOptions options;
+  options.overflowPolicy = overflowPolicy;
+  options.onIdle = [writer] { writer->sync(); };
+  return bus.subscribe([writer] (const StatusEvent& event) { writer->write(event); }, options);
+}
+
+void
+AuditLogWriter::write(const StatusEvent& event)
+{
+  m_buffer += formatRecord(event);
+  m_nBuffered++;
+  if (m_nBuffered >= m_syncBatchSize) {
+    sync();
+  }
+}
+
+void
+AuditLogWriter::sync()
+{
+  if (m_nBuffered == 0) {
+    return;
+  }
+  size_t written = 0;
+  while (written < m_buffer.size()) {
+    auto result = ::write(m_fd, m_buffer.data() + written, m_buffer.size() - written);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      // the part already written is not written again
+      m_buffer.erase(0, written);
+      NDN_THROW(std::runtime_error("Cannot write to the audit log " + m_fileName + ": " + std::strerror(errno)));
+    }
+    written += static_cast<size_t>(result);
+  }
+  m_buffer.clear();
+  m_nBuffered = 0;
+  if (::fsync(m_fd) != 0) {
+    NDN_THROW(std::runtime_error("Cannot sync the audit log " + m_fileName + ": " + std::strerror(errno)));
+  }
+}
+
+std::string
+AuditLogWriter::formatRecord(const StatusEvent& event)
+{
+  const auto& request = event.request;
+  std::ostringstream os;
+  os << "{\"time\":" << time::toUnixTimestamp(event.timestamp).count();
+  os << ",\"ca\":";
+  writeJsonString(os, request.caPrefix.toUri());
+  os << ",\"request\":\"" << toHex(request.requestId.data(), request.requestId.size()) << '"';
+  os << ",\"type\":";
+  writeJsonString(os, boost::lexical_cast<std::string>(request.requestType));
+  os << ",\"status\":";
+  writeJsonString(os, statusToString(request.status));
+  os << ",\"challenge\":";
+  writeJsonString(os, request.challengeType);
+  os << ",\"challenge-status\":";
+  writeJsonString(os, request.challengeState ? request.challengeState->challengeStatus : "");
+  os << ",\"certificate\":";
+  writeJsonString(os, request.cert.getName().toUri());
+  os << "}\n";
+  return os.str();
+}
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
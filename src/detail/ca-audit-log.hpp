@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_DETAIL_CA_AUDIT_LOG_HPP
+#define NDNCERT_DETAIL_CA_AUDIT_LOG_HPP
+
+#include "detail/ca-event-bus.hpp"
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+/**
+ * @brief Writes status events as JSON Lines audit records.
+ *
+ * Each record is one line such as
+ * {"time":1602720000123,"ca":"/ndn","request":"0011223344556677","type":"New","status":"Success",
+ *  "challenge":"pin","challenge-status":"","certificate":"/ndn/alice/KEY/..."}
+ * where "time" is in milliseconds since the Unix epoch. Secrets of the request are never written.
+ * Records are buffered and written and synced to the file in batches, once @p syncBatchSize
+ * records have accumulated or when sync() is called; a writer attached to an EventBus syncs
+ * whenever it has caught up with its queue, so a record reaches the disk shortly after its event
+ * at little cost under load. A writer must be used from one thread at a time.
+ */
+class AuditLogWriter : noncopyable
+{
+public:
+  /**
+   * @brief Open @p fileName for appending, creating it if it does not exist.
+   * @throw std::runtime_error the file cannot be opened
+   */
+  explicit
+  AuditLogWriter(const std::string& fileName, size_t syncBatchSize = 64);
+
+  /**
+   * @brief Sync the buffered records and close the file.
+   */
+  ~AuditLogWriter();
+
+  /**
+   * @brief Subscribe a writer of @p fileName to @p bus.
+   *
+   * The writer lives as long as the subscription. By default publishers wait rather than lose
+   * audit records when the writer falls behind.
+   */
+  static EventBus::SubscriptionId
+  attach(EventBus& bus, const std::string& fileName, OverflowPolicy overflowPolicy = OverflowPolicy::BLOCK);
+
+  /**
+   * @throw std::runtime_error the batch is full and cannot be written
+   */
+  void
+  write(const StatusEvent& event);
+
+  /**
+   * @brief Write the buffered records to the file and sync it.
+   * @throw std::runtime_error the records cannot be written; they stay buffered
+   */
+  void
+  sync();
+
+  static std::string
+  formatRecord(const StatusEvent& event);
+
+  const std::string&
+  getFileName() const
+  {
+    return m_fileName;
+  }
+
+private:
+  const std::string m_fileName;
+  const size_t m_syncBatchSize;
+  int m_fd = -1;
+  std::string m_buffer;
+  size_t m_nBuffered = 0;
+};
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_DETAIL_CA_AUDIT_LOG_HPP
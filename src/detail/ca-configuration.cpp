@@ -19,6 +19,7 @@
  */
 
 #include "detail/ca-configuration.hpp"
+#include "challenge/challenge-module.hpp"
 #include <ndn-cxx/util/io.hpp>
 #include <boost/filesystem.hpp>
 
@@ -26,8 +27,8 @@ namespace ndn {
 namespace ndncert {
 namespace ca {
 
-void
-CaConfig::load(const std::string& fileName)
+static JsonSection
+readConfigFile(const std::string& fileName)
 {
   JsonSection configJson;
   try {
@@ -39,10 +40,40 @@ CaConfig::load(const std::string& fileName)
   if (configJson.begin() == configJson.end()) {
     NDN_THROW(std::runtime_error("No JSON configuration found in file: " + fileName));
   }
+  return configJson;
+}
+
+static size_t
+parseWorkerThreads(const JsonSection& configJson)
+{
+  auto workerThreads = configJson.get(CONFIG_WORKER_THREADS, 0);
+  if (workerThreads < 0) {
+    NDN_THROW(std::runtime_error("The number of worker threads cannot be negative."));
+  }
+  return static_cast<size_t>(workerThreads);
+}
+
+void
+CaConfig::load(const std::string& fileName)
+{
+  auto configJson = readConfigFile(fileName);
     caProfile = CaProfile::fromJson(configJson);
   if (caProfile.supportedChallenges.size() == 0) {
     NDN_THROW(std::runtime_error("At least one challenge should be specified."));
   }
+  // parse the configuration files of the challenges if appear
+  challengeConfigPaths.clear();
+  for (const auto& item : configJson.get_child(CONFIG_SUPPORTED_CHALLENGES)) {
+    auto challengeConfigPath = item.second.get(CONFIG_CHALLENGE_CONFIG, "");
+    if (challengeConfigPath.empty()) {
+      continue;
+    }
+    if (boost::filesystem::path(challengeConfigPath).is_relative()) {
+      challengeConfigPath = (boost::filesystem::path(fileName).parent_path() / challengeConfigPath).string();
+    }
+    auto challengeType = ChallengeModule::findChallengeType(item.second.get(CONFIG_CHALLENGE, ""));
+    challengeConfigPaths[challengeType] = challengeConfigPath;
+  }
   // parse redirection section if appears
   redirection.clear();
   auto redirectionItems = configJson.get_child_optional(CONFIG_REDIRECTION);
@@ -70,6 +101,50 @@ CaConfig::load(const std::string& fileName)
       nameAssignmentFuncs.push_back(std::move(func));
     }
   }
+  // parse admission control if appears
+  admissionPolicy = AdmissionPolicy();
+  auto admissionSection = configJson.get_child_optional(CONFIG_ADMISSION_CONTROL);
+  if (admissionSection) {
+    admissionPolicy = AdmissionPolicy::fromJson(*admissionSection);
+  }
+  // parse the number of worker threads if appears
+  nWorkerThreads = parseWorkerThreads(configJson);
+  // parse the issuance log if appears
+  issuanceLogPath = configJson.get(CONFIG_ISSUANCE_LOG, "");
+  if (!issuanceLogPath.empty() && boost::filesystem::path(issuanceLogPath).is_relative()) {
+    issuanceLogPath = (boost::filesystem::path(fileName).parent_path() / issuanceLogPath).string();
+  }
+}
+
+void
+CaHostConfig::load(const std::string& fileName)
+{
+  auto configJson = readConfigFile(fileName);
+  nWorkerThreads = parseWorkerThreads(configJson);
+  caConfigFiles.clear();
+  storagePath.clear();
+
+  auto caListItems = configJson.get_child_optional(CONFIG_CA_LIST);
+  if (!caListItems) {
+    caConfigFiles.push_back(fileName);
+    return;
+  }
+  auto configDir = boost::filesystem::path(fileName).parent_path();
+  for (const auto& item : *caListItems) {
+    auto caConfigFile = item.second.get(CONFIG_CA_CONFIG, "");
+    if (caConfigFile.empty()) {
+      NDN_THROW(std::runtime_error("CA list item's config cannot be empty."));
+    }
+    boost::filesystem::path caConfigPath(caConfigFile);
+    if (caConfigPath.is_relative()) {
+      caConfigPath = configDir / caConfigPath;
+    }
+    caConfigFiles.push_back(caConfigPath.string());
+  }
+  if (caConfigFiles.empty()) {
+    NDN_THROW(std::runtime_error("At least one CA should be listed."));
+  }
+  storagePath = configJson.get(CONFIG_STORAGE_PATH, "");
 }
 
 } // namespace ca
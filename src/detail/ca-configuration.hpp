@@ -21,6 +21,7 @@
 #ifndef NDNCERT_DETAIL_CA_CONFIGURATION_HPP
 #define NDNCERT_DETAIL_CA_CONFIGURATION_HPP
 
+#include "detail/ca-admission-control.hpp"
 #include "detail/ca-profile.hpp"
 #include "name-assignment/assignment-func.hpp"
 
@@ -28,6 +29,13 @@ namespace ndn {
 namespace ndncert {
 namespace ca {
 
+const std::string CONFIG_WORKER_THREADS = "worker-threads";
+const std::string CONFIG_CA_LIST = "ca-list";
+const std::string CONFIG_CA_CONFIG = "config";
+const std::string CONFIG_STORAGE_PATH = "storage-path";
+const std::string CONFIG_ISSUANCE_LOG = "issuance-log";
+const std::string CONFIG_CHALLENGE_CONFIG = "config";
+
 /**
  * @brief CA's configuration on NDNCERT.
  *
@@ -45,8 +53,17 @@ namespace ca {
  *  "supported-challenges":
  *  [
  *    {"challenge": ""},
- *    {"challenge": ""}
- *  ]
+ *    {"challenge": "", "config": ""}
+ *  ],
+ *  "admission-control":
+ *  {
+ *    "action": "",
+ *    "probe": {"rate": "", "burst": ""},
+ *    "new": {"rate": "", "burst": ""},
+ *    "challenge": {"rate": "", "burst": ""}
+ *  },
+ *  "worker-threads": "",
+ *  "issuance-log": ""
  * }
  */
 class CaConfig
@@ -72,6 +89,70 @@ public:
    * @brief Name Assignment Functions
    */
   std::vector<std::unique_ptr<NameAssignmentFunc>> nameAssignmentFuncs;
+  /**
+   * @brief Rate limits of the CA's endpoints, unlimited by default
+   */
+  AdmissionPolicy admissionPolicy;
+  /**
+   * @brief Number of threads processing PROBE, NEW/REVOKE, and CHALLENGE requests,
+   *        zero to process them on the thread of the face
+   */
+  size_t nWorkerThreads = 0;
+  /**
+   * @brief File of the log of issued certificates, relative to the directory of the configuration
+   *        file, empty to keep no log. It cannot be changed by a reload.
+   */
+  std::string issuanceLogPath;
+  /**
+   * @brief Configuration file of each challenge that has one, relative to the directory of the
+   *        configuration file; a challenge not listed here reads its default configuration
+   */
+  std::map<std::string, std::string> challengeConfigPaths;
+};
+
+/**
+ * @brief Configuration of a process hosting several CAs.
+ *
+ * The format of the configuration in JSON
+ * {
+ *  "ca-list":
+ *  [
+ *    {"config": ""},
+ *    {"config": ""}
+ *  ],
+ *  "worker-threads": "",
+ *  "storage-path": ""
+ * }
+ * Each item of the list is the path of a CA configuration file, relative to the directory of
+ * this file. The hosted CAs share the worker threads and the storage, so the "worker-threads"
+ * option of their own configuration is ignored.
+ */
+class CaHostConfig
+{
+public:
+  /**
+   * @brief Load the configuration from the file.
+   *
+   * A file without "ca-list" is taken as the configuration of a single CA, which is then the
+   * only one hosted.
+   * @throw std::runtime_error when config file cannot be correctly parsed.
+   */
+  void
+  load(const std::string& fileName);
+
+public:
+  /**
+   * @brief Configuration files of the hosted CAs
+   */
+  std::vector<std::string> caConfigFiles;
+  /**
+   * @brief Number of threads processing the requests of all hosted CAs
+   */
+  size_t nWorkerThreads = 0;
+  /**
+   * @brief Location of the storage shared by all hosted CAs, empty for the default
+   */
+  std::string storagePath;
 };
 
 } // namespace ca
@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/ca-event-bus.hpp"
+#include "detail/bounded-queue.hpp"
+
+#include <condition_variable>
+#include <thread>
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+NDN_LOG_INIT(ndncert.ca.events);
+
+/**
+ * The queue itself is lock-free; the mutex and the condition variables are only used by a
+ * consumer waiting for an event and by producers waiting for room, which announce themselves
+ * in m_isConsumerWaiting and m_nWaitingProducers so that the other side takes the mutex only
+ * when someone has to be woken up.
+ */
+class EventBus::Subscription : noncopyable
+{
+public:
+  Subscription(SubscriptionId id, const Subscriber& subscriber, const SubscriptionOptions& options)
+    : m_id(id)
+    , m_subscriber(subscriber)
+    , m_options(options)
+    , m_queue(options.queueCapacity)
+    , m_isConsumerWaiting(false)
+    , m_nWaitingProducers(0)
+  {
+    m_thread = std::thread([this] { run(); });
+  }
+
+  ~Subscription()
+  {
+    stop();
+  }
+
+  SubscriptionId
+  getId() const
+  {
+    return m_id;
+  }
+
+  /**
+   * @return false if the event was dropped
+   */
+  bool
+  push(shared_ptr<const StatusEvent> event)
+  {
+    if (!m_queue.tryPush(event)) {
+      if (m_options.overflowPolicy == OverflowPolicy::DROP) {
+        return false;
+      }
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_nWaitingProducers++;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      while (!m_queue.tryPush(event)) {
+        if (m_isStopped) {
+          m_nWaitingProducers--;
+          return false;
+        }
+        m_hasRoom.wait(lock);
+      }
+      m_nWaitingProducers--;
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_isConsumerWaiting.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_hasEvent.notify_one();
+    }
+    return true;
+  }
+
+  void
+  stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_isStopped = true;
+    }
+    m_hasEvent.notify_all();
+    m_hasRoom.notify_all();
+    if (m_thread.joinable()) {
+      m_thread.join();
+    }
+  }
+
+private:
+  void
+  run()
+  {
+    shared_ptr<const StatusEvent> event;
+    bool isIdle = true;
+    while (true) {
+      if (!m_queue.tryPop(event)) {
+        if (!isIdle) {
+          isIdle = true;
+          if (m_options.onIdle) {
+            invoke(m_options.onIdle);
+          }
+          continue;
+        }
+        if (!waitForEvent(event)) {
+          return;
+        }
+      }
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (m_nWaitingProducers.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_hasRoom.notify_all();
+      }
+      isIdle = false;
+      invoke([this, &event] { m_subscriber(*event); });
+      event.reset();
+    }
+  }
+
+  /**
+   * @return false if the subscription is stopped and there is no event left
+   */
+  bool
+  waitForEvent(shared_ptr<const StatusEvent>& event)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_isConsumerWaiting.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!m_queue.tryPop(event)) {
+      if (m_isStopped) {
+        m_isConsumerWaiting.store(false, std::memory_order_relaxed);
+        return false;
+      }
+      m_hasEvent.wait(lock);
+    }
+    m_isConsumerWaiting.store(false, std::memory_order_relaxed);
+    return true;
+  }
+
+  template<typename Func>
+  void
+  invoke(const Func& func)
+  {
+    try {
+      func();
+    }
+    catch (const std::exception& e) {
+      NDN_LOG_ERROR("Subscriber " << m_id << " failed: " << e.what());
+    }
+  }
+
+private:
+  const SubscriptionId m_id;
+  const Subscriber m_subscriber;
+  const SubscriptionOptions m_options;
+  BoundedQueue<shared_ptr<const StatusEvent>> m_queue;
+
+  std::mutex m_mutex;
+  std::condition_variable m_hasEvent;
+  std::condition_variable m_hasRoom;
+  std::atomic<bool> m_isConsumerWaiting;
+  std::atomic<size_t> m_nWaitingProducers;
+  bool m_isStopped = false;
+  std::thread m_thread;
+};
+
+EventBus::EventBus()
+  : m_subscriptions(make_shared<const SubscriptionList>())
+  , m_nDropped(0)
+{
+}
+
+EventBus::~EventBus()
+{
+  auto subscriptions = std::atomic_load(&m_subscriptions);
+  for (const auto& subscription : *subscriptions) {
+    subscription->stop();
+  }
+}
+
+EventBus::SubscriptionId
+EventBus::subscribe(const Subscriber& subscriber, const SubscriptionOptions& options)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto id = ++m_lastId;
+  auto subscriptions = make_shared<SubscriptionList>(*m_subscriptions);
+  subscriptions->push_back(make_shared<Subscription>(id, subscriber, options));
+  std::atomic_store(&m_subscriptions, shared_ptr<const SubscriptionList>(std::move(subscriptions)));
+  NDN_LOG_DEBUG("Subscriber " << id << " added");
+  return id;
+}
+
+void
+EventBus::unsubscribe(SubscriptionId id)
+{
+  shared_ptr<Subscription> removed;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto subscriptions = make_shared<SubscriptionList>();
+    for (const auto& subscription : *m_subscriptions) {
+      if (subscription->getId() == id) {
+        removed = subscription;
+      }
+      else {
+        subscriptions->push_back(subscription);
+      }
+    }
+    std::atomic_store(&m_subscriptions, shared_ptr<const SubscriptionList>(std::move(subscriptions)));
+  }
+  if (removed != nullptr) {
+    removed->stop();
+    NDN_LOG_DEBUG("Subscriber " << id << " removed");
+  }
+}
+
+void
+EventBus::publish(const RequestState& request)
+{
+  auto subscriptions = std::atomic_load(&m_subscriptions);
+  if (subscriptions->empty()) {
+    return;
+  }
+  // one copy of the request shared by all subscribers
+  auto event = make_shared<const StatusEvent>(StatusEvent{time::system_clock::now(), request});
+  for (const auto& subscription : *subscriptions) {
+    if (!subscription->push(event)) {
+      auto nDropped = m_nDropped.fetch_add(1, std::memory_order_relaxed) + 1;
+      // warn at every power of two, so a subscriber that stays behind does not flood the log
+      if ((nDropped & (nDropped - 1)) == 0) {
+        NDN_LOG_WARN("Event dropped for subscriber " << subscription->getId() << ", " <<
+                     nDropped << " events dropped so far");
+      }
+      else {
+        NDN_LOG_TRACE("Event dropped for subscriber " << subscription->getId());
+      }
+    }
+  }
+}
+
+size_t
+EventBus::getSubscriberCount() const
+{
+  return std::atomic_load(&m_subscriptions)->size();
+}
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
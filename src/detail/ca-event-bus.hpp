@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_DETAIL_CA_EVENT_BUS_HPP
+#define NDNCERT_DETAIL_CA_EVENT_BUS_HPP
+
+#include "detail/ca-request-state.hpp"
+
+#include <atomic>
+#include <mutex>
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+/**
+ * @brief A change of the status of a certificate request.
+ */
+struct StatusEvent
+{
+  /**
+   * @brief When the change was published.
+   */
+  time::system_clock::TimePoint timestamp;
+  /**
+   * @brief The request after the change.
+   */
+  RequestState request;
+};
+
+/**
+ * @brief What a publisher does when the queue of a subscriber is full.
+ */
+enum class OverflowPolicy {
+  DROP, ///< drop the event for that subscriber
+  BLOCK ///< wait until the subscriber makes room
+};
+
+struct SubscriptionOptions
+{
+  /**
+   * @brief The maximum number of events waiting for the subscriber, rounded up to a power of two.
+   */
+  size_t queueCapacity = 1024;
+  OverflowPolicy overflowPolicy = OverflowPolicy::DROP;
+  /**
+   * @brief Invoked on the thread of the subscriber each time it has caught up with its queue.
+   */
+  function<void()> onIdle;
+};
+
+/**
+ * @brief Delivers the status events of the CA to any number of subscribers.
+ *
+ * Every subscriber has its own bounded lock-free queue and its own thread, so a slow subscriber
+ * neither delays the threads publishing the events nor the other subscribers, unless it asked
+ * for OverflowPolicy::BLOCK. Events are delivered to each subscriber in the order they are
+ * published by one thread. Publishing may happen on any thread.
+ */
+class EventBus : noncopyable
+{
+public:
+  using Subscriber = function<void(const StatusEvent&)>;
+  using SubscriptionId = uint64_t;
+
+  EventBus();
+
+  /**
+   * @brief Deliver the events already queued, then stop all subscribers.
+   */
+  ~EventBus();
+
+  SubscriptionId
+  subscribe(const Subscriber& subscriber, const SubscriptionOptions& options = SubscriptionOptions());
+
+  /**
+   * @brief Deliver the events already queued for the subscriber, then stop it.
+   *
+   * Must not be called from the thread of the subscriber itself.
+   */
+  void
+  unsubscribe(SubscriptionId id);
+
+  /**
+   * @brief Publish a new status of @p request, stamped with the current time.
+   */
+  void
+  publish(const RequestState& request);
+
+  size_t
+  getSubscriberCount() const;
+
+  /**
+   * @brief The number of events dropped because the queue of a subscriber was full.
+   */
+  uint64_t
+  getDroppedCount() const
+  {
+    return m_nDropped.load(std::memory_order_relaxed);
+  }
+
+private:
+  class Subscription;
+  using SubscriptionList = std::vector<shared_ptr<Subscription>>;
+
+  std::mutex m_mutex;
+  // replaced as a whole when subscribers change, so that publishing takes no lock
+  shared_ptr<const SubscriptionList> m_subscriptions;
+  SubscriptionId m_lastId = 0;
+  std::atomic<uint64_t> m_nDropped;
+};
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_DETAIL_CA_EVENT_BUS_HPP
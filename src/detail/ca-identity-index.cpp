@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/ca-identity-index.hpp"
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+void
+IdentityIndex::addPending(const RequestId& requestId, const Name& identityName)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_pendingRequests.emplace(requestId, identityName).second) {
+    m_pendingNames[identityName]++;
+  }
+}
+
+void
+IdentityIndex::removePending(const RequestId& requestId)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto request = m_pendingRequests.find(requestId);
+  if (request == m_pendingRequests.end()) {
+    return;
+  }
+  auto name = m_pendingNames.find(request->second);
+  if (name != m_pendingNames.end() && --name->second == 0) {
+    m_pendingNames.erase(name);
+  }
+  m_pendingRequests.erase(request);
+}
+
+void
+IdentityIndex::addIssued(const Name& identityName, const Name& keyName)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_issuedNames[identityName] = keyName;
+}
+
+void
+IdentityIndex::removeIssued(const Name& identityName, const Name& keyName)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto issued = m_issuedNames.find(identityName);
+  if (issued != m_issuedNames.end() && issued->second == keyName) {
+    m_issuedNames.erase(issued);
+  }
+}
+
+bool
+IdentityIndex::isUsed(const Name& identityName) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_pendingNames.count(identityName) > 0 || m_issuedNames.count(identityName) > 0;
+}
+
+size_t
+IdentityIndex::getPendingCount() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_pendingRequests.size();
+}
+
+size_t
+IdentityIndex::getIssuedCount() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_issuedNames.size();
+}
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
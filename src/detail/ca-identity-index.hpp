@@ -0,0 +1,90 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_DETAIL_CA_IDENTITY_INDEX_HPP
+#define NDNCERT_DETAIL_CA_IDENTITY_INDEX_HPP
+
+#include "detail/ca-request-state.hpp"
+
+#include <mutex>
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+/**
+ * @brief An in-memory index of the identity names a CA has issued or is working on.
+ *
+ * PROBE uses the index to avoid suggesting names that are taken. Issued names are only known from
+ * the time the CA started, as the storage forgets a request once its certificate is issued, so
+ * the index is a hint for the suggestions rather than a policy NEW could enforce.
+ * The index is safe to use from several threads.
+ */
+class IdentityIndex : noncopyable
+{
+public:
+  /**
+   * @brief Record a NEW or RENEW request that has been stored.
+   */
+  void
+  addPending(const RequestId& requestId, const Name& identityName);
+
+  /**
+   * @brief Forget a request once it is deleted from the storage, whatever its outcome.
+   */
+  void
+  removePending(const RequestId& requestId);
+
+  void
+  addIssued(const Name& identityName, const Name& keyName);
+
+  /**
+   * @brief Forget an issued name, if it was issued to @p keyName.
+   */
+  void
+  removeIssued(const Name& identityName, const Name& keyName);
+
+  /**
+   * @return whether @p identityName is issued or has a request in progress
+   */
+  bool
+  isUsed(const Name& identityName) const;
+
+  size_t
+  getPendingCount() const;
+
+  size_t
+  getIssuedCount() const;
+
+private:
+  mutable std::mutex m_mutex;
+  std::map<RequestId, Name> m_pendingRequests;
+  /**
+   * The number of pending requests of each identity name
+   */
+  std::map<Name, size_t> m_pendingNames;
+  std::map<Name, Name> m_issuedNames;
+};
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_DETAIL_CA_IDENTITY_INDEX_HPP
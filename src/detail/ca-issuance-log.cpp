@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/ca-issuance-log.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <unistd.h>
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+NDN_LOG_INIT(ndncert.ca.log);
+
+static const size_t READ_CHUNK_SIZE = 1 << 20;
+
+IssuanceLog::IssuanceLog(const std::string& fileName)
+  : m_fileName(fileName)
+{
+  load();
+  m_fd = ::open(m_fileName.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (m_fd < 0) {
+    NDN_THROW(std::runtime_error("Cannot open the issuance log " + m_fileName + ": " + std::strerror(errno)));
+  }
+  NDN_LOG_INFO("Issuance log " << m_fileName << " opened with " << m_tree.size() << " entries");
+}
+
+IssuanceLog::~IssuanceLog()
+{
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+}
+
+void
+IssuanceLog::load()
+{
+  m_offsets.assign(1, 0);
+  std::ifstream is(m_fileName, std::ios::binary);
+  if (!is) {
+    return;
+  }
+
+  // the file is read in chunks, as it may hold millions of certificates
+  std::vector<uint8_t> buffer;
+  size_t begin = 0;
+  uint64_t bufferOffset = 0;
+  bool isEof = false;
+  while (true) {
+    while (true) {
+      auto it = buffer.cbegin() + begin;
+      uint32_t type = 0;
+      uint64_t length = 0;
+      if (!ndn::tlv::readType(it, buffer.cend(), type) || !ndn::tlv::readVarNumber(it, buffer.cend(), length)) {
+        break;
+      }
+      if (type != ndn::tlv::Data) {
+        NDN_THROW(std::runtime_error("The issuance log " + m_fileName + " is corrupted at offset " +
+                                     to_string(bufferOffset + begin)));
+      }
+      if (static_cast<uint64_t>(buffer.cend() - it) < length) {
+        break;
+      }
+      size_t end = static_cast<size_t>(it - buffer.cbegin()) + length;
+      m_tree.append(MerkleTree::hashLeaf(buffer.data() + begin, end - begin));
+      m_offsets.push_back(bufferOffset + end);
+      begin = end;
+    }
+    if (isEof) {
+      break;
+    }
+    buffer.erase(buffer.begin(), buffer.begin() + begin);
+    bufferOffset += begin;
+    begin = 0;
+    size_t oldSize = buffer.size();
+    buffer.resize(oldSize + READ_CHUNK_SIZE);
+    is.read(reinterpret_cast<char*>(buffer.data() + oldSize), READ_CHUNK_SIZE);
+    buffer.resize(oldSize + static_cast<size_t>(is.gcount()));
+    isEof = is.gcount() == 0;
+  }
+  is.close();
+
+  // an entry cut short while being written is dropped
+  auto fileSize = boost::filesystem::file_size(m_fileName);
+  if (fileSize > m_offsets.back()) {
+    NDN_LOG_WARN("Dropping an incomplete entry at the end of the issuance log " << m_fileName);
+    boost::filesystem::resize_file(m_fileName, m_offsets.back());
+  }
+}
+
+uint64_t
+IssuanceLog::append(const security::Certificate& cert)
+{
+  const auto& wire = cert.wireEncode();
+  auto leafHash = MerkleTree::hashLeaf(wire.wire(), wire.size());
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_isCorrupted) {
+    NDN_THROW(std::runtime_error("The issuance log " + m_fileName + " holds a failed entry and must be reopened"));
+  }
+  size_t written = 0;
+  while (written < wire.size()) {
+    auto result = ::write(m_fd, wire.wire() + written, wire.size() - written);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      discardFailedEntry("Cannot write to the issuance log " + m_fileName + ": " + std::strerror(errno));
+    }
+    written += static_cast<size_t>(result);
+  }
+  // a certificate is only handed out once its entry is durable
+  if (::fsync(m_fd) != 0) {
+    discardFailedEntry("Cannot sync the issuance log " + m_fileName + ": " + std::strerror(errno));
+  }
+  m_offsets.push_back(m_offsets.back() + wire.size());
+  return m_tree.append(leafHash);
+}
+
+void
+IssuanceLog::discardFailedEntry(const std::string& error)
+{
+  // leave no bytes behind that the offsets and the tree do not account for
+  if (::ftruncate(m_fd, static_cast<off_t>(m_offsets.back())) != 0) {
+    NDN_LOG_ERROR("Cannot remove a failed entry from the issuance log " << m_fileName);
+    m_isCorrupted = true;
+  }
+  NDN_THROW(std::runtime_error(error));
+}
+
+uint64_t
+IssuanceLog::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_tree.size();
+}
+
+MerkleHash
+IssuanceLog::getRootHash(uint64_t treeSize) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_tree.getRootHash(treeSize);
+}
+
+InclusionProof
+IssuanceLog::getInclusionProof(uint64_t index, uint64_t treeSize) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_tree.getInclusionProof(index, treeSize);
+}
+
+Block
+IssuanceLog::getEntry(uint64_t index) const
+{
+  uint64_t offset = 0;
+  size_t size = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (index >= m_tree.size()) {
+      NDN_THROW(std::out_of_range("The issuance log has no entry " + to_string(index)));
+    }
+    offset = m_offsets[index];
+    size = static_cast<size_t>(m_offsets[index + 1] - offset);
+  }
+  auto buffer = make_shared<Buffer>(size);
+  size_t nRead = 0;
+  while (nRead < size) {
+    auto result = ::pread(m_fd, buffer->data() + nRead, size - nRead, static_cast<off_t>(offset + nRead));
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      NDN_THROW(std::runtime_error("Cannot read entry " + to_string(index) + " of the issuance log " + m_fileName));
+    }
+    nRead += static_cast<size_t>(result);
+  }
+  return Block(buffer);
+}
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
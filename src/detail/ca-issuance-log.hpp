@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_DETAIL_CA_ISSUANCE_LOG_HPP
+#define NDNCERT_DETAIL_CA_ISSUANCE_LOG_HPP
+
+#include "detail/merkle-tree.hpp"
+
+#include <mutex>
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+/**
+ * @brief An append-only log of the certificates issued by a CA.
+ *
+ * The certificates are appended in their wire format to a segment file and are the leaves of a
+ * Merkle tree, from which the CA serves signed tree heads and inclusion proofs. Only the leaf
+ * hashes and the file offsets of the entries are kept in memory; the tree is rebuilt from the
+ * file when the log is opened, dropping an entry cut short by a crash. The log is safe to use
+ * from several threads.
+ */
+class IssuanceLog : noncopyable
+{
+public:
+  /**
+   * @brief Open the log in @p fileName, which is created if it does not exist.
+   * @throw std::runtime_error the file cannot be read or opened for appending
+   */
+  explicit
+  IssuanceLog(const std::string& fileName);
+
+  ~IssuanceLog();
+
+  /**
+   * @brief Append a certificate and write it through to the file.
+   *
+   * An entry that cannot be written or synced is removed from the file again, so the file always
+   * holds exactly the entries of the tree.
+   *
+   * @return the index of the entry
+   * @throw std::runtime_error the entry cannot be written
+   */
+  uint64_t
+  append(const security::Certificate& cert);
+
+  uint64_t
+  size() const;
+
+  MerkleHash
+  getRootHash(uint64_t treeSize) const;
+
+  /**
+   * @throw std::out_of_range the entry is not in a tree of @p treeSize entries
+   */
+  InclusionProof
+  getInclusionProof(uint64_t index, uint64_t treeSize) const;
+
+  /**
+   * @brief Read an entry back from the file.
+   * @throw std::out_of_range there is no such entry
+   */
+  Block
+  getEntry(uint64_t index) const;
+
+  const std::string&
+  getFileName() const
+  {
+    return m_fileName;
+  }
+
+private:
+  void
+  load();
+
+  /**
+   * @brief Remove the bytes of an entry that failed to be appended, then throw @p error.
+   */
+  [[noreturn]] void
+  discardFailedEntry(const std::string& error);
+
+private:
+  const std::string m_fileName;
+  int m_fd = -1;
+  mutable std::mutex m_mutex;
+  MerkleTree m_tree;
+  /**
+   * Offset of each entry in the file, followed by the end of the last one
+   */
+  std::vector<uint64_t> m_offsets;
+  /**
+   * Set when a failed entry could not be removed, after which nothing can be appended
+   */
+  bool m_isCorrupted = false;
+};
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_DETAIL_CA_ISSUANCE_LOG_HPP
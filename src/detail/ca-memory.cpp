@@ -20,6 +20,7 @@
 
 #include "detail/ca-memory.hpp"
 #include <ndn-cxx/security/validation-policy.hpp>
+#include <ndn-cxx/util/random.hpp>
 
 namespace ndn {
 namespace ndncert {
@@ -38,6 +39,7 @@ CaMemory::CaMemory(const Name& caName, const std::string& path)
 RequestState
 CaMemory::getRequest(const RequestId& requestId)
 {
+  std::lock_guard<std::mutex> lock(m_mutex);
   auto search = m_requests.find(requestId);
   if (search == m_requests.end()) {
     NDN_THROW(std::runtime_error("Request " + toHex(requestId.data(), requestId.size()) + " doest not exists"));
@@ -48,18 +50,20 @@ CaMemory::getRequest(const RequestId& requestId)
 void
 CaMemory::addRequest(const RequestState& request)
 {
+  std::lock_guard<std::mutex> lock(m_mutex);
   auto search = m_requests.find(request.requestId);
   if (search == m_requests.end()) {
     m_requests.insert(std::make_pair(request.requestId, request));
   }
   else {
-    NDN_THROW(std::runtime_error("Request " + toHex(request.requestId.data(), request.requestId.size()) + " already exists"));
+    NDN_THROW(DuplicateRequestError("Request " + toHex(request.requestId.data(), request.requestId.size()) + " already exists"));
   }
 }
 
 void
 CaMemory::updateRequest(const RequestState& request)
 {
+  std::lock_guard<std::mutex> lock(m_mutex);
   auto search = m_requests.find(request.requestId);
   if (search == m_requests.end()) {
     m_requests.insert(std::make_pair(request.requestId, request));
@@ -72,8 +76,8 @@ CaMemory::updateRequest(const RequestState& request)
 void
 CaMemory::deleteRequest(const RequestId& requestId)
 {
+  std::lock_guard<std::mutex> lock(m_mutex);
   auto search = m_requests.find(requestId);
-  auto keyName = search->second.cert.getKeyName();
   if (search != m_requests.end()) {
     m_requests.erase(search);
   }
@@ -82,6 +86,7 @@ CaMemory::deleteRequest(const RequestId& requestId)
 std::list<RequestState>
 CaMemory::listAllRequests()
 {
+  std::lock_guard<std::mutex> lock(m_mutex);
   std::list<RequestState> result;
   for (const auto& entry : m_requests) {
     result.push_back(entry.second);
@@ -92,6 +97,7 @@ CaMemory::listAllRequests()
 std::list<RequestState>
 CaMemory::listAllRequests(const Name& caName)
 {
+  std::lock_guard<std::mutex> lock(m_mutex);
   std::list<RequestState> result;
   for (const auto& entry : m_requests) {
     if (entry.second.caPrefix == caName) {
@@ -101,6 +107,19 @@ CaMemory::listAllRequests(const Name& caName)
   return result;
 }
 
+Buffer
+CaMemory::getRequestIdKey(const Name& caName)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto search = m_requestIdKeys.find(caName);
+  if (search == m_requestIdKeys.end()) {
+    Buffer key(REQUEST_ID_KEY_SIZE);
+    random::generateSecureBytes(key.data(), key.size());
+    search = m_requestIdKeys.emplace(caName, std::move(key)).first;
+  }
+  return search->second;
+}
+
 } // namespace ca
 } // namespace ndncert
 } // namespace ndn
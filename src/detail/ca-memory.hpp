@@ -23,6 +23,8 @@
 
 #include "detail/ca-storage.hpp"
 
+#include <mutex>
+
 namespace ndn {
 namespace ndncert {
 namespace ca {
@@ -58,8 +60,13 @@ public:
   std::list<RequestState>
   listAllRequests(const Name& caName) override;
 
+  Buffer
+  getRequestIdKey(const Name& caName) override;
+
 private:
+  std::mutex m_mutex;
   std::map<RequestId, RequestState> m_requests;
+  std::map<Name, Buffer> m_requestIdKeys;
 };
 
 } // namespace ca
@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/ca-metrics.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+static const uint64_t MAX_HISTOGRAM_VALUE = (uint64_t(1) << LatencyHistogram::MAX_VALUE_BITS) - 1;
+static const std::array<double, 5> REPORTED_QUANTILES = {0.5, 0.9, 0.99, 0.999, 1.0};
+
+LatencyHistogram::LatencyHistogram()
+  : m_count(0)
+  , m_sum(0)
+  , m_max(0)
+{
+  for (auto& bucket : m_buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+size_t
+LatencyHistogram::getBucketIndex(uint64_t value)
+{
+  if (value < 2 * SUB_BUCKET_COUNT) {
+    return static_cast<size_t>(value);
+  }
+  // position of the most significant bit, at least SUB_BUCKET_BITS + 1
+  size_t msb = 63 - static_cast<size_t>(__builtin_clzll(value));
+  size_t shift = msb - SUB_BUCKET_BITS;
+  size_t subBucket = static_cast<size_t>(value >> shift) - SUB_BUCKET_COUNT;
+  return 2 * SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_COUNT + subBucket;
+}
+
+uint64_t
+LatencyHistogram::getBucketHighestValue(size_t index)
+{
+  if (index < 2 * SUB_BUCKET_COUNT) {
+    return index;
+  }
+  size_t shift = (index - 2 * SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT + 1;
+  uint64_t subBucket = (index - 2 * SUB_BUCKET_COUNT) % SUB_BUCKET_COUNT;
+  uint64_t lowest = (SUB_BUCKET_COUNT + subBucket) << shift;
+  return lowest + (uint64_t(1) << shift) - 1;
+}
+
+void
+LatencyHistogram::record(time::nanoseconds value)
+{
+  uint64_t ns = value.count() < 0 ? 0 : static_cast<uint64_t>(value.count());
+  if (ns > MAX_HISTOGRAM_VALUE) {
+    ns = MAX_HISTOGRAM_VALUE;
+  }
+  m_buckets[getBucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  m_sum.fetch_add(ns, std::memory_order_relaxed);
+  uint64_t currentMax = m_max.load(std::memory_order_relaxed);
+  while (ns > currentMax && !m_max.compare_exchange_weak(currentMax, ns, std::memory_order_relaxed)) {
+  }
+}
+
+time::nanoseconds
+LatencyHistogram::getPercentile(double quantile) const
+{
+  // the bucket counters may be updated while we read them, so rely on their own total
+  uint64_t total = 0;
+  for (const auto& bucket : m_buckets) {
+    total += bucket.load(std::memory_order_relaxed);
+  }
+  if (total == 0) {
+    return time::nanoseconds::zero();
+  }
+  quantile = std::min(std::max(quantile, 0.0), 1.0);
+  auto target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * total)));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < BUCKET_COUNT; i++) {
+    seen += m_buckets[i].load(std::memory_order_relaxed);
+    if (seen >= target) {
+      return time::nanoseconds(std::min(getBucketHighestValue(i), m_max.load(std::memory_order_relaxed)));
+    }
+  }
+  return getMax();
+}
+
+std::ostream&
+operator<<(std::ostream& os, CaHandler handler)
+{
+  switch (handler) {
+    case CaHandler::PROFILE_DISCOVERY:
+      return os << "profile-discovery";
+    case CaHandler::PROBE:
+      return os << "probe";
+    case CaHandler::NEW_RENEW_REVOKE:
+      return os << "new-renew-revoke";
+    case CaHandler::CHALLENGE:
+      return os << "challenge";
+  }
+  return os << "unknown";
+}
+
+CaMetrics::CaMetrics()
+{
+  for (auto& counter : m_errors) {
+    counter.store(0, std::memory_order_relaxed);
+  }
+}
+
+void
+CaMetrics::recordHandler(CaHandler handler, time::nanoseconds latency)
+{
+  m_handlerLatency[static_cast<size_t>(handler)].record(latency);
+}
+
+void
+CaMetrics::recordStage(ProcessingStage stage, time::nanoseconds latency)
+{
+  m_stageLatency[static_cast<size_t>(stage)].record(latency);
+}
+
+void
+CaMetrics::recordError(ErrorCode error)
+{
+  auto index = static_cast<size_t>(error);
+  if (index > ERROR_CODE_COUNT) {
+    index = ERROR_CODE_COUNT;
+  }
+  m_errors[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t
+CaMetrics::getErrorCount(ErrorCode error) const
+{
+  auto index = static_cast<size_t>(error);
+  if (index > ERROR_CODE_COUNT) {
+    index = ERROR_CODE_COUNT;
+  }
+  return m_errors[index].load(std::memory_order_relaxed);
+}
+
+template<typename T>
+static std::string
+toLabelValue(const T& value)
+{
+  std::ostringstream os;
+  os << value;
+  return os.str();
+}
+
+void
+collectHistogram(std::vector<MetricSample>& samples, const std::string& name,
+                 const std::pair<std::string, std::string>& label, const LatencyHistogram& histogram)
+{
+  for (auto quantile : REPORTED_QUANTILES) {
+    samples.push_back({name, {label, {"quantile", toLabelValue(quantile)}},
+                       histogram.getPercentile(quantile).count() / 1e9});
+  }
+  samples.push_back({name + "_sum", {label}, histogram.getSum().count() / 1e9});
+  samples.push_back({name + "_count", {label}, static_cast<double>(histogram.getCount())});
+}
+
+void
+CaMetrics::collect(std::vector<MetricSample>& samples) const
+{
+  for (size_t i = 0; i < CA_HANDLER_COUNT; i++) {
+    collectHistogram(samples, "ndncert_request_latency_seconds",
+                     {"handler", toLabelValue(static_cast<CaHandler>(i))}, m_handlerLatency[i]);
+  }
+  for (size_t i = 0; i < PROCESSING_STAGE_COUNT; i++) {
+    collectHistogram(samples, "ndncert_stage_latency_seconds",
+                     {"stage", toLabelValue(static_cast<ProcessingStage>(i))}, m_stageLatency[i]);
+  }
+  for (size_t i = 0; i <= ERROR_CODE_COUNT; i++) {
+    samples.push_back({"ndncert_errors_total", {{"code", toLabelValue(static_cast<ErrorCode>(i))}},
+                       static_cast<double>(m_errors[i].load(std::memory_order_relaxed))});
+  }
+}
+
+std::string
+encodeMetricsJson(const Name& caPrefix, const std::vector<MetricSample>& samples)
+{
+  JsonSection root;
+  root.put("ca-prefix", caPrefix.toUri());
+  root.put("timestamp", time::toIsoString(time::system_clock::now()));
+  JsonSection metrics;
+  for (const auto& sample : samples) {
+    JsonSection item;
+    item.put("name", sample.name);
+    for (const auto& label : sample.labels) {
+      item.put("labels." + label.first, label.second);
+    }
+    item.put("value", sample.value);
+    metrics.push_back(std::make_pair("", item));
+  }
+  root.add_child("metrics", metrics);
+
+  std::ostringstream os;
+  boost::property_tree::write_json(os, root, false);
+  return os.str();
+}
+
+std::string
+formatPrometheusText(const std::vector<MetricSample>& samples)
+{
+  std::ostringstream os;
+  os << std::setprecision(9);
+  for (const auto& sample : samples) {
+    os << sample.name;
+    if (!sample.labels.empty()) {
+      os << '{';
+      bool isFirst = true;
+      for (const auto& label : sample.labels) {
+        if (!isFirst) {
+          os << ',';
+        }
+        isFirst = false;
+        os << label.first << "=\"" << label.second << '"';
+      }
+      os << '}';
+    }
+    os << ' ' << sample.value << '\n';
+  }
+  return os.str();
+}
+
+void
+writePrometheusFile(const std::string& fileName, const std::vector<MetricSample>& samples)
+{
+  std::string tmpFileName = fileName + ".tmp";
+  {
+    std::ofstream file(tmpFileName, std::ios::trunc);
+    file << formatPrometheusText(samples);
+    if (!file) {
+      NDN_THROW(std::runtime_error("Cannot write metrics to " + tmpFileName));
+    }
+  }
+  if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+    NDN_THROW(std::runtime_error("Cannot move metrics file to " + fileName));
+  }
+}
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_DETAIL_CA_METRICS_HPP
+#define NDNCERT_DETAIL_CA_METRICS_HPP
+
+#include "detail/ca-request-deadline.hpp"
+
+#include <atomic>
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+/**
+ * @brief A lock-free latency histogram with HDR-style log-linear buckets.
+ *
+ * Values below 64 ns have their own bucket. Above that, every power of two is split into 32
+ * buckets, so a percentile is reported with a relative error of at most 1/32. Values are
+ * clamped to 2^40 ns (about 18 minutes).
+ */
+class LatencyHistogram : noncopyable
+{
+public:
+  LatencyHistogram();
+
+  void
+  record(time::nanoseconds value);
+
+  uint64_t
+  getCount() const
+  {
+    return m_count.load(std::memory_order_relaxed);
+  }
+
+  time::nanoseconds
+  getSum() const
+  {
+    return time::nanoseconds(m_sum.load(std::memory_order_relaxed));
+  }
+
+  time::nanoseconds
+  getMax() const
+  {
+    return time::nanoseconds(m_max.load(std::memory_order_relaxed));
+  }
+
+  /**
+   * @brief The smallest recorded value that is greater than or equal to a @p quantile of all
+   *        recorded values, at the resolution of the buckets.
+   * @param quantile in [0, 1]
+   */
+  time::nanoseconds
+  getPercentile(double quantile) const;
+
+NDNCERT_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  static size_t
+  getBucketIndex(uint64_t value);
+
+  static uint64_t
+  getBucketHighestValue(size_t index);
+
+public:
+  static const size_t SUB_BUCKET_BITS = 5;
+  static const size_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+  static const size_t MAX_VALUE_BITS = 40;
+  static const size_t BUCKET_COUNT = 2 * SUB_BUCKET_COUNT + (MAX_VALUE_BITS - SUB_BUCKET_BITS - 1) * SUB_BUCKET_COUNT;
+
+private:
+  std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets;
+  std::atomic<uint64_t> m_count;
+  std::atomic<uint64_t> m_sum;
+  std::atomic<uint64_t> m_max;
+};
+
+/**
+ * @brief The request handlers of the CA.
+ */
+enum class CaHandler : size_t {
+  PROFILE_DISCOVERY = 0,
+  PROBE = 1,
+  NEW_RENEW_REVOKE = 2,
+  CHALLENGE = 3
+};
+
+const size_t CA_HANDLER_COUNT = 4;
+
+std::ostream&
+operator<<(std::ostream& os, CaHandler handler);
+
+/**
+ * @brief A single value of a metric, labeled in the Prometheus way.
+ */
+struct MetricSample
+{
+  std::string name;
+  std::vector<std::pair<std::string, std::string>> labels;
+  double value;
+};
+
+/**
+ * @brief Runtime counters and latency histograms of a CA.
+ *
+ * All methods may be called concurrently from any thread.
+ */
+class CaMetrics : noncopyable
+{
+public:
+  CaMetrics();
+
+  void
+  recordHandler(CaHandler handler, time::nanoseconds latency);
+
+  void
+  recordStage(ProcessingStage stage, time::nanoseconds latency);
+
+  void
+  recordError(ErrorCode error);
+
+  uint64_t
+  getHandlerCount(CaHandler handler) const
+  {
+    return m_handlerLatency[static_cast<size_t>(handler)].getCount();
+  }
+
+  const LatencyHistogram&
+  getHandlerLatency(CaHandler handler) const
+  {
+    return m_handlerLatency[static_cast<size_t>(handler)];
+  }
+
+  const LatencyHistogram&
+  getStageLatency(ProcessingStage stage) const
+  {
+    return m_stageLatency[static_cast<size_t>(stage)];
+  }
+
+  uint64_t
+  getErrorCount(ErrorCode error) const;
+
+  /**
+   * @brief Append the samples of all counters and histograms to @p samples.
+   */
+  void
+  collect(std::vector<MetricSample>& samples) const;
+
+private:
+  static const size_t ERROR_CODE_COUNT = static_cast<size_t>(ErrorCode::NO_AVAILABLE_NAMES) + 1;
+
+  std::array<LatencyHistogram, CA_HANDLER_COUNT> m_handlerLatency;
+  std::array<LatencyHistogram, PROCESSING_STAGE_COUNT> m_stageLatency;
+  std::array<std::atomic<uint64_t>, ERROR_CODE_COUNT + 1> m_errors; // last one for unknown codes
+};
+
+/**
+ * @brief Measures the time spent in a processing stage until it goes out of scope.
+ */
+class ScopedStageTimer : noncopyable
+{
+public:
+  ScopedStageTimer(CaMetrics& metrics, ProcessingStage stage)
+    : m_metrics(metrics)
+    , m_stage(stage)
+    , m_startTime(time::steady_clock::now())
+  {
+  }
+
+  ~ScopedStageTimer()
+  {
+    m_metrics.recordStage(m_stage, time::steady_clock::now() - m_startTime);
+  }
+
+private:
+  CaMetrics& m_metrics;
+  ProcessingStage m_stage;
+  time::steady_clock::TimePoint m_startTime;
+};
+
+/**
+ * @brief Append a histogram to @p samples as a Prometheus summary.
+ */
+void
+collectHistogram(std::vector<MetricSample>& samples, const std::string& name,
+                 const std::pair<std::string, std::string>& label, const LatencyHistogram& histogram);
+
+/**
+ * @brief Encode @p samples as the JSON content of the CA's metrics dataset.
+ */
+std::string
+encodeMetricsJson(const Name& caPrefix, const std::vector<MetricSample>& samples);
+
+/**
+ * @brief Format @p samples in the Prometheus text exposition format.
+ */
+std::string
+formatPrometheusText(const std::vector<MetricSample>& samples);
+
+/**
+ * @brief Write @p samples to @p fileName in the Prometheus text format.
+ *
+ * The file is replaced atomically, so a collector never reads a partially written file.
+ * @throw std::runtime_error when the file cannot be written.
+ */
+void
+writePrometheusFile(const std::string& fileName, const std::vector<MetricSample>& samples);
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_DETAIL_CA_METRICS_HPP
@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/ca-probe-cache.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+ProbeCache::ProbeCache(size_t capacity, time::nanoseconds lifetime)
+  : m_capacity(capacity)
+  , m_lifetime(lifetime)
+{
+}
+
+uint64_t
+ProbeCache::getEpoch() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_epoch;
+}
+
+shared_ptr<const Data>
+ProbeCache::find(const Name& interestName, const function<bool(const Name&)>& isNameUsed)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto search = m_index.find(interestName);
+  if (search == m_index.end()) {
+    m_nMisses++;
+    return nullptr;
+  }
+  auto entry = search->second;
+  if (entry->expiry <= time::steady_clock::now() ||
+      std::any_of(entry->names.begin(), entry->names.end(), isNameUsed)) {
+    erase(entry);
+    m_nMisses++;
+    return nullptr;
+  }
+  m_entries.splice(m_entries.begin(), m_entries, entry);
+  m_nHits++;
+  return entry->reply;
+}
+
+void
+ProbeCache::insert(const Name& interestName, shared_ptr<const Data> reply, std::vector<Name> names,
+                   uint64_t epoch)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_capacity == 0 || epoch != m_epoch) {
+    return;
+  }
+  auto search = m_index.find(interestName);
+  if (search != m_index.end()) {
+    erase(search->second);
+  }
+  m_entries.push_front({interestName, std::move(reply), std::move(names),
+                        time::steady_clock::now() + m_lifetime});
+  m_index.emplace(interestName, m_entries.begin());
+  while (m_entries.size() > m_capacity) {
+    erase(std::prev(m_entries.end()));
+  }
+}
+
+void
+ProbeCache::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+  m_index.clear();
+  m_epoch++;
+}
+
+size_t
+ProbeCache::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+uint64_t
+ProbeCache::getHitCount() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nHits;
+}
+
+uint64_t
+ProbeCache::getMissCount() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nMisses;
+}
+
+void
+ProbeCache::erase(std::list<Entry>::iterator entry)
+{
+  m_index.erase(entry->interestName);
+  m_entries.erase(entry);
+}
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_DETAIL_CA_PROBE_CACHE_HPP
+#define NDNCERT_DETAIL_CA_PROBE_CACHE_HPP
+
+#include "detail/ndncert-common.hpp"
+
+#include <list>
+#include <mutex>
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+/**
+ * @brief A bounded LRU cache of signed PROBE replies.
+ *
+ * Replies are keyed by the PROBE Interest name, whose ParametersSha256DigestComponent covers the
+ * probe parameters, as a cached Data can only answer an Interest with the same name. Only replies
+ * suggesting names are cached, and only from deterministic name assignment functions. A reply is
+ * dropped when it expires, when one of the names it suggests has been taken since, or when the
+ * cache is cleared after the configuration or the CA certificate changes.
+ */
+class ProbeCache : noncopyable
+{
+public:
+  explicit
+  ProbeCache(size_t capacity = 1024, time::nanoseconds lifetime = time::minutes(10));
+
+  /**
+   * @brief The epoch of the cache, which changes on every clear().
+   *
+   * A reply computed from the configuration of an epoch is only inserted in the same epoch.
+   */
+  uint64_t
+  getEpoch() const;
+
+  /**
+   * @param isNameUsed tells whether a suggested name has been taken
+   * @return the cached reply, or nullptr if there is no valid one
+   */
+  shared_ptr<const Data>
+  find(const Name& interestName, const function<bool(const Name&)>& isNameUsed);
+
+  /**
+   * @param names the identity names suggested in the reply
+   */
+  void
+  insert(const Name& interestName, shared_ptr<const Data> reply, std::vector<Name> names, uint64_t epoch);
+
+  void
+  clear();
+
+  size_t
+  size() const;
+
+  uint64_t
+  getHitCount() const;
+
+  uint64_t
+  getMissCount() const;
+
+private:
+  struct Entry
+  {
+    Name interestName;
+    shared_ptr<const Data> reply;
+    std::vector<Name> names;
+    time::steady_clock::TimePoint expiry;
+  };
+
+  void
+  erase(std::list<Entry>::iterator entry);
+
+private:
+  const size_t m_capacity;
+  const time::nanoseconds m_lifetime;
+  mutable std::mutex m_mutex;
+  /**
+   * Most recently used first
+   */
+  std::list<Entry> m_entries;
+  std::map<Name, std::list<Entry>::iterator> m_index;
+  uint64_t m_epoch = 0;
+  uint64_t m_nHits = 0;
+  uint64_t m_nMisses = 0;
+};
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_DETAIL_CA_PROBE_CACHE_HPP
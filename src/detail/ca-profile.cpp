@@ -63,13 +63,15 @@ CaProfile::fromJson(const JsonSection& json)
   auto challengeListJson = json.get_child_optional(CONFIG_SUPPORTED_CHALLENGES);
   if (challengeListJson) {
     for (const auto& item : *challengeListJson) {
-      auto challengeType = item.second.get(CONFIG_CHALLENGE, "");
-      challengeType = boost::algorithm::to_lower_copy(challengeType);
-      if (challengeType == "") {
+      auto configuredType = item.second.get(CONFIG_CHALLENGE, "");
+      if (configuredType == "") {
         NDN_THROW(std::runtime_error("Challenge type canont be empty."));
       }
-      if (!ChallengeModule::isChallengeSupported(challengeType)) {
-        NDN_THROW(std::runtime_error("Challenge " + challengeType + " is not supported."));
+      // the type is matched regardless of case and kept as registered, e.g., "Possession"
+      auto challengeType = ChallengeModule::findChallengeType(configuredType);
+      if (challengeType.empty()) {
+        NDN_THROW(std::runtime_error("Challenge " + boost::algorithm::to_lower_copy(configuredType) +
+                                     " is not supported."));
       }
       profile.supportedChallenges.push_back(challengeType);
     }
@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/ca-request-deadline.hpp"
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+std::ostream&
+operator<<(std::ostream& os, ProcessingStage stage)
+{
+  switch (stage) {
+    case ProcessingStage::ECDH:
+      return os << "ecdh";
+    case ProcessingStage::STORAGE:
+      return os << "storage";
+    case ProcessingStage::CHALLENGE:
+      return os << "challenge";
+    case ProcessingStage::SIGNING:
+      return os << "signing";
+  }
+  return os << "unknown";
+}
+
+RequestDeadline::RequestDeadline(const Interest& interest)
+  : RequestDeadline(interest, time::steady_clock::now())
+{
+}
+
+RequestDeadline::RequestDeadline(const Interest& interest, const time::steady_clock::TimePoint& arrivalTime)
+  : m_arrivalTime(arrivalTime)
+  , m_deadline(arrivalTime + interest.getInterestLifetime())
+{
+}
+
+DeadlineStatistics::DeadlineStatistics()
+{
+  for (auto& count : m_skipped) {
+    count.store(0, std::memory_order_relaxed);
+  }
+}
+
+uint64_t
+DeadlineStatistics::getExpiredRequestCount() const
+{
+  // a request is abandoned at the first stage that finds its deadline expired
+  uint64_t total = 0;
+  for (const auto& count : m_skipped) {
+    total += count.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_DETAIL_CA_REQUEST_DEADLINE_HPP
+#define NDNCERT_DETAIL_CA_REQUEST_DEADLINE_HPP
+
+#include "detail/ndncert-common.hpp"
+
+#include <atomic>
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+/**
+ * @brief The expensive steps of request processing.
+ */
+enum class ProcessingStage : size_t {
+  ECDH = 0,
+  STORAGE = 1,
+  CHALLENGE = 2,
+  SIGNING = 3
+};
+
+const size_t PROCESSING_STAGE_COUNT = 4;
+
+std::ostream&
+operator<<(std::ostream& os, ProcessingStage stage);
+
+/**
+ * @brief The time after which nobody is waiting for the reply to a request any more.
+ *
+ * The deadline is the arrival time of the Interest plus its InterestLifetime. Once it has
+ * passed, the requester has timed out and any further work on the request is wasted.
+ */
+class RequestDeadline
+{
+public:
+  /**
+   * @brief Stamp @p interest as arriving now.
+   */
+  explicit
+  RequestDeadline(const Interest& interest);
+
+  RequestDeadline(const Interest& interest, const time::steady_clock::TimePoint& arrivalTime);
+
+  const time::steady_clock::TimePoint&
+  getArrivalTime() const
+  {
+    return m_arrivalTime;
+  }
+
+  const time::steady_clock::TimePoint&
+  getDeadline() const
+  {
+    return m_deadline;
+  }
+
+  bool
+  hasExpired() const
+  {
+    return time::steady_clock::now() >= m_deadline;
+  }
+
+private:
+  time::steady_clock::TimePoint m_arrivalTime;
+  time::steady_clock::TimePoint m_deadline;
+};
+
+/**
+ * @brief Counts the processing stages skipped because their request had already expired.
+ *
+ * All methods may be called concurrently from any thread.
+ */
+class DeadlineStatistics : noncopyable
+{
+public:
+  DeadlineStatistics();
+
+  void
+  recordSkipped(ProcessingStage stage)
+  {
+    m_skipped[static_cast<size_t>(stage)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  uint64_t
+  getSkippedCount(ProcessingStage stage) const
+  {
+    return m_skipped[static_cast<size_t>(stage)].load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief The number of requests abandoned because of an expired deadline.
+   */
+  uint64_t
+  getExpiredRequestCount() const;
+
+private:
+  std::array<std::atomic<uint64_t>, PROCESSING_STAGE_COUNT> m_skipped;
+};
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_DETAIL_CA_REQUEST_DEADLINE_HPP
@@ -0,0 +1,60 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/ca-request-pipeline.hpp"
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+std::ostream&
+operator<<(std::ostream& os, PipelineStage stage)
+{
+  switch (stage) {
+    case PipelineStage::DECODE:
+      return os << "decode";
+    case PipelineStage::POLICY:
+      return os << "policy";
+    case PipelineStage::SIGNATURE:
+      return os << "signature";
+    case PipelineStage::ECDH:
+      return os << "ecdh";
+    case PipelineStage::STORAGE:
+      return os << "storage";
+  }
+  return os << "unknown";
+}
+
+void
+PipelineStatistics::record(PipelineStage stage, time::nanoseconds duration, bool isRejected)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& entry = m_stages[static_cast<size_t>(stage)];
+  entry.nProcessed++;
+  if (isRejected) {
+    entry.nRejected++;
+  }
+  entry.totalTime += duration;
+  entry.maxTime = std::max(entry.maxTime, duration);
+}
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
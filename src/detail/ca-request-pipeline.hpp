@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_DETAIL_CA_REQUEST_PIPELINE_HPP
+#define NDNCERT_DETAIL_CA_REQUEST_PIPELINE_HPP
+
+#include "detail/ndncert-common.hpp"
+
+#include <mutex>
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+/**
+ * @brief The validation stages of a NEW/REVOKE request, in the order they are run.
+ *
+ * The stages are ordered by cost so that a malformed or unauthorized request is rejected
+ * before the CA spends a signature verification or an EC scalar multiplication on it.
+ */
+enum class PipelineStage : size_t {
+  DECODE = 0,    ///< parse the ECDH public key and the certificate
+  POLICY = 1,    ///< name, suffix length, and validity period checks
+  SIGNATURE = 2, ///< Interest signature, then certificate signature
+  ECDH = 3,      ///< shared secret, request ID, and HKDF
+  STORAGE = 4    ///< store the new request state
+};
+
+const size_t PIPELINE_STAGE_COUNT = 5;
+
+std::ostream&
+operator<<(std::ostream& os, PipelineStage stage);
+
+/**
+ * @brief Per-stage counters and latency of the NEW/REVOKE validation pipeline.
+ *
+ * All methods may be called concurrently from any thread.
+ */
+class PipelineStatistics : noncopyable
+{
+public:
+  struct StageEntry
+  {
+    uint64_t nProcessed = 0;
+    uint64_t nRejected = 0;
+    time::nanoseconds totalTime = time::nanoseconds::zero();
+    time::nanoseconds maxTime = time::nanoseconds::zero();
+  };
+
+  void
+  record(PipelineStage stage, time::nanoseconds duration, bool isRejected);
+
+  StageEntry
+  get(PipelineStage stage) const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stages[static_cast<size_t>(stage)];
+  }
+
+private:
+  mutable std::mutex m_mutex;
+  std::array<StageEntry, PIPELINE_STAGE_COUNT> m_stages;
+};
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_DETAIL_CA_REQUEST_PIPELINE_HPP
@@ -23,6 +23,7 @@
 #include <sqlite3.h>
 #include <boost/filesystem.hpp>
 #include <ndn-cxx/security/validation-policy.hpp>
+#include <ndn-cxx/util/random.hpp>
 #include <ndn-cxx/util/sqlite3-statement.hpp>
 
 namespace ndn {
@@ -72,6 +73,14 @@ CREATE TABLE IF NOT EXISTS
   );
 CREATE UNIQUE INDEX IF NOT EXISTS
   RequestStateIdIndex ON RequestStates(request_id);
+CREATE TABLE IF NOT EXISTS
+  CaSecrets(
+    id INTEGER PRIMARY KEY,
+    ca_name BLOB NOT NULL,
+    request_id_key BLOB NOT NULL
+  );
+CREATE UNIQUE INDEX IF NOT EXISTS
+  CaSecretsCaNameIndex ON CaSecrets(ca_name);
 )_DBTEXT_";
 
 CaSqlite::CaSqlite(const Name& caName, const std::string& path)
@@ -96,9 +105,9 @@ CaSqlite::CaSqlite(const Name& caName, const std::string& path)
     dbDir /= dbName;
   }
 
-  // open and initialize database
+  // open and initialize database; the connection is serialized, as the CA may use it from several threads
   int result = sqlite3_open_v2(dbDir.c_str(), &m_database,
-                               SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+                               SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
 #ifdef NDN_CXX_DISABLE_SQLITE3_FS_LOCKING
                                "unix-dotfile"
 #else
@@ -163,6 +172,7 @@ CaSqlite::getRequest(const RequestId& requestId)
 void
 CaSqlite::addRequest(const RequestState& request)
 {
+  std::lock_guard<std::recursive_mutex> lock(m_writeMutex);
   Sqlite3Statement statement(
       m_database,
       R"_SQLTEXT_(INSERT OR ABORT INTO RequestStates (request_id, ca_name, status, request_type,
@@ -185,14 +195,42 @@ CaSqlite::addRequest(const RequestState& request)
     statement.bind(10, request.challengeState->remainingTries);
     statement.bind(11, request.challengeState->remainingTime.count());
   }
-  if (statement.step() != SQLITE_DONE) {
+  auto result = statement.step();
+  if (result == SQLITE_CONSTRAINT) {
+    NDN_THROW(DuplicateRequestError("Request " + toHex(request.requestId.data(), request.requestId.size()) + " already exists"));
+  }
+  if (result != SQLITE_DONE) {
     NDN_THROW(std::runtime_error("Request " + toHex(request.requestId.data(), request.requestId.size()) + " cannot be added to database"));
   }
 }
 
+std::vector<bool>
+CaSqlite::addRequests(const std::vector<RequestState>& requests)
+{
+  std::lock_guard<std::recursive_mutex> lock(m_writeMutex);
+  if (sqlite3_exec(m_database, "BEGIN TRANSACTION", nullptr, nullptr, nullptr) != SQLITE_OK) {
+    NDN_THROW(std::runtime_error("Cannot begin a transaction in the CaSqlite DB"));
+  }
+  // a failed INSERT OR ABORT only undoes its own statement, the rest of the transaction is kept
+  std::vector<bool> isAdded;
+  try {
+    isAdded = CaStorage::addRequests(requests);
+  }
+  catch (const std::runtime_error&) {
+    sqlite3_exec(m_database, "ROLLBACK", nullptr, nullptr, nullptr);
+    throw;
+  }
+  if (sqlite3_exec(m_database, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+    sqlite3_exec(m_database, "ROLLBACK", nullptr, nullptr, nullptr);
+    NDN_THROW(std::runtime_error("Cannot commit the requests to the CaSqlite DB"));
+  }
+  return isAdded;
+}
+
 void
 CaSqlite::updateRequest(const RequestState& request)
 {
+  std::lock_guard<std::recursive_mutex> lock(m_writeMutex);
   Sqlite3Statement statement(m_database,
                              R"_SQLTEXT_(UPDATE RequestStates
                              SET status = ?, challenge_type = ?, challenge_status = ?, challenge_secrets = ?,
@@ -291,12 +329,38 @@ CaSqlite::listAllRequests(const Name& caName)
 void
 CaSqlite::deleteRequest(const RequestId& requestId)
 {
+  std::lock_guard<std::recursive_mutex> lock(m_writeMutex);
   Sqlite3Statement statement(m_database,
                              R"_SQLTEXT_(DELETE FROM RequestStates WHERE request_id = ?)_SQLTEXT_");
   statement.bind(1, requestId.data(), requestId.size(), SQLITE_TRANSIENT);
   statement.step();
 }
 
+Buffer
+CaSqlite::getRequestIdKey(const Name& caName)
+{
+  std::lock_guard<std::recursive_mutex> lock(m_writeMutex);
+  // another process sharing the database may store its key first, in which case that one is kept
+  Buffer newKey(REQUEST_ID_KEY_SIZE);
+  random::generateSecureBytes(newKey.data(), newKey.size());
+  Sqlite3Statement insertStatement(m_database,
+                                   R"_SQLTEXT_(INSERT OR IGNORE INTO CaSecrets (ca_name, request_id_key)
+                                   values (?, ?))_SQLTEXT_");
+  insertStatement.bind(1, caName.wireEncode(), SQLITE_TRANSIENT);
+  insertStatement.bind(2, newKey.data(), newKey.size(), SQLITE_TRANSIENT);
+  if (insertStatement.step() != SQLITE_DONE) {
+    NDN_THROW(std::runtime_error("Request ID key of " + caName.toUri() + " cannot be added to database"));
+  }
+
+  Sqlite3Statement statement(m_database,
+                             R"_SQLTEXT_(SELECT request_id_key FROM CaSecrets WHERE ca_name = ?)_SQLTEXT_");
+  statement.bind(1, caName.wireEncode(), SQLITE_TRANSIENT);
+  if (statement.step() != SQLITE_ROW || statement.getSize(0) != static_cast<int>(REQUEST_ID_KEY_SIZE)) {
+    NDN_THROW(std::runtime_error("Request ID key of " + caName.toUri() + " cannot be fetched from database"));
+  }
+  return Buffer(statement.getBlob(0), statement.getSize(0));
+}
+
 } // namespace ca
 } // namespace ndncert
 } // namespace ndn
@@ -23,6 +23,8 @@
 
 #include "detail/ca-storage.hpp"
 
+#include <mutex>
+
 struct sqlite3;
 
 namespace ndn {
@@ -52,6 +54,12 @@ public:
   void
   addRequest(const RequestState& request) override;
 
+  /**
+   * @brief Add the requests in one transaction, so that they cost a single commit.
+   */
+  std::vector<bool>
+  addRequests(const std::vector<RequestState>& requests) override;
+
   void
   updateRequest(const RequestState& request) override;
 
@@ -64,8 +72,17 @@ public:
   std::list<RequestState>
   listAllRequests(const Name& caName) override;
 
+  Buffer
+  getRequestIdKey(const Name& caName) override;
+
 private:
   sqlite3* m_database;
+  /**
+   * Taken by every write, as the connection is shared by all threads: a statement of another
+   * thread would otherwise run inside a batch transaction and be undone by its rollback.
+   * Recursive, since a batch adds its requests with addRequest().
+   */
+  std::recursive_mutex m_writeMutex;
 };
 
 } // namespace ca
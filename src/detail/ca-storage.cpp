@@ -20,10 +20,50 @@
 
 #include "detail/ca-storage.hpp"
 
+#include <ndn-cxx/util/random.hpp>
+
+#include <mutex>
+
 namespace ndn {
 namespace ndncert {
 namespace ca {
 
+NDN_LOG_INIT(ndncert.ca.storage);
+
+std::vector<bool>
+CaStorage::addRequests(const std::vector<RequestState>& requests)
+{
+  std::vector<bool> isAdded;
+  isAdded.reserve(requests.size());
+  for (const auto& request : requests) {
+    try {
+      addRequest(request);
+      isAdded.push_back(true);
+    }
+    catch (const DuplicateRequestError&) {
+      isAdded.push_back(false);
+    }
+  }
+  return isAdded;
+}
+
+Buffer
+CaStorage::getRequestIdKey(const Name& caName)
+{
+  static std::mutex mutex;
+  static std::map<Name, Buffer> keys;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto search = keys.find(caName);
+  if (search == keys.end()) {
+    NDN_LOG_WARN("The storage does not keep the request ID key of " << caName <<
+                 ", requests in progress cannot continue after a restart");
+    Buffer key(REQUEST_ID_KEY_SIZE);
+    random::generateSecureBytes(key.data(), key.size());
+    search = keys.emplace(caName, std::move(key)).first;
+  }
+  return search->second;
+}
+
 unique_ptr<CaStorage>
 CaStorage::createCaStorage(const std::string& caStorageType, const Name& caName, const std::string& path)
 {
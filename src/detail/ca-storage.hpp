@@ -27,6 +27,26 @@ namespace ndn {
 namespace ndncert {
 namespace ca {
 
+/**
+ * @brief Size of the secret key from which a CA derives its request IDs.
+ */
+const size_t REQUEST_ID_KEY_SIZE = 32;
+
+/**
+ * @brief Thrown by CaStorage::addRequest when a request with the same request ID exists.
+ */
+class DuplicateRequestError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Storage of the requests in progress at a CA.
+ *
+ * Implementations must be safe to call from several threads, as the worker threads of the CA
+ * use the storage concurrently.
+ */
 class CaStorage : noncopyable
 {
 public: // request related
@@ -37,11 +57,20 @@ public: // request related
   getRequest(const RequestId& requestId) = 0;
 
   /**
-   * @throw if there is an existing request with the same request ID
+   * @throw DuplicateRequestError if there is an existing request with the same request ID
+   * @throw std::runtime_error if the request cannot be stored
    */
   virtual void
   addRequest(const RequestState& request) = 0;
 
+  /**
+   * @brief Add several requests at once, in a single transaction if the storage supports one.
+   * @return whether each request has been added; it is not if a request with its ID exists
+   * @throw std::runtime_error if the requests cannot be stored for any other reason
+   */
+  virtual std::vector<bool>
+  addRequests(const std::vector<RequestState>& requests);
+
   virtual void
   updateRequest(const RequestState& request) = 0;
 
@@ -54,6 +83,19 @@ public: // request related
   virtual std::list<RequestState>
   listAllRequests(const Name& caName) = 0;
 
+public: // CA related
+  /**
+   * @brief Get the secret key from which the CA @p caName derives its request IDs.
+   *
+   * A random key of REQUEST_ID_KEY_SIZE bytes is generated and stored on first use. Keeping the
+   * key lets the requests in progress continue after the CA is restarted or reconfigured.
+   *
+   * The default implementation keeps the key in memory only, so a restarted CA cannot continue
+   * the stored requests; a persistent storage should override it.
+   */
+  virtual Buffer
+  getRequestIdKey(const Name& caName);
+
 public: // factory
   template<class CaStorageType>
   static void
@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/ca-worker-pool.hpp"
+
+#include <boost/functional/hash.hpp>
+
+#include <limits>
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+NDN_LOG_INIT(ndncert.ca.workers);
+
+const size_t WorkerPool::NOT_A_WORKER = std::numeric_limits<size_t>::max();
+
+static thread_local size_t t_currentWorkerIndex = WorkerPool::NOT_A_WORKER;
+
+WorkerPool::WorkerPool(size_t nWorkers)
+  : m_nextWorker(0)
+{
+  if (nWorkers == 0) {
+    NDN_THROW(std::invalid_argument("A worker pool needs at least one worker"));
+  }
+  for (size_t i = 0; i < nWorkers; i++) {
+    auto worker = std::make_unique<Worker>();
+    worker->work = std::make_unique<boost::asio::io_service::work>(worker->io);
+    auto& io = worker->io;
+    worker->thread = std::thread([&io, i] {
+      t_currentWorkerIndex = i;
+      while (true) {
+        try {
+          io.run();
+          break;
+        }
+        catch (const std::exception& e) {
+          // one failed request must not take the worker down with it
+          NDN_LOG_ERROR("Worker " << i << " caught an exception: " << e.what());
+        }
+      }
+    });
+    m_workers.push_back(std::move(worker));
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  join();
+}
+
+void
+WorkerPool::join()
+{
+  for (auto& worker : m_workers) {
+    worker->work.reset();
+  }
+  for (auto& worker : m_workers) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+}
+
+void
+WorkerPool::post(size_t workerIndex, Task task)
+{
+  m_workers.at(workerIndex)->io.post(std::move(task));
+}
+
+size_t
+WorkerPool::getNextWorker()
+{
+  return m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+}
+
+size_t
+WorkerPool::getWorkerForKey(const uint8_t* key, size_t keySize) const
+{
+  return boost::hash_range(key, key + keySize) % m_workers.size();
+}
+
+size_t
+WorkerPool::getCurrentWorkerIndex()
+{
+  return t_currentWorkerIndex;
+}
+
+WorkerKeyChains::WorkerKeyChains(security::KeyChain& keyChain, size_t nWorkers)
+  : m_keyChain(keyChain)
+{
+  auto pibLocator = m_keyChain.getPib().getPibLocator();
+  auto tpmLocator = m_keyChain.getTpm().getTpmLocator();
+  if (pibLocator.find("pib-memory:") == 0 || tpmLocator.find("tpm-memory:") == 0) {
+    return;
+  }
+  try {
+    for (size_t i = 0; i < nWorkers; i++) {
+      m_workerKeyChains.push_back(std::make_unique<security::KeyChain>(pibLocator, tpmLocator));
+    }
+  }
+  catch (const std::exception& e) {
+    NDN_LOG_WARN("Cannot open a KeyChain per worker, the workers will share one: " << e.what());
+    m_workerKeyChains.clear();
+  }
+}
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
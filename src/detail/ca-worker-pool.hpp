@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_DETAIL_CA_WORKER_POOL_HPP
+#define NDNCERT_DETAIL_CA_WORKER_POOL_HPP
+
+#include "detail/ndncert-common.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include <boost/asio/io_service.hpp>
+
+namespace ndn {
+namespace ndncert {
+namespace ca {
+
+/**
+ * @brief A fixed set of worker threads, each running its own event loop.
+ *
+ * Tasks posted to the same worker run one at a time, in the order they are posted. This lets
+ * the CA pin all the requests of one certificate request to one worker, which keeps their
+ * state and AES-GCM IV counters consistent without any per-request locking.
+ */
+class WorkerPool : noncopyable
+{
+public:
+  using Task = std::function<void()>;
+
+  /**
+   * @param nWorkers number of worker threads, at least one
+   */
+  explicit
+  WorkerPool(size_t nWorkers);
+
+  /**
+   * @brief Run the tasks already posted, then join all workers.
+   */
+  ~WorkerPool();
+
+  /**
+   * @brief Run the tasks already posted, then join all workers.
+   *
+   * Tasks posted afterwards are never run.
+   */
+  void
+  join();
+
+  size_t
+  getWorkerCount() const
+  {
+    return m_workers.size();
+  }
+
+  void
+  post(size_t workerIndex, Task task);
+
+  /**
+   * @brief The worker for tasks that can run anywhere, taken in turn.
+   */
+  size_t
+  getNextWorker();
+
+  /**
+   * @brief The worker that owns @p key, the same one for the same key.
+   */
+  size_t
+  getWorkerForKey(const uint8_t* key, size_t keySize) const;
+
+  /**
+   * @return the index of the worker running the calling thread in its pool,
+   *         or NOT_A_WORKER if the thread is not a worker
+   */
+  static size_t
+  getCurrentWorkerIndex();
+
+public:
+  static const size_t NOT_A_WORKER;
+
+private:
+  struct Worker
+  {
+    boost::asio::io_service io;
+    unique_ptr<boost::asio::io_service::work> work;
+    std::thread thread;
+  };
+
+  std::vector<unique_ptr<Worker>> m_workers;
+  std::atomic<size_t> m_nextWorker;
+};
+
+/**
+ * @brief The KeyChains used by the threads of a WorkerPool and the thread of the face.
+ *
+ * KeyChain is not thread-safe. Each worker opens its own KeyChain on the PIB and TPM of the
+ * given one, and any other thread uses the given KeyChain under a mutex. An in-memory KeyChain
+ * cannot be reopened, so in that case all threads share it under the mutex.
+ */
+class WorkerKeyChains : noncopyable
+{
+public:
+  WorkerKeyChains(security::KeyChain& keyChain, size_t nWorkers);
+
+  /**
+   * @brief Run @p func with a KeyChain that may be used from the calling thread.
+   */
+  template<typename Func>
+  auto
+  use(const Func& func) -> decltype(func(std::declval<security::KeyChain&>()))
+  {
+    auto workerIndex = WorkerPool::getCurrentWorkerIndex();
+    if (workerIndex < m_workerKeyChains.size()) {
+      return func(*m_workerKeyChains[workerIndex]);
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return func(m_keyChain);
+  }
+
+private:
+  security::KeyChain& m_keyChain;
+  std::mutex m_mutex;
+  std::vector<unique_ptr<security::KeyChain>> m_workerKeyChains;
+};
+
+} // namespace ca
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_DETAIL_CA_WORKER_POOL_HPP
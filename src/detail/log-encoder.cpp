@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/log-encoder.hpp"
+
+namespace ndn {
+namespace ndncert {
+
+static MerkleHash
+readHash(const Block& block)
+{
+  MerkleHash hash;
+  if (block.value_size() != hash.size()) {
+    NDN_THROW(std::runtime_error("A Merkle tree hash must be " + to_string(hash.size()) + " octets"));
+  }
+  std::copy(block.value_begin(), block.value_end(), hash.begin());
+  return hash;
+}
+
+Block
+logtlv::encodeTreeHead(const TreeHead& head)
+{
+  Block content(ndn::tlv::Content);
+  content.push_back(makeNonNegativeIntegerBlock(tlv::LogTreeSize, head.treeSize));
+  content.push_back(makeBinaryBlock(tlv::LogRootHash, head.rootHash.data(), head.rootHash.size()));
+  content.push_back(makeNonNegativeIntegerBlock(tlv::LogTimestamp,
+                                                time::toUnixTimestamp(head.timestamp).count()));
+  content.encode();
+  return content;
+}
+
+Block
+logtlv::encodeInclusionProof(const InclusionProof& proof, const MerkleHash& rootHash)
+{
+  Block content(ndn::tlv::Content);
+  content.push_back(makeNonNegativeIntegerBlock(tlv::LogLeafIndex, proof.leafIndex));
+  content.push_back(makeNonNegativeIntegerBlock(tlv::LogTreeSize, proof.treeSize));
+  content.push_back(makeBinaryBlock(tlv::LogRootHash, rootHash.data(), rootHash.size()));
+  for (const auto& hash : proof.auditPath) {
+    content.push_back(makeBinaryBlock(tlv::LogAuditPathHash, hash.data(), hash.size()));
+  }
+  content.encode();
+  return content;
+}
+
+logtlv::TreeHead
+logtlv::decodeTreeHead(const Block& content)
+{
+  content.parse();
+  TreeHead head;
+  head.treeSize = readNonNegativeInteger(content.get(tlv::LogTreeSize));
+  head.rootHash = readHash(content.get(tlv::LogRootHash));
+  head.timestamp = time::fromUnixTimestamp(
+    time::milliseconds(readNonNegativeInteger(content.get(tlv::LogTimestamp))));
+  return head;
+}
+
+InclusionProof
+logtlv::decodeInclusionProof(const Block& content, MerkleHash& rootHash)
+{
+  content.parse();
+  InclusionProof proof;
+  proof.leafIndex = readNonNegativeInteger(content.get(tlv::LogLeafIndex));
+  proof.treeSize = readNonNegativeInteger(content.get(tlv::LogTreeSize));
+  rootHash = readHash(content.get(tlv::LogRootHash));
+  for (const auto& element : content.elements()) {
+    if (element.type() == tlv::LogAuditPathHash) {
+      proof.auditPath.push_back(readHash(element));
+    }
+  }
+  return proof;
+}
+
+} // namespace ndncert
+} // namespace ndn
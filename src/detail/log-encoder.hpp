@@ -0,0 +1,67 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_DETAIL_LOG_ENCODER_HPP
+#define NDNCERT_DETAIL_LOG_ENCODER_HPP
+
+#include "detail/merkle-tree.hpp"
+
+namespace ndn {
+namespace ndncert {
+namespace logtlv {
+
+/**
+ * @brief The state of an issuance log at some point, signed by the CA.
+ */
+struct TreeHead
+{
+  uint64_t treeSize = 0;
+  MerkleHash rootHash = {};
+  time::system_clock::TimePoint timestamp;
+};
+
+// For CA use
+Block
+encodeTreeHead(const TreeHead& head);
+
+/**
+ * @param rootHash root hash of the tree of proof.treeSize leaves
+ */
+Block
+encodeInclusionProof(const InclusionProof& proof, const MerkleHash& rootHash);
+
+// For auditors
+/**
+ * @throw std::runtime_error the content is not a valid tree head
+ */
+TreeHead
+decodeTreeHead(const Block& content);
+
+/**
+ * @throw std::runtime_error the content is not a valid inclusion proof
+ */
+InclusionProof
+decodeInclusionProof(const Block& content, MerkleHash& rootHash);
+
+} // namespace logtlv
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_DETAIL_LOG_ENCODER_HPP
@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/merkle-tree.hpp"
+
+#include <openssl/evp.h>
+
+#include <algorithm>
+
+namespace ndn {
+namespace ndncert {
+
+static const uint8_t LEAF_PREFIX = 0x00;
+static const uint8_t NODE_PREFIX = 0x01;
+
+static MerkleHash
+sha256(const uint8_t* prefix, const uint8_t* data1, size_t size1, const uint8_t* data2, size_t size2)
+{
+  MerkleHash result;
+  auto ctx = EVP_MD_CTX_new();
+  if (ctx == nullptr ||
+      EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr) != 1 ||
+      EVP_DigestUpdate(ctx, prefix, 1) != 1 ||
+      EVP_DigestUpdate(ctx, data1, size1) != 1 ||
+      (size2 > 0 && EVP_DigestUpdate(ctx, data2, size2) != 1) ||
+      EVP_DigestFinal_ex(ctx, result.data(), nullptr) != 1) {
+    EVP_MD_CTX_free(ctx);
+    NDN_THROW(std::runtime_error("Cannot compute SHA-256 of a Merkle tree node"));
+  }
+  EVP_MD_CTX_free(ctx);
+  return result;
+}
+
+// the largest power of two smaller than n, for n > 1
+static uint64_t
+getSplitSize(uint64_t n)
+{
+  uint64_t k = 1;
+  while (k << 1 < n) {
+    k <<= 1;
+  }
+  return k;
+}
+
+MerkleHash
+MerkleTree::hashLeaf(const uint8_t* data, size_t size)
+{
+  return sha256(&LEAF_PREFIX, data, size, nullptr, 0);
+}
+
+MerkleHash
+MerkleTree::hashChildren(const MerkleHash& left, const MerkleHash& right)
+{
+  return sha256(&NODE_PREFIX, left.data(), left.size(), right.data(), right.size());
+}
+
+bool
+MerkleTree::verifyInclusion(const MerkleHash& leafHash, const InclusionProof& proof, const MerkleHash& rootHash)
+{
+  if (proof.leafIndex >= proof.treeSize) {
+    return false;
+  }
+  uint64_t fn = proof.leafIndex;
+  uint64_t sn = proof.treeSize - 1;
+  MerkleHash r = leafHash;
+  for (const auto& p : proof.auditPath) {
+    if (sn == 0) {
+      return false;
+    }
+    if ((fn & 1) != 0 || fn == sn) {
+      r = hashChildren(p, r);
+      while ((fn & 1) == 0 && fn != 0) {
+        fn >>= 1;
+        sn >>= 1;
+      }
+    }
+    else {
+      r = hashChildren(r, p);
+    }
+    fn >>= 1;
+    sn >>= 1;
+  }
+  return sn == 0 && r == rootHash;
+}
+
+uint64_t
+MerkleTree::append(const MerkleHash& leafHash)
+{
+  if (m_levels.empty()) {
+    m_levels.emplace_back();
+  }
+  uint64_t index = m_levels.front().size();
+  m_levels.front().push_back(leafHash);
+  // every level that now ends with a full pair gets their parent
+  for (size_t height = 0; m_levels[height].size() % 2 == 0; height++) {
+    if (height + 1 == m_levels.size()) {
+      m_levels.emplace_back();
+    }
+    const auto& level = m_levels[height];
+    auto parent = hashChildren(level[level.size() - 2], level.back());
+    m_levels[height + 1].push_back(parent);
+  }
+  return index;
+}
+
+MerkleHash
+MerkleTree::getRootHash(uint64_t treeSize) const
+{
+  if (treeSize > size()) {
+    NDN_THROW(std::out_of_range("The Merkle tree has fewer than " + to_string(treeSize) + " leaves"));
+  }
+  if (treeSize == 0) {
+    MerkleHash result;
+    auto ctx = EVP_MD_CTX_new();
+    EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr);
+    EVP_DigestFinal_ex(ctx, result.data(), nullptr);
+    EVP_MD_CTX_free(ctx);
+    return result;
+  }
+  return getSubtreeHash(0, treeSize);
+}
+
+InclusionProof
+MerkleTree::getInclusionProof(uint64_t leafIndex, uint64_t treeSize) const
+{
+  if (treeSize > size() || leafIndex >= treeSize) {
+    NDN_THROW(std::out_of_range("Leaf " + to_string(leafIndex) + " is not in a tree of " +
+                                to_string(treeSize) + " leaves"));
+  }
+  InclusionProof proof;
+  proof.leafIndex = leafIndex;
+  proof.treeSize = treeSize;
+  // walk down from the root as in RFC 9162 PATH(m, D[n]), collecting the siblings root side first
+  uint64_t begin = 0;
+  uint64_t end = treeSize;
+  while (end - begin > 1) {
+    uint64_t k = getSplitSize(end - begin);
+    if (leafIndex < begin + k) {
+      proof.auditPath.push_back(getSubtreeHash(begin + k, end));
+      end = begin + k;
+    }
+    else {
+      proof.auditPath.push_back(getSubtreeHash(begin, begin + k));
+      begin += k;
+    }
+  }
+  std::reverse(proof.auditPath.begin(), proof.auditPath.end());
+  return proof;
+}
+
+MerkleHash
+MerkleTree::getSubtreeHash(uint64_t begin, uint64_t end) const
+{
+  // a subtree produced by the RFC 9162 split is complete and aligned, except for the ones
+  // along the right edge of the tree, which are split again
+  uint64_t n = end - begin;
+  if ((n & (n - 1)) == 0) {
+    size_t height = 0;
+    while ((uint64_t(1) << height) < n) {
+      height++;
+    }
+    return m_levels[height][begin >> height];
+  }
+  uint64_t k = getSplitSize(n);
+  return hashChildren(getSubtreeHash(begin, begin + k), getSubtreeHash(begin + k, end));
+}
+
+} // namespace ndncert
+} // namespace ndn
@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_DETAIL_MERKLE_TREE_HPP
+#define NDNCERT_DETAIL_MERKLE_TREE_HPP
+
+#include "detail/ndncert-common.hpp"
+
+namespace ndn {
+namespace ndncert {
+
+using MerkleHash = std::array<uint8_t, 32>;
+
+/**
+ * @brief A proof that a leaf is included in a tree of a given size, see RFC 9162 Section 2.1.3.
+ */
+struct InclusionProof
+{
+  uint64_t leafIndex = 0;
+  uint64_t treeSize = 0;
+  /**
+   * Hashes of the siblings on the path from the leaf to the root, leaf side first
+   */
+  std::vector<MerkleHash> auditPath;
+};
+
+/**
+ * @brief An append-only Merkle tree with the hashing of RFC 9162 (Certificate Transparency).
+ *
+ * The hash of every complete subtree is kept, one level per height, so an append hashes at most
+ * one node per level and the root or an inclusion proof of any past tree size takes O(log n)
+ * lookups and hashes. The tree takes about 64 bytes per leaf.
+ */
+class MerkleTree
+{
+public:
+  /**
+   * @brief Hash of a leaf, SHA-256(0x00 || data).
+   */
+  static MerkleHash
+  hashLeaf(const uint8_t* data, size_t size);
+
+  /**
+   * @brief Hash of an interior node, SHA-256(0x01 || left || right).
+   */
+  static MerkleHash
+  hashChildren(const MerkleHash& left, const MerkleHash& right);
+
+  /**
+   * @brief Verify an inclusion proof against the root hash of the tree of proof.treeSize leaves.
+   */
+  static bool
+  verifyInclusion(const MerkleHash& leafHash, const InclusionProof& proof, const MerkleHash& rootHash);
+
+  /**
+   * @brief Append a leaf by its hash.
+   * @return the index of the leaf
+   */
+  uint64_t
+  append(const MerkleHash& leafHash);
+
+  uint64_t
+  size() const
+  {
+    return m_levels.empty() ? 0 : m_levels.front().size();
+  }
+
+  /**
+   * @brief Root hash of the tree made of the first @p treeSize leaves.
+   * @throw std::out_of_range @p treeSize is larger than the tree
+   */
+  MerkleHash
+  getRootHash(uint64_t treeSize) const;
+
+  MerkleHash
+  getRootHash() const
+  {
+    return getRootHash(size());
+  }
+
+  /**
+   * @brief Prove that leaf @p leafIndex is in the tree made of the first @p treeSize leaves.
+   * @throw std::out_of_range the leaf is not in a tree of that size, or the tree is smaller
+   */
+  InclusionProof
+  getInclusionProof(uint64_t leafIndex, uint64_t treeSize) const;
+
+private:
+  /**
+   * @brief Hash of the subtree of leaves [begin, end), which must not be empty.
+   */
+  MerkleHash
+  getSubtreeHash(uint64_t begin, uint64_t end) const;
+
+private:
+  /**
+   * m_levels[h][i] is the hash of the complete subtree of the 2^h leaves starting at leaf i * 2^h
+   */
+  std::vector<std::vector<MerkleHash>> m_levels;
+};
+
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_DETAIL_MERKLE_TREE_HPP
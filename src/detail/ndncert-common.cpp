@@ -20,6 +20,8 @@
 
 #include "detail/ndncert-common.hpp"
 
+#include <ndn-cxx/encoding/encoding-buffer.hpp>
+
 namespace ndn {
 namespace ndncert {
 
@@ -55,5 +57,20 @@ operator<<(std::ostream& out, RequestType type)
   return out;
 }
 
+Name
+concatenateNames(const Name& prefix, const PartialName& suffix)
+{
+  const auto& prefixWire = prefix.wireEncode();
+  const auto& suffixWire = suffix.wireEncode();
+  size_t valueSize = prefixWire.value_size() + suffixWire.value_size();
+  EncodingBuffer encoder(valueSize + ndn::tlv::sizeOfVarNumber(ndn::tlv::Name) +
+                         ndn::tlv::sizeOfVarNumber(valueSize), 0);
+  encoder.prependByteArray(suffixWire.value(), suffixWire.value_size());
+  encoder.prependByteArray(prefixWire.value(), prefixWire.value_size());
+  encoder.prependVarNumber(valueSize);
+  encoder.prependVarNumber(ndn::tlv::Name);
+  return Name(encoder.block());
+}
+
 } // namespace ndncert
 } // namespace ndn
@@ -88,7 +88,14 @@ enum : uint32_t {
   ErrorInfo = 173,
   AuthenticationTag = 175,
   CertToRevoke = 177,
-  ProbeRedirect = 179
+  ProbeRedirect = 179,
+  BatchEntry = 181,
+  BatchResult = 183,
+  LogTreeSize = 185,
+  LogRootHash = 187,
+  LogTimestamp = 189,
+  LogLeafIndex = 191,
+  LogAuditPathHash = 193
 };
 
 } // namespace tlv
@@ -126,6 +133,11 @@ enum class RequestType : uint64_t {
 std::ostream&
 operator<<(std::ostream& out, RequestType type);
 
+// Build the name of prefix followed by the components of suffix, encoded at once into a buffer
+// of the exact size instead of being appended to and re-encoded component by component
+Name
+concatenateNames(const Name& prefix, const PartialName& suffix);
+
 } // namespace ndncert
 } // namespace ndn
 
@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_DETAIL_PERFECT_HASH_MAP_HPP
+#define NDNCERT_DETAIL_PERFECT_HASH_MAP_HPP
+
+#include "detail/ndncert-common.hpp"
+
+#include <set>
+
+namespace ndn {
+namespace ndncert {
+
+/**
+ * @brief An immutable map from strings to values, looked up with a perfect hash.
+ *
+ * The table size and the hash seed are chosen at construction so that every key lands in its own
+ * slot. A lookup hashes the key once and compares it with the only candidate slot, which is
+ * cheaper than walking a std::map for the short and few keys, e.g., challenge types, used here.
+ */
+template<typename T>
+class PerfectHashMap
+{
+public:
+  PerfectHashMap() = default;
+
+  /**
+   * @param entries the keys and values; of duplicate keys, the first one is kept
+   * @throw std::runtime_error if no collision-free table can be found
+   */
+  explicit
+  PerfectHashMap(std::vector<std::pair<std::string, T>> entries)
+  {
+    std::set<std::string> keys;
+    std::vector<std::pair<std::string, T>> uniqueEntries;
+    for (auto& entry : entries) {
+      if (keys.insert(entry.first).second) {
+        uniqueEntries.push_back(std::move(entry));
+      }
+    }
+    if (uniqueEntries.empty()) {
+      return;
+    }
+
+    size_t tableSize = 1;
+    while (tableSize < uniqueEntries.size()) {
+      tableSize <<= 1;
+    }
+    for (; tableSize <= MAX_TABLE_SIZE; tableSize <<= 1) {
+      for (uint64_t seed = 0; seed < SEEDS_PER_SIZE; seed++) {
+        if (tryBuild(uniqueEntries, tableSize, seed)) {
+          return;
+        }
+      }
+    }
+    NDN_THROW(std::runtime_error("Cannot find a perfect hash for the keys"));
+  }
+
+  /**
+   * @return the value of @p key, or nullptr if the key is not in the map
+   */
+  const T*
+  find(const std::string& key) const
+  {
+    if (m_slots.empty()) {
+      return nullptr;
+    }
+    const auto& slot = m_slots[getSlot(key, m_seed, m_slots.size())];
+    return slot.isUsed && slot.key == key ? &slot.value : nullptr;
+  }
+
+  T*
+  find(const std::string& key)
+  {
+    return const_cast<T*>(const_cast<const PerfectHashMap*>(this)->find(key));
+  }
+
+  size_t
+  size() const
+  {
+    return m_size;
+  }
+
+private:
+  struct Slot
+  {
+    bool isUsed = false;
+    std::string key;
+    T value{};
+  };
+
+  static size_t
+  getSlot(const std::string& key, uint64_t seed, size_t tableSize)
+  {
+    // FNV-1a, with the seed folded into the offset basis
+    uint64_t hash = 14695981039346656037ULL ^ (seed * 0x9e3779b97f4a7c15ULL);
+    for (unsigned char c : key) {
+      hash ^= c;
+      hash *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(hash ^ (hash >> 32)) & (tableSize - 1);
+  }
+
+  bool
+  tryBuild(std::vector<std::pair<std::string, T>>& entries, size_t tableSize, uint64_t seed)
+  {
+    std::vector<bool> isTaken(tableSize, false);
+    for (const auto& entry : entries) {
+      auto index = getSlot(entry.first, seed, tableSize);
+      if (isTaken[index]) {
+        return false;
+      }
+      isTaken[index] = true;
+    }
+
+    m_slots.clear();
+    m_slots.resize(tableSize);
+    for (auto& entry : entries) {
+      auto& slot = m_slots[getSlot(entry.first, seed, tableSize)];
+      slot.isUsed = true;
+      slot.key = entry.first;
+      slot.value = std::move(entry.second);
+    }
+    m_seed = seed;
+    m_size = entries.size();
+    return true;
+  }
+
+private:
+  static constexpr size_t MAX_TABLE_SIZE = 1 << 16;
+  static constexpr uint64_t SEEDS_PER_SIZE = 16;
+
+  std::vector<Slot> m_slots;
+  uint64_t m_seed = 0;
+  size_t m_size = 0;
+};
+
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_DETAIL_PERFECT_HASH_MAP_HPP
@@ -52,6 +52,24 @@ probetlv::decodeApplicationParameters(const Block& block)
 Block
 probetlv::encodeDataContent(const std::vector<Name>& identifiers, optional<size_t> maxSuffixLength,
                                 std::vector<std::shared_ptr<security::Certificate>> redirectionItems)
+{
+  return encodeDataContent(identifiers, maxSuffixLength, encodeRedirectionList(redirectionItems));
+}
+
+std::vector<Block>
+probetlv::encodeRedirectionList(const std::vector<std::shared_ptr<security::Certificate>>& redirectionItems)
+{
+  std::vector<Block> redirectionBlocks;
+  redirectionBlocks.reserve(redirectionItems.size());
+  for (const auto& item : redirectionItems) {
+    redirectionBlocks.push_back(makeNestedBlock(tlv::ProbeRedirect, item->getFullName()));
+  }
+  return redirectionBlocks;
+}
+
+Block
+probetlv::encodeDataContent(const std::vector<Name>& identifiers, optional<size_t> maxSuffixLength,
+                            const std::vector<Block>& redirectionBlocks)
 {
   Block content(ndn::tlv::Content);
   for (const auto& name : identifiers) {
@@ -62,8 +80,8 @@ probetlv::encodeDataContent(const std::vector<Name>& identifiers, optional<size_
     }
     content.push_back(item);
   }
-  for (const auto& item : redirectionItems) {
-    content.push_back(makeNestedBlock(tlv::ProbeRedirect, item->getFullName()));
+  for (const auto& item : redirectionBlocks) {
+    content.push_back(item);
   }
   content.encode();
   return content;
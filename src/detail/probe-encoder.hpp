@@ -42,6 +42,19 @@ encodeDataContent(const std::vector<Name>& identifiers,
                   std::vector<std::shared_ptr<security::Certificate>> redirectionItems =
                           std::vector<std::shared_ptr<security::Certificate>>());
 
+/**
+ * @brief Encode the redirection targets into ProbeRedirect TLVs.
+ *
+ * Computing the full name of a certificate requires a digest, so the CA encodes the list once
+ * per configuration and passes it to the overload of encodeDataContent below.
+ */
+std::vector<Block>
+encodeRedirectionList(const std::vector<std::shared_ptr<security::Certificate>>& redirectionItems);
+
+Block
+encodeDataContent(const std::vector<Name>& identifiers, optional<size_t> maxSuffixLength,
+                  const std::vector<Block>& redirectionBlocks);
+
 std::multimap<std::string, std::string>
 decodeApplicationParameters(const Block& block);
 
@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/profile-cache.hpp"
+#include "detail/info-encoder.hpp"
+
+#include <ndn-cxx/metadata-object.hpp>
+#include <ndn-cxx/security/verification-helpers.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
+namespace ndn {
+namespace ndncert {
+namespace requester {
+
+NDN_LOG_INIT(ndncert.client.profilecache);
+
+// TLV types of the cache file, which is never sent over the network
+static const uint32_t TLV_CACHED_PROFILE = 201;
+static const uint32_t TLV_CONFIRMED_AT = 203;
+
+ProfileCache::ProfileCache(time::milliseconds freshnessPeriod)
+  : m_freshnessPeriod(freshnessPeriod)
+{
+}
+
+const CaProfile&
+ProfileCache::insert(const Data& infoData, const time::system_clock::TimePoint& now)
+{
+  auto profile = infotlv::decodeDataContent(infoData.getContent());
+  if (profile.cert == nullptr || !security::verifySignature(infoData, *profile.cert)) {
+    NDN_THROW(std::runtime_error("Cannot verify the signature of the CA profile " + infoData.getName().toUri()));
+  }
+  return store(infoData, std::move(profile), now);
+}
+
+const ProfileCache::Entry*
+ProfileCache::find(const Name& caPrefix) const
+{
+  auto it = m_entries.find(caPrefix);
+  return it == m_entries.end() ? nullptr : &it->second;
+}
+
+bool
+ProfileCache::isFresh(const Name& caPrefix, const time::system_clock::TimePoint& now) const
+{
+  auto entry = find(caPrefix);
+  return entry != nullptr && now < entry->confirmedAt + m_freshnessPeriod;
+}
+
+bool
+ProfileCache::confirm(const Name& caPrefix, const Data& discoveryReply, const time::system_clock::TimePoint& now)
+{
+  auto it = m_entries.find(caPrefix);
+  if (it == m_entries.end()) {
+    return false;
+  }
+  auto& entry = it->second;
+  if (!security::verifySignature(discoveryReply, *entry.profile.cert)) {
+    NDN_LOG_DEBUG("Discovery reply of " << caPrefix << " is not signed by the cached CA certificate");
+    return false;
+  }
+  try {
+    MetadataObject metadata(discoveryReply);
+    if (metadata.getVersionedName() != entry.infoData.getName().getPrefix(-1)) {
+      NDN_LOG_DEBUG("Profile of " << caPrefix << " changed to " << metadata.getVersionedName());
+      return false;
+    }
+  }
+  catch (const ndn::tlv::Error& e) {
+    NDN_LOG_DEBUG("Cannot decode the discovery reply of " << caPrefix << ": " << e.what());
+    return false;
+  }
+  entry.confirmedAt = now;
+  return true;
+}
+
+void
+ProfileCache::erase(const Name& caPrefix)
+{
+  m_entries.erase(caPrefix);
+}
+
+void
+ProfileCache::load(const std::string& fileName)
+{
+  std::ifstream is(fileName, std::ios::binary);
+  if (!is) {
+    NDN_THROW(std::runtime_error("Cannot open the profile cache " + fileName));
+  }
+  auto buffer = make_shared<Buffer>(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+
+  std::map<Name, Entry> entries;
+  m_entries.swap(entries);
+  try {
+    size_t offset = 0;
+    while (offset < buffer->size()) {
+      bool isOk = false;
+      Block block;
+      std::tie(isOk, block) = Block::fromBuffer(buffer, offset);
+      if (!isOk || block.type() != TLV_CACHED_PROFILE) {
+        NDN_THROW(std::runtime_error("Malformed entry at offset " + std::to_string(offset)));
+      }
+      offset += block.size();
+      block.parse();
+      Data infoData(block.get(ndn::tlv::Data));
+      auto confirmedAt = time::fromUnixTimestamp(time::milliseconds(readNonNegativeInteger(block.get(TLV_CONFIRMED_AT))));
+      store(infoData, infotlv::decodeDataContent(infoData.getContent()), confirmedAt);
+    }
+  }
+  catch (const std::exception& e) {
+    m_entries.swap(entries);
+    NDN_THROW(std::runtime_error("Cannot decode the profile cache " + fileName + ": " + e.what()));
+  }
+}
+
+void
+ProfileCache::save(const std::string& fileName) const
+{
+  // write to a temporary file first, so a crash cannot leave a truncated cache behind
+  auto tmpFileName = fileName + ".tmp";
+  std::ofstream os(tmpFileName, std::ios::binary | std::ios::trunc);
+  for (const auto& item : m_entries) {
+    Block block(TLV_CACHED_PROFILE);
+    block.push_back(item.second.infoData.wireEncode());
+    block.push_back(makeNonNegativeIntegerBlock(TLV_CONFIRMED_AT,
+                                                time::toUnixTimestamp(item.second.confirmedAt).count()));
+    block.encode();
+    os.write(reinterpret_cast<const char*>(block.wire()), block.size());
+  }
+  os.close();
+  if (!os) {
+    NDN_THROW(std::runtime_error("Cannot write the profile cache " + fileName));
+  }
+  boost::filesystem::rename(tmpFileName, fileName);
+}
+
+const CaProfile&
+ProfileCache::store(const Data& infoData, CaProfile&& profile, const time::system_clock::TimePoint& confirmedAt)
+{
+  // /<ca-prefix>/CA/INFO/<version>/<segment>
+  const auto& name = infoData.getName();
+  if (!Name(profile.caPrefix).append("CA").append("INFO").isPrefixOf(name) ||
+      name.size() != profile.caPrefix.size() + 4 || !name.at(-2).isVersion()) {
+    NDN_THROW(std::runtime_error("Not a CA profile packet: " + name.toUri()));
+  }
+
+  Entry entry;
+  entry.version = name.at(-2).toVersion();
+  entry.infoData = infoData;
+  entry.profile = std::move(profile);
+  entry.confirmedAt = confirmedAt;
+  auto& slot = m_entries[entry.profile.caPrefix];
+  slot = std::move(entry);
+  return slot.profile;
+}
+
+} // namespace requester
+} // namespace ndncert
+} // namespace ndn
@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_DETAIL_PROFILE_CACHE_HPP
+#define NDNCERT_DETAIL_PROFILE_CACHE_HPP
+
+#include "detail/ca-profile.hpp"
+
+#include <map>
+
+namespace ndn {
+namespace ndncert {
+namespace requester {
+
+/**
+ * @brief CA profiles fetched by a requester, kept with the signed INFO Data they came from.
+ *
+ * A cached profile is used without any network exchange within the freshness period after it
+ * was fetched or confirmed. After that, a discovery (RDR metadata) reply pointing to the cached
+ * INFO version confirms it again, so only a changed profile has to be fetched and verified.
+ *
+ * The cache is saved in a binary file, a sequence of TLV blocks each holding the INFO Data and
+ * the time it was last confirmed.
+ */
+class ProfileCache
+{
+public:
+  struct Entry
+  {
+    CaProfile profile;
+    /**
+     * @brief The signed INFO Data packet the profile was decoded from.
+     */
+    Data infoData;
+    /**
+     * @brief The version of the INFO Data packet.
+     */
+    uint64_t version = 0;
+    /**
+     * @brief When the profile was last fetched or confirmed.
+     */
+    time::system_clock::TimePoint confirmedAt;
+  };
+
+  explicit
+  ProfileCache(time::milliseconds freshnessPeriod = time::hours(1));
+
+  /**
+   * @brief Cache the profile in @p infoData, the reply to a profile fetching Interest.
+   *
+   * @return the cached profile
+   * @throw std::runtime_error if the Data is not a valid INFO packet or its signature cannot be verified.
+   */
+  const CaProfile&
+  insert(const Data& infoData, const time::system_clock::TimePoint& now = time::system_clock::now());
+
+  /**
+   * @return the cached profile of the CA with @p caPrefix, nullptr if there is none
+   */
+  const Entry*
+  find(const Name& caPrefix) const;
+
+  /**
+   * @return whether the profile of @p caPrefix can be used without a discovery
+   */
+  bool
+  isFresh(const Name& caPrefix, const time::system_clock::TimePoint& now = time::system_clock::now()) const;
+
+  /**
+   * @brief Check the cached profile of @p caPrefix against the reply to a discovery Interest.
+   *
+   * The reply must be signed by the cached CA certificate. When it points to the cached INFO
+   * version, the profile is confirmed to be current until the end of a new freshness period.
+   *
+   * @return whether the cached profile is current; otherwise it has to be fetched again.
+   */
+  bool
+  confirm(const Name& caPrefix, const Data& discoveryReply,
+          const time::system_clock::TimePoint& now = time::system_clock::now());
+
+  void
+  erase(const Name& caPrefix);
+
+  size_t
+  size() const
+  {
+    return m_entries.size();
+  }
+
+  /**
+   * @brief Load the cache from @p fileName, replacing the cached profiles.
+   *
+   * Like the client configuration file, the cache file is trusted: the signatures of the INFO
+   * packets were verified when they were fetched and are not verified again.
+   * @throw std::runtime_error when the file cannot be read or decoded.
+   */
+  void
+  load(const std::string& fileName);
+
+  /**
+   * @throw std::runtime_error when the file cannot be written.
+   */
+  void
+  save(const std::string& fileName) const;
+
+private:
+  const CaProfile&
+  store(const Data& infoData, CaProfile&& profile, const time::system_clock::TimePoint& confirmedAt);
+
+private:
+  time::milliseconds m_freshnessPeriod;
+  std::map<Name, Entry> m_entries;
+};
+
+} // namespace requester
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_DETAIL_PROFILE_CACHE_HPP
@@ -71,13 +71,31 @@ Block
 requesttlv::encodeDataContent(const std::vector <uint8_t>& ecdhKey, const std::array<uint8_t, 32>& salt,
                               const RequestId& requestId,
                               const std::vector <std::string>& challenges)
+{
+  return encodeDataContent(ecdhKey, salt, requestId, encodeChallengeList(challenges));
+}
+
+std::vector<Block>
+requesttlv::encodeChallengeList(const std::vector<std::string>& challenges)
+{
+  std::vector<Block> challengeBlocks;
+  challengeBlocks.reserve(challenges.size());
+  for (const auto& entry : challenges) {
+    challengeBlocks.push_back(makeStringBlock(tlv::Challenge, entry));
+  }
+  return challengeBlocks;
+}
+
+Block
+requesttlv::encodeDataContent(const std::vector<uint8_t>& ecdhKey, const std::array<uint8_t, 32>& salt,
+                              const RequestId& requestId, const std::vector<Block>& challengeBlocks)
 {
   Block response(ndn::tlv::Content);
   response.push_back(makeBinaryBlock(tlv::EcdhPub, ecdhKey.data(), ecdhKey.size()));
   response.push_back(makeBinaryBlock(tlv::Salt, salt.data(), salt.size()));
   response.push_back(makeBinaryBlock(tlv::RequestId, requestId.data(), requestId.size()));
-  for (const auto& entry: challenges) {
-    response.push_back(makeStringBlock(tlv::Challenge, entry));
+  for (const auto& item : challengeBlocks) {
+    response.push_back(item);
   }
   response.encode();
   return response;
@@ -108,5 +126,114 @@ requesttlv::decodeDataContent(const Block& content, std::vector <uint8_t>& ecdhK
   return challenges;
 }
 
+Block
+requesttlv::encodeBatchEntry(const std::vector<uint8_t>& ecdhPub, const security::Certificate& certRequest)
+{
+  Block entry(tlv::BatchEntry);
+  entry.push_back(makeBinaryBlock(tlv::EcdhPub, ecdhPub.data(), ecdhPub.size()));
+  entry.push_back(makeNestedBlock(tlv::CertRequest, certRequest));
+  entry.encode();
+  return entry;
+}
+
+Block
+requesttlv::encodeBatchApplicationParameters(const std::vector<Block>& entries)
+{
+  Block request(ndn::tlv::ApplicationParameters);
+  for (const auto& entry : entries) {
+    request.push_back(entry);
+  }
+  request.encode();
+  return request;
+}
+
+size_t
+requesttlv::countBatchEntries(const Block& block)
+{
+  block.parse();
+  return std::count_if(block.elements_begin(), block.elements_end(),
+                       [] (const Block& element) { return element.type() == tlv::BatchEntry; });
+}
+
+void
+requesttlv::decodeBatchApplicationParameters(const Block& block, std::vector<std::vector<uint8_t>>& ecdhPubs,
+                                             std::vector<shared_ptr<security::Certificate>>& certRequests)
+{
+  block.parse();
+  ecdhPubs.clear();
+  certRequests.clear();
+  for (const auto& element : block.elements()) {
+    if (element.type() != tlv::BatchEntry) {
+      continue;
+    }
+    // an entry carries the same fields as the parameters of a NEW request
+    std::vector<uint8_t> ecdhPub;
+    shared_ptr<security::Certificate> certRequest;
+    decodeApplicationParameters(element, RequestType::NEW, ecdhPub, certRequest);
+    ecdhPubs.push_back(std::move(ecdhPub));
+    certRequests.push_back(std::move(certRequest));
+  }
+}
+
+Block
+requesttlv::encodeBatchDataContent(const std::vector<BatchResult>& results, const std::vector<Block>& challengeBlocks)
+{
+  Block response(ndn::tlv::Content);
+  for (const auto& result : results) {
+    Block resultBlock(tlv::BatchResult);
+    resultBlock.push_back(makeNonNegativeIntegerBlock(tlv::ErrorCode, static_cast<uint64_t>(result.error)));
+    if (result.error != ErrorCode::NO_ERROR) {
+      resultBlock.push_back(makeStringBlock(tlv::ErrorInfo, result.errorInfo));
+    }
+    else {
+      resultBlock.push_back(makeBinaryBlock(tlv::EcdhPub, result.ecdhKey.data(), result.ecdhKey.size()));
+      resultBlock.push_back(makeBinaryBlock(tlv::Salt, result.salt.data(), result.salt.size()));
+      resultBlock.push_back(makeBinaryBlock(tlv::RequestId, result.requestId.data(), result.requestId.size()));
+    }
+    resultBlock.encode();
+    response.push_back(resultBlock);
+  }
+  for (const auto& item : challengeBlocks) {
+    response.push_back(item);
+  }
+  response.encode();
+  return response;
+}
+
+std::list<std::string>
+requesttlv::decodeBatchDataContent(const Block& content, std::vector<BatchResult>& results)
+{
+  content.parse();
+  results.clear();
+  std::list<std::string> challenges;
+  for (const auto& element : content.elements()) {
+    if (element.type() == tlv::Challenge) {
+      challenges.push_back(readString(element));
+    }
+    if (element.type() != tlv::BatchResult) {
+      continue;
+    }
+    element.parse();
+    BatchResult result;
+    result.error = static_cast<ErrorCode>(readNonNegativeInteger(element.get(tlv::ErrorCode)));
+    if (result.error != ErrorCode::NO_ERROR) {
+      result.errorInfo = readString(element.get(tlv::ErrorInfo));
+    }
+    else {
+      const auto& ecdhBlock = element.get(tlv::EcdhPub);
+      result.ecdhKey.assign(ecdhBlock.value(), ecdhBlock.value() + ecdhBlock.value_size());
+      const auto& saltBlock = element.get(tlv::Salt);
+      const auto& requestIdBlock = element.get(tlv::RequestId);
+      if (saltBlock.value_size() != result.salt.size() || requestIdBlock.value_size() != result.requestId.size()) {
+        NDN_THROW(std::runtime_error("Invalid salt or request ID in the BATCH-NEW response"));
+      }
+      std::memcpy(result.salt.data(), saltBlock.value(), saltBlock.value_size());
+      std::memcpy(result.requestId.data(), requestIdBlock.value(), requestIdBlock.value_size());
+    }
+    results.push_back(std::move(result));
+  }
+  return challenges;
+}
+
 } // namespace ndncert
 } // namespace ndn
\ No newline at end of file
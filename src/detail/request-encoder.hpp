@@ -39,12 +39,73 @@ Block
 encodeDataContent(const std::vector<uint8_t>& ecdhKey, const std::array<uint8_t, 32>& salt,
                   const RequestId& requestId, const std::vector<std::string>& challenges);
 
+/**
+ * @brief Encode the supported challenges into Challenge TLVs.
+ *
+ * The result only depends on the CA configuration, so the CA encodes it once and passes it to
+ * the overload of encodeDataContent below for every NEW/REVOKE response.
+ */
+std::vector<Block>
+encodeChallengeList(const std::vector<std::string>& challenges);
+
+Block
+encodeDataContent(const std::vector<uint8_t>& ecdhKey, const std::array<uint8_t, 32>& salt,
+                  const RequestId& requestId, const std::vector<Block>& challengeBlocks);
+
 std::list<std::string>
 decodeDataContent(const Block& content, std::vector<uint8_t>& ecdhKey,
                   std::array<uint8_t, 32>& salt, RequestId& requestId);
 
+/**
+ * @brief The outcome of one entry of a BATCH-NEW request.
+ *
+ * Only the error code and its information are set if the entry is rejected.
+ */
+struct BatchResult
+{
+  ErrorCode error = ErrorCode::NO_ERROR;
+  std::string errorInfo;
+  std::vector<uint8_t> ecdhKey;
+  std::array<uint8_t, 32> salt = {};
+  RequestId requestId = {};
+};
+
+/**
+ * @brief Encode one NEW request as an entry of a BATCH-NEW request.
+ */
+Block
+encodeBatchEntry(const std::vector<uint8_t>& ecdhPub, const security::Certificate& certRequest);
+
+Block
+encodeBatchApplicationParameters(const std::vector<Block>& entries);
+
+/**
+ * @brief Count the entries of a BATCH-NEW request without decoding them.
+ * @throw std::exception if the parameters are not well-formed TLV
+ */
+size_t
+countBatchEntries(const Block& block);
+
+/**
+ * @brief Decode the entries of a BATCH-NEW request, in order.
+ * @throw std::exception if any entry cannot be decoded
+ */
+void
+decodeBatchApplicationParameters(const Block& block, std::vector<std::vector<uint8_t>>& ecdhPubs,
+                                 std::vector<shared_ptr<security::Certificate>>& certRequests);
+
+Block
+encodeBatchDataContent(const std::vector<BatchResult>& results, const std::vector<Block>& challengeBlocks);
+
+/**
+ * @brief Decode the results of a BATCH-NEW request, in the order of its entries.
+ * @return the challenges offered for the accepted entries
+ */
+std::list<std::string>
+decodeBatchDataContent(const Block& content, std::vector<BatchResult>& results);
+
 } // namespace requesttlv
 } // namespace ndncert
 } // namespace ndn
 
-#endif // NDNCERT_DETAIL_NEW_RENEW_REVOKE_ENCODER_HPP
\ No newline at end of file
+#endif // NDNCERT_DETAIL_REQUEST_ENCODER_HPP
\ No newline at end of file
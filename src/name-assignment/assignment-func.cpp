@@ -21,6 +21,8 @@
 #include "assignment-func.hpp"
 #include <ndn-cxx/util/random.hpp>
 
+#include <algorithm>
+
 namespace ndn {
 namespace ndncert {
 
@@ -37,6 +39,31 @@ NameAssignmentFunc::NameAssignmentFunc(const std::string& format)
   if (startIndex != format.size()) {
     m_nameFormat.push_back(format.substr(startIndex));
   }
+
+  for (const auto& component : m_nameFormat) {
+    auto it = std::find(m_formatKeys.begin(), m_formatKeys.end(), component);
+    m_formatPlan.push_back(it - m_formatKeys.begin());
+    if (it == m_formatKeys.end()) {
+      m_formatKeys.push_back(component);
+    }
+  }
+}
+
+bool
+NameAssignmentFunc::resolveFormat(const std::multimap<std::string, std::string>& params,
+                                  std::vector<const std::string*>& values) const
+{
+  values.clear();
+  values.reserve(m_formatKeys.size());
+  for (const auto& key : m_formatKeys) {
+    // the first parameter with the key, as a multimap keeps equal keys in insertion order
+    auto it = params.lower_bound(key);
+    if (it == params.end() || it->first != key) {
+      return false;
+    }
+    values.push_back(&it->second);
+  }
+  return true;
 }
 
 unique_ptr<NameAssignmentFunc>
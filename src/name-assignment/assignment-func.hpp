@@ -48,6 +48,18 @@ public:
   virtual std::vector<PartialName>
   assignName(const std::multimap<std::string, std::string>& params) = 0;
 
+  /**
+   * @brief Whether the function always assigns the same names to the same parameters.
+   *
+   * The CA only caches PROBE replies if all its functions are deterministic, as a cached reply
+   * would otherwise offer the same random name to every requester sending the same parameters.
+   */
+  virtual bool
+  isDeterministic() const
+  {
+    return true;
+  }
+
 public:
   template <class AssignmentType>
   static void
@@ -61,8 +73,25 @@ public:
   static unique_ptr<NameAssignmentFunc>
   createNameAssignmentFunc(const std::string& challengeType, const std::string& format = "");
 
+protected:
+  /**
+   * @brief Look up the parameter of each distinct key in the format, once per key.
+   *
+   * @param values receives the values in the order of m_formatKeys
+   * @return false if a parameter of the format is missing
+   */
+  bool
+  resolveFormat(const std::multimap<std::string, std::string>& params,
+                std::vector<const std::string*>& values) const;
+
 NDNCERT_PUBLIC_WITH_TESTS_ELSE_PROTECTED:
   std::vector<std::string> m_nameFormat;
+  /**
+   * The distinct parameter keys in m_nameFormat, and for each format component the index of its key,
+   * both compiled when the function is created from the configuration.
+   */
+  std::vector<std::string> m_formatKeys;
+  std::vector<size_t> m_formatPlan;
 
 private:
   typedef function<unique_ptr<NameAssignmentFunc>(const std::string&)> FactoryCreateFunc;
@@ -20,6 +20,7 @@
 
 #include "assignment-hash.hpp"
 #include <ndn-cxx/util/sha256.hpp>
+#include <ndn-cxx/util/string-helper.hpp>
 
 namespace ndn {
 namespace ndncert {
@@ -34,17 +35,20 @@ std::vector<PartialName>
 AssignmentHash::assignName(const std::multimap<std::string, std::string>& params)
 {
   std::vector<PartialName> resultList;
+  std::vector<const std::string*> values;
+  if (!resolveFormat(params, values)) {
+    return resultList;
+  }
+  // a parameter used by several components is hashed only once
+  std::vector<std::string> digests;
+  digests.reserve(values.size());
+  for (const auto* value : values) {
+    auto digest = util::Sha256::computeDigest(reinterpret_cast<const uint8_t*>(value->data()), value->size());
+    digests.push_back(toHex(*digest));
+  }
   Name result;
-  for (const auto& item : m_nameFormat) {
-    auto it = params.find(item);
-    if (it != params.end()) {
-      util::Sha256 digest;
-      digest << it->second;
-      result.append(digest.toString());
-    }
-    else {
-      return resultList;
-    }
+  for (auto index : m_formatPlan) {
+    result.append(digests[index]);
   }
   resultList.push_back(std::move(result));
   return resultList;
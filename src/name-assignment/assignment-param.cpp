@@ -20,6 +20,8 @@
 
 #include "assignment-param.hpp"
 
+#include <algorithm>
+
 namespace ndn {
 namespace ndncert {
 
@@ -33,16 +35,14 @@ std::vector<PartialName>
 AssignmentParam::assignName(const std::multimap<std::string, std::string>& params)
 {
   std::vector<PartialName> resultList;
+  std::vector<const std::string*> values;
+  if (!resolveFormat(params, values) ||
+      std::any_of(values.begin(), values.end(), [] (const std::string* value) { return value->empty(); })) {
+    return resultList;
+  }
   Name result;
-  for (const auto& item : m_nameFormat) {
-    auto it = std::find_if(params.begin(), params.end(),
-                           [&](const std::tuple<std::string, std::string>& e) { return std::get<0>(e) == item; });
-    if (it != params.end() && !it->second.empty()) {
-      result.append(it->second);
-    }
-    else {
-      return resultList;
-    }
+  for (auto index : m_formatPlan) {
+    result.append(*values[index]);
   }
   resultList.push_back(std::move(result));
   return resultList;
@@ -36,6 +36,12 @@ public:
 
   std::vector<PartialName>
   assignName(const std::multimap<std::string, std::string>& params) override;
+
+  bool
+  isDeterministic() const override
+  {
+    return false;
+  }
 };
 
 } // namespace ndncert
@@ -0,0 +1,274 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "requester-ca-selector.hpp"
+
+#include <ndn-cxx/security/certificate.hpp>
+
+#include <boost/lexical_cast.hpp>
+
+namespace ndn {
+namespace ndncert {
+namespace requester {
+
+NDN_LOG_INIT(ndncert.client.selector);
+
+struct CaSelector::Run
+{
+  std::multimap<std::string, std::string> parameters;
+  CompletionCallback onComplete;
+  std::vector<ProbeResult> results;
+  std::set<Name> seenCaPrefixes;
+  /**
+   * Probes and redirections in progress
+   */
+  size_t nPending = 0;
+  std::vector<ScopedPendingInterestHandle> pendingInterests;
+};
+
+std::ostream&
+operator<<(std::ostream& os, ProbeResult::Outcome outcome)
+{
+  switch (outcome) {
+    case ProbeResult::Outcome::OK:
+      return os << "OK";
+    case ProbeResult::Outcome::ERROR:
+      return os << "ERROR";
+    case ProbeResult::Outcome::NACK:
+      return os << "NACK";
+    case ProbeResult::Outcome::TIMEOUT:
+      return os << "TIMEOUT";
+  }
+  return os << "UNKNOWN";
+}
+
+static int
+getRank(const ProbeResult& result)
+{
+  if (result.hasNames()) {
+    return 0;
+  }
+  switch (result.outcome) {
+    case ProbeResult::Outcome::OK:
+      return 1;
+    case ProbeResult::Outcome::ERROR:
+    case ProbeResult::Outcome::NACK:
+      return 2;
+    case ProbeResult::Outcome::TIMEOUT:
+      break;
+  }
+  return 3;
+}
+
+CaSelector::CaSelector(Face& face, const CaSelectorOptions& options)
+  : m_face(face)
+  , m_options(options)
+{
+}
+
+void
+CaSelector::probe(const std::list<CaProfile>& profiles, const std::multimap<std::string, std::string>& parameters,
+                  const CompletionCallback& onComplete)
+{
+  auto run = make_shared<Run>();
+  run->parameters = parameters;
+  run->onComplete = onComplete;
+  m_runs.insert(run);
+
+  // counts as pending until every known CA has been probed, so a quick failure cannot complete the run
+  run->nPending++;
+  for (const auto& profile : profiles) {
+    if (run->seenCaPrefixes.insert(profile.caPrefix).second) {
+      sendProbe(run, profile, 0);
+    }
+  }
+  addResult(run, ProbeResult());
+}
+
+void
+CaSelector::rank(std::vector<ProbeResult>& results)
+{
+  std::stable_sort(results.begin(), results.end(), [] (const ProbeResult& a, const ProbeResult& b) {
+    auto rankA = getRank(a);
+    auto rankB = getRank(b);
+    return rankA != rankB ? rankA < rankB : a.rtt < b.rtt;
+  });
+}
+
+void
+CaSelector::sendProbe(const shared_ptr<Run>& run, const CaProfile& profile, size_t redirectDepth)
+{
+  run->nPending++;
+  ProbeResult result;
+  result.profile = profile;
+  result.redirectDepth = redirectDepth;
+
+  std::multimap<std::string, std::string> parameters;
+  for (const auto& key : profile.probeParameterKeys) {
+    auto range = run->parameters.equal_range(key);
+    if (range.first == range.second) {
+      result.outcome = ProbeResult::Outcome::ERROR;
+      result.error = "No value for probe parameter " + key;
+      addResult(run, std::move(result));
+      return;
+    }
+    parameters.insert(range.first, range.second);
+  }
+
+  auto interest = Request::genProbeInterest(profile, std::move(parameters));
+  auto sendTime = time::steady_clock::now();
+  auto sharedResult = make_shared<ProbeResult>(std::move(result));
+  weak_ptr<Run> weakRun(run);
+  expressInterest(run, *interest,
+    [this, weakRun, sharedResult, sendTime] (const Interest&, const Data& reply) {
+      auto run = weakRun.lock();
+      if (run == nullptr) {
+        return;
+      }
+      auto& result = *sharedResult;
+      result.rtt = time::steady_clock::now() - sendTime;
+      try {
+        Request::onProbeResponse(reply, result.profile, result.availableNames, result.redirects);
+        result.outcome = ProbeResult::Outcome::OK;
+      }
+      catch (const std::exception& e) {
+        result.outcome = ProbeResult::Outcome::ERROR;
+        result.error = e.what();
+      }
+      if (result.redirectDepth < m_options.maxRedirectDepth) {
+        for (const auto& redirect : result.redirects) {
+          followRedirect(run, redirect, result.redirectDepth + 1);
+        }
+      }
+      addResult(run, std::move(result));
+    },
+    [this, weakRun, sharedResult, sendTime] (ProbeResult::Outcome outcome, const std::string& error) {
+      if (auto run = weakRun.lock()) {
+        sharedResult->outcome = outcome;
+        sharedResult->error = error;
+        sharedResult->rtt = time::steady_clock::now() - sendTime;
+        addResult(run, std::move(*sharedResult));
+      }
+    });
+}
+
+void
+CaSelector::followRedirect(const shared_ptr<Run>& run, const Name& caCertFullName, size_t redirectDepth)
+{
+  Name caPrefix;
+  try {
+    caPrefix = security::extractIdentityFromCertName(caCertFullName.getPrefix(-1));
+  }
+  catch (const std::exception& e) {
+    NDN_LOG_DEBUG("Ignoring malformed redirection " << caCertFullName);
+    return;
+  }
+  if (!run->seenCaPrefixes.insert(caPrefix).second) {
+    return;
+  }
+  run->nPending++;
+  NDN_LOG_TRACE("Following redirection to " << caPrefix);
+
+  // the profile is checked against the certificate offered in the redirection
+  weak_ptr<Run> weakRun(run);
+  auto onFailure = [this, weakRun, caPrefix, redirectDepth] (ProbeResult::Outcome outcome, const std::string& error) {
+    if (auto run = weakRun.lock()) {
+      ProbeResult result;
+      result.profile.caPrefix = caPrefix;
+      result.redirectDepth = redirectDepth;
+      result.outcome = outcome;
+      result.error = error;
+      addResult(run, std::move(result));
+    }
+  };
+  auto discoveryInterest = Request::genCaProfileDiscoveryInterest(caPrefix);
+  expressInterest(run, *discoveryInterest,
+    [this, weakRun, caCertFullName, redirectDepth, onFailure] (const Interest&, const Data& metadata) {
+      auto run = weakRun.lock();
+      if (run == nullptr) {
+        return;
+      }
+      shared_ptr<Interest> profileInterest;
+      try {
+        profileInterest = Request::genCaProfileInterestFromDiscoveryResponse(metadata);
+      }
+      catch (const std::exception& e) {
+        onFailure(ProbeResult::Outcome::ERROR, e.what());
+        return;
+      }
+      expressInterest(run, *profileInterest,
+        [this, weakRun, caCertFullName, redirectDepth, onFailure] (const Interest&, const Data& reply) {
+          auto run = weakRun.lock();
+          if (run == nullptr) {
+            return;
+          }
+          optional<CaProfile> profile;
+          try {
+            profile = Request::onCaProfileResponseAfterRedirection(reply, caCertFullName);
+          }
+          catch (const std::exception& e) {
+            onFailure(ProbeResult::Outcome::ERROR, e.what());
+            return;
+          }
+          sendProbe(run, *profile, redirectDepth);
+          // the redirection itself is done, its result is the one of the probe
+          addResult(run, ProbeResult());
+        },
+        onFailure);
+    },
+    onFailure);
+}
+
+void
+CaSelector::addResult(const shared_ptr<Run>& run, ProbeResult&& result)
+{
+  // a default-constructed result only marks the end of an operation without its own result
+  if (!result.profile.caPrefix.empty()) {
+    NDN_LOG_DEBUG("Probed " << result.profile.caPrefix << ": " << result.outcome << " in "
+                  << time::duration_cast<time::milliseconds>(result.rtt));
+    run->results.push_back(std::move(result));
+  }
+  if (--run->nPending > 0) {
+    return;
+  }
+  m_runs.erase(run);
+  rank(run->results);
+  if (run->onComplete) {
+    run->onComplete(std::move(run->results));
+  }
+}
+
+void
+CaSelector::expressInterest(const shared_ptr<Run>& run, Interest& interest, const DataCallback& onData,
+                            const function<void(ProbeResult::Outcome, const std::string&)>& onFailure)
+{
+  interest.setInterestLifetime(m_options.interestLifetime);
+  run->pendingInterests.emplace_back(m_face.expressInterest(interest, onData,
+    [onFailure] (const Interest&, const lp::Nack& nack) {
+      onFailure(ProbeResult::Outcome::NACK, "Nack " + boost::lexical_cast<std::string>(nack.getReason()));
+    },
+    [onFailure] (const Interest&) {
+      onFailure(ProbeResult::Outcome::TIMEOUT, "Timeout");
+    }));
+}
+
+} // namespace requester
+} // namespace ndncert
+} // namespace ndn
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_REQUESTER_CA_SELECTOR_HPP
+#define NDNCERT_REQUESTER_CA_SELECTOR_HPP
+
+#include "requester-request.hpp"
+
+#include <set>
+
+namespace ndn {
+namespace ndncert {
+namespace requester {
+
+struct ProbeResult
+{
+  enum class Outcome {
+    OK,      ///< the CA replied to the PROBE
+    ERROR,   ///< the CA replied with an error, or the reply cannot be used
+    NACK,    ///< the Interest was Nacked
+    TIMEOUT  ///< no reply before the Interest lifetime ran out
+  };
+
+  /**
+   * @brief The profile of the CA; only the CA prefix is known if its profile could not be fetched.
+   */
+  CaProfile profile;
+  Outcome outcome = Outcome::TIMEOUT;
+  std::string error;
+  /**
+   * @brief The names suggested by the CA, with their maximum suffix lengths.
+   */
+  std::vector<std::pair<Name, int>> availableNames;
+  /**
+   * @brief The certificate names of the CAs the CA redirects to.
+   */
+  std::vector<Name> redirects;
+  /**
+   * @brief The round-trip time of the PROBE.
+   */
+  time::nanoseconds rtt = time::nanoseconds::zero();
+  /**
+   * @brief How many redirections led to this CA, zero for a known CA.
+   */
+  size_t redirectDepth = 0;
+
+  /**
+   * @brief Whether the CA suggested at least one name.
+   */
+  bool
+  hasNames() const
+  {
+    return outcome == Outcome::OK && !availableNames.empty();
+  }
+};
+
+std::ostream&
+operator<<(std::ostream& os, ProbeResult::Outcome outcome);
+
+struct CaSelectorOptions
+{
+  time::milliseconds interestLifetime = time::seconds(2);
+  /**
+   * @brief How many redirections are followed from a known CA.
+   */
+  size_t maxRedirectDepth = 2;
+};
+
+/**
+ * @brief Probes many CAs in parallel and ranks them by their answers and round-trip times.
+ *
+ * A PROBE is sent to every known CA at once. The CAs they redirect to are discovered, their
+ * profiles fetched and checked against the redirection, and probed in turn, all in parallel.
+ * Every CA is probed at most once.
+ *
+ * The results are ranked with the CAs that suggested names first, then those that replied
+ * without names, then those that Nacked or replied with an error, and the unresponsive ones
+ * last. Within a rank, faster CAs come first.
+ */
+class CaSelector : noncopyable
+{
+public:
+  using CompletionCallback = function<void(std::vector<ProbeResult>&& rankedResults)>;
+
+  explicit
+  CaSelector(Face& face, const CaSelectorOptions& options = CaSelectorOptions());
+
+  /**
+   * @brief Probe @p profiles and the CAs they redirect to.
+   *
+   * @param parameters values of the probe parameters; each CA is sent those it asks for
+   * @param onComplete invoked with the ranked results once every CA has replied or timed out
+   */
+  void
+  probe(const std::list<CaProfile>& profiles, const std::multimap<std::string, std::string>& parameters,
+        const CompletionCallback& onComplete);
+
+  /**
+   * @brief Sort @p results from the most to the least preferable CA.
+   */
+  static void
+  rank(std::vector<ProbeResult>& results);
+
+private:
+  struct Run;
+
+  void
+  sendProbe(const shared_ptr<Run>& run, const CaProfile& profile, size_t redirectDepth);
+
+  void
+  followRedirect(const shared_ptr<Run>& run, const Name& caCertFullName, size_t redirectDepth);
+
+  void
+  addResult(const shared_ptr<Run>& run, ProbeResult&& result);
+
+  void
+  expressInterest(const shared_ptr<Run>& run, Interest& interest, const DataCallback& onData,
+                  const function<void(ProbeResult::Outcome, const std::string&)>& onFailure);
+
+private:
+  Face& m_face;
+  CaSelectorOptions m_options;
+  std::set<shared_ptr<Run>> m_runs;
+};
+
+} // namespace requester
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_REQUESTER_CA_SELECTOR_HPP
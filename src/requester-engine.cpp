@@ -0,0 +1,331 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "requester-engine.hpp"
+
+#include <algorithm>
+
+#include <boost/lexical_cast.hpp>
+
+namespace ndn {
+namespace ndncert {
+namespace requester {
+
+NDN_LOG_INIT(ndncert.client.engine);
+
+struct EnrollmentEngine::Session
+{
+  EnrollmentTask task;
+  unique_ptr<Request> request;
+  /**
+   * Retransmissions of the current Interest so far
+   */
+  size_t nRetries = 0;
+  ScopedPendingInterestHandle pendingInterest;
+  scheduler::ScopedEventId retransmission;
+};
+
+double
+EnrollmentSummary::getThroughput() const
+{
+  auto seconds = duration.count() / 1e9;
+  return seconds > 0 ? (nSucceeded + nFailed) / seconds : 0.0;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const EnrollmentSummary& summary)
+{
+  os << "Succeeded: " << summary.nSucceeded << "\n"
+     << "Failed: " << summary.nFailed << "\n"
+     << "Retransmissions: " << summary.nRetransmissions << "\n"
+     << "Duration: " << time::duration_cast<time::milliseconds>(summary.duration) << "\n"
+     << "Throughput: " << summary.getThroughput() << " requests/s\n";
+  for (const auto& failure : summary.failures) {
+    os << "  " << failure.first << ": " << failure.second << "\n";
+  }
+  return os;
+}
+
+EnrollmentEngine::EnrollmentEngine(Face& face, security::KeyChain& keyChain, const CaProfile& profile,
+                                   const EnrollmentOptions& options)
+  : m_face(face)
+  , m_keyChain(keyChain)
+  , m_profile(profile)
+  , m_options(options)
+  , m_scheduler(face.getIoService())
+{
+  if (m_options.maxInFlight == 0) {
+    m_options.maxInFlight = 1;
+  }
+  if (m_options.validityPeriod <= time::seconds::zero()) {
+    m_options.validityPeriod = m_profile.maxValidityPeriod;
+  }
+}
+
+// the sessions cancel their pending Interests and retransmissions when destroyed
+EnrollmentEngine::~EnrollmentEngine() = default;
+
+void
+EnrollmentEngine::enroll(std::vector<EnrollmentTask> tasks, const CompletionCallback& onComplete)
+{
+  if (m_sessions.empty() && m_queue.empty()) {
+    m_summary = EnrollmentSummary();
+    m_startTime = time::steady_clock::now();
+  }
+  if (onComplete) {
+    m_onComplete = onComplete;
+  }
+  std::move(tasks.begin(), tasks.end(), std::back_inserter(m_queue));
+  startSessions();
+}
+
+void
+EnrollmentEngine::startSessions()
+{
+  while (m_sessions.size() < m_options.maxInFlight && !m_queue.empty()) {
+    auto session = make_shared<Session>();
+    session->task = std::move(m_queue.front());
+    m_queue.pop_front();
+    session->request = std::make_unique<Request>(m_keyChain, m_profile, RequestType::NEW);
+    session->request->setKeyPairPool(m_options.keyPool);
+    m_sessions.insert(session);
+    sendNew(session);
+  }
+}
+
+void
+EnrollmentEngine::sendNew(const shared_ptr<Session>& session)
+{
+  if (!m_profile.caPrefix.isPrefixOf(session->task.identityName)) {
+    finishSession(session, nullptr, "The identity is not under the CA prefix");
+    return;
+  }
+  // a retransmitted NEW is a new request, as the CA may have stored the lost one
+  auto makeInterest = [this, session = session.get()] {
+    auto notBefore = time::system_clock::now();
+    auto interest = session->request->genNewInterest(session->task.identityName, notBefore,
+                                                     notBefore + m_options.validityPeriod);
+    interest->setInterestLifetime(m_options.interestLifetime);
+    return interest;
+  };
+  express(session, makeInterest, [this, weakSession = weak_ptr<Session>(session)] (const Data& reply) {
+    auto session = weakSession.lock();
+    if (session == nullptr) {
+      return;
+    }
+    std::list<std::string> challenges;
+    try {
+      challenges = session->request->onNewRenewRevokeResponse(reply);
+    }
+    catch (const std::exception& e) {
+      finishSession(session, nullptr, e.what());
+      return;
+    }
+    if (std::find(challenges.begin(), challenges.end(), session->task.challengeType) == challenges.end()) {
+      finishSession(session, nullptr, "The CA does not offer challenge " + session->task.challengeType);
+      return;
+    }
+    if (m_onProgress) {
+      m_onProgress(*session->request);
+    }
+    sendChallenge(session);
+  });
+}
+
+void
+EnrollmentEngine::sendChallenge(const shared_ptr<Session>& session)
+{
+  // each Interest of the exchange gets the full number of retransmissions
+  session->nRetries = 0;
+  auto& request = *session->request;
+  shared_ptr<Interest> interest;
+  try {
+    auto requested = request.selectOrContinueChallenge(session->task.challengeType);
+    std::multimap<std::string, std::string> parameters;
+    if (m_onChallengeParameters) {
+      parameters = m_onChallengeParameters(request, std::move(requested));
+    }
+    else {
+      for (const auto& item : requested) {
+        auto value = session->task.challengeParameters.find(item.first);
+        if (value == session->task.challengeParameters.end()) {
+          NDN_THROW(std::runtime_error("No value for challenge parameter " + item.first));
+        }
+        parameters.emplace(item.first, value->second);
+      }
+    }
+    interest = request.genChallengeInterest(std::move(parameters));
+  }
+  catch (const std::exception& e) {
+    finishSession(session, nullptr, e.what());
+    return;
+  }
+  interest->setInterestLifetime(m_options.interestLifetime);
+
+  // the parameters are encrypted under the next IV, so the same Interest is retransmitted
+  auto makeInterest = [interest] {
+    interest->refreshNonce();
+    return interest;
+  };
+  express(session, makeInterest, [this, weakSession = weak_ptr<Session>(session)] (const Data& reply) {
+    auto session = weakSession.lock();
+    if (session == nullptr) {
+      return;
+    }
+    try {
+      session->request->onChallengeResponse(reply);
+    }
+    catch (const std::exception& e) {
+      finishSession(session, nullptr, e.what());
+      return;
+    }
+    if (m_onProgress) {
+      m_onProgress(*session->request);
+    }
+    switch (session->request->m_status) {
+      case Status::SUCCESS:
+        if (m_options.wantFetchCertificate) {
+          sendCertFetch(session);
+        }
+        else {
+          finishSession(session, nullptr, "");
+        }
+        return;
+      case Status::CHALLENGE:
+        sendChallenge(session);
+        return;
+      default:
+        finishSession(session, nullptr, "Unexpected status " + statusToString(session->request->m_status));
+        return;
+    }
+  });
+}
+
+void
+EnrollmentEngine::sendCertFetch(const shared_ptr<Session>& session)
+{
+  session->nRetries = 0;
+  auto makeInterest = [this, session = session.get()] {
+    auto interest = session->request->genCertFetchInterest();
+    interest->setInterestLifetime(m_options.interestLifetime);
+    return interest;
+  };
+  express(session, makeInterest, [this, weakSession = weak_ptr<Session>(session)] (const Data& reply) {
+    auto session = weakSession.lock();
+    if (session == nullptr) {
+      return;
+    }
+    shared_ptr<security::Certificate> cert;
+    try {
+      cert = Request::onCertFetchResponse(reply);
+      auto identity = m_keyChain.getPib().getIdentity(cert->getIdentity());
+      m_keyChain.addCertificate(identity.getKey(cert->getKeyName()), *cert);
+    }
+    catch (const std::exception& e) {
+      finishSession(session, nullptr, std::string("Cannot install the issued certificate: ") + e.what());
+      return;
+    }
+    finishSession(session, cert, "");
+  });
+}
+
+void
+EnrollmentEngine::express(const shared_ptr<Session>& session, const InterestMaker& makeInterest,
+                          const function<void(const Data&)>& onData)
+{
+  auto interest = makeInterest();
+  if (interest == nullptr) {
+    finishSession(session, nullptr, "Cannot generate the Interest");
+    return;
+  }
+  weak_ptr<Session> weakSession(session);
+  session->pendingInterest = m_face.expressInterest(*interest,
+    [onData] (const Interest&, const Data& reply) {
+      onData(reply);
+    },
+    [this, weakSession, makeInterest, onData] (const Interest&, const lp::Nack& nack) {
+      if (auto session = weakSession.lock()) {
+        retry(session, makeInterest, onData, "Nack " + boost::lexical_cast<std::string>(nack.getReason()));
+      }
+    },
+    [this, weakSession, makeInterest, onData] (const Interest&) {
+      if (auto session = weakSession.lock()) {
+        retry(session, makeInterest, onData, "Timeout");
+      }
+    });
+}
+
+void
+EnrollmentEngine::retry(const shared_ptr<Session>& session, const InterestMaker& makeInterest,
+                        const function<void(const Data&)>& onData, const std::string& reason)
+{
+  if (session->nRetries >= m_options.maxRetries) {
+    finishSession(session, nullptr, reason + " after " + std::to_string(session->nRetries) + " retransmissions");
+    return;
+  }
+  auto backoff = m_options.initialBackoff;
+  for (size_t i = 0; i < session->nRetries && backoff < m_options.maxBackoff; i++) {
+    backoff *= 2;
+  }
+  backoff = std::min(backoff, m_options.maxBackoff);
+  session->nRetries++;
+  m_summary.nRetransmissions++;
+  NDN_LOG_DEBUG(reason << " for " << session->task.identityName << ", retransmitting in " << backoff);
+  session->retransmission = m_scheduler.schedule(backoff,
+    [this, weakSession = weak_ptr<Session>(session), makeInterest, onData] {
+      if (auto session = weakSession.lock()) {
+        express(session, makeInterest, onData);
+      }
+    });
+}
+
+void
+EnrollmentEngine::finishSession(const shared_ptr<Session>& session, const shared_ptr<security::Certificate>& cert,
+                                const std::string& error)
+{
+  // keep the session alive until the callbacks return, as this may run in its own handler
+  auto self = session;
+  m_sessions.erase(self);
+  if (error.empty()) {
+    m_summary.nSucceeded++;
+    NDN_LOG_TRACE("Enrolled " << self->task.identityName);
+  }
+  else {
+    m_summary.nFailed++;
+    m_summary.failures.emplace_back(self->task.identityName, error);
+    NDN_LOG_DEBUG("Cannot enroll " << self->task.identityName << ": " << error);
+    self->request->endSession();
+  }
+  m_summary.duration = time::steady_clock::now() - m_startTime;
+  if (m_onResult) {
+    m_onResult(self->task.identityName, cert, error);
+  }
+
+  startSessions();
+  if (m_sessions.empty() && m_queue.empty() && m_onComplete) {
+    auto onComplete = std::move(m_onComplete);
+    m_onComplete = nullptr;
+    onComplete(m_summary);
+  }
+}
+
+} // namespace requester
+} // namespace ndncert
+} // namespace ndn
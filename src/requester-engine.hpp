@@ -0,0 +1,250 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_REQUESTER_ENGINE_HPP
+#define NDNCERT_REQUESTER_ENGINE_HPP
+
+#include "requester-request.hpp"
+
+#include <ndn-cxx/util/scheduler.hpp>
+
+#include <list>
+#include <set>
+
+namespace ndn {
+namespace ndncert {
+namespace requester {
+
+/**
+ * @brief An identity to be enrolled by the EnrollmentEngine.
+ *
+ * An identity that already has a key in the KeyChain is enrolled with that key, which renews
+ * its certificate.
+ */
+struct EnrollmentTask
+{
+  Name identityName;
+  /**
+   * @brief The challenge to select, which the CA must offer.
+   */
+  std::string challengeType;
+  /**
+   * @brief Values of the parameters the challenge asks for, unless a ChallengeParameterCallback is set.
+   */
+  std::multimap<std::string, std::string> challengeParameters;
+};
+
+struct EnrollmentOptions
+{
+  /**
+   * @brief The number of requests in progress at the same time.
+   */
+  size_t maxInFlight = 64;
+  /**
+   * @brief How many times an Interest is retransmitted after a timeout or a Nack before the request fails.
+   */
+  size_t maxRetries = 3;
+  /**
+   * @brief The delay before the first retransmission, doubled for each following one.
+   */
+  time::milliseconds initialBackoff = time::milliseconds(200);
+  time::milliseconds maxBackoff = time::seconds(10);
+  time::milliseconds interestLifetime = time::seconds(4);
+  /**
+   * @brief The validity period requested for each certificate, starting when its request is sent.
+   *
+   * Zero requests the maximum validity period of the CA.
+   */
+  time::seconds validityPeriod = time::seconds::zero();
+  /**
+   * @brief Whether the issued certificates are fetched and installed into the KeyChain.
+   */
+  bool wantFetchCertificate = true;
+  /**
+   * @brief Where the keys of new identities come from, nullptr to generate them inline.
+   */
+  KeyPairPool* keyPool = nullptr;
+};
+
+struct EnrollmentSummary
+{
+  size_t nSucceeded = 0;
+  size_t nFailed = 0;
+  size_t nRetransmissions = 0;
+  /**
+   * @brief Time from the start to the end of the last request.
+   */
+  time::nanoseconds duration = time::nanoseconds::zero();
+  /**
+   * @brief The identities that could not be enrolled, with the reasons.
+   */
+  std::vector<std::pair<Name, std::string>> failures;
+
+  /**
+   * @brief Finished requests per second.
+   */
+  double
+  getThroughput() const;
+};
+
+std::ostream&
+operator<<(std::ostream& os, const EnrollmentSummary& summary);
+
+/**
+ * @brief Enrolls many identities with one CA concurrently over one Face.
+ *
+ * Each identity is enrolled by its own Request, which goes through NEW, CHALLENGE, and optionally
+ * certificate fetching. At most EnrollmentOptions::maxInFlight requests are in progress at the
+ * same time, and an Interest that times out or is Nacked is retransmitted with exponential
+ * backoff. All callbacks are invoked on the thread of the face.
+ */
+class EnrollmentEngine : noncopyable
+{
+public:
+  /**
+   * @brief Invoked whenever a request has moved on to its next step.
+   */
+  using ProgressCallback = function<void(const Request& request)>;
+
+  /**
+   * @brief Invoked when the enrollment of an identity has finished.
+   *
+   * @param cert the issued certificate, nullptr if it was not fetched or the enrollment failed
+   * @param error why the enrollment failed, empty if it succeeded
+   */
+  using ResultCallback = function<void(const Name& identityName, const shared_ptr<security::Certificate>& cert,
+                                       const std::string& error)>;
+
+  /**
+   * @brief Provides the values of the parameters a challenge step asks for.
+   *
+   * @param requested the parameters with their prompts, as returned by Request::selectOrContinueChallenge()
+   * @return the parameters with their values
+   */
+  using ChallengeParameterCallback =
+    function<std::multimap<std::string, std::string>(const Request& request,
+                                                     std::multimap<std::string, std::string>&& requested)>;
+
+  using CompletionCallback = function<void(const EnrollmentSummary& summary)>;
+
+  EnrollmentEngine(Face& face, security::KeyChain& keyChain, const CaProfile& profile,
+                   const EnrollmentOptions& options = EnrollmentOptions());
+
+  ~EnrollmentEngine();
+
+  void
+  setProgressCallback(const ProgressCallback& callback)
+  {
+    m_onProgress = callback;
+  }
+
+  void
+  setResultCallback(const ResultCallback& callback)
+  {
+    m_onResult = callback;
+  }
+
+  void
+  setChallengeParameterCallback(const ChallengeParameterCallback& callback)
+  {
+    m_onChallengeParameters = callback;
+  }
+
+  /**
+   * @brief Enroll the identities of @p tasks, with @p onComplete invoked after the last one.
+   *
+   * The summary is reset when the engine starts. Tasks added while the engine is running are
+   * queued behind the pending ones.
+   */
+  void
+  enroll(std::vector<EnrollmentTask> tasks, const CompletionCallback& onComplete = nullptr);
+
+  const EnrollmentSummary&
+  getSummary() const
+  {
+    return m_summary;
+  }
+
+  size_t
+  getInFlightCount() const
+  {
+    return m_sessions.size();
+  }
+
+  size_t
+  getQueuedCount() const
+  {
+    return m_queue.size();
+  }
+
+private:
+  struct Session;
+  using InterestMaker = function<shared_ptr<Interest>()>;
+
+  void
+  startSessions();
+
+  void
+  sendNew(const shared_ptr<Session>& session);
+
+  void
+  sendChallenge(const shared_ptr<Session>& session);
+
+  void
+  sendCertFetch(const shared_ptr<Session>& session);
+
+  /**
+   * @brief Express the Interest made by @p makeInterest, made again for each retransmission.
+   */
+  void
+  express(const shared_ptr<Session>& session, const InterestMaker& makeInterest,
+          const function<void(const Data&)>& onData);
+
+  void
+  retry(const shared_ptr<Session>& session, const InterestMaker& makeInterest,
+        const function<void(const Data&)>& onData, const std::string& reason);
+
+  void
+  finishSession(const shared_ptr<Session>& session, const shared_ptr<security::Certificate>& cert,
+                const std::string& error);
+
+private:
+  Face& m_face;
+  security::KeyChain& m_keyChain;
+  CaProfile m_profile;
+  EnrollmentOptions m_options;
+  Scheduler m_scheduler;
+
+  ProgressCallback m_onProgress;
+  ResultCallback m_onResult;
+  ChallengeParameterCallback m_onChallengeParameters;
+  CompletionCallback m_onComplete;
+
+  std::list<EnrollmentTask> m_queue;
+  std::set<shared_ptr<Session>> m_sessions;
+  EnrollmentSummary m_summary;
+  time::steady_clock::TimePoint m_startTime;
+};
+
+} // namespace requester
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_REQUESTER_ENGINE_HPP
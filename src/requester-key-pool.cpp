@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "requester-key-pool.hpp"
+
+#include <ndn-cxx/security/safe-bag.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <ndn-cxx/security/transform/private-key.hpp>
+#include <ndn-cxx/util/random.hpp>
+#include <ndn-cxx/util/string-helper.hpp>
+
+#include <sstream>
+
+namespace ndn {
+namespace ndncert {
+namespace requester {
+
+NDN_LOG_INIT(ndncert.client.keypool);
+
+// the validity period KeyChain::createKey() gives to self-signed certificates
+static const time::days SELF_SIGNED_VALIDITY = time::days(365 * 20);
+
+KeyPairPool::KeyPairPool(size_t capacity, KeyType keyType, uint32_t keySize)
+  : m_capacity(capacity)
+  , m_keyType(keyType)
+  , m_keySize(keySize)
+{
+  if (m_keyType != KeyType::EC && m_keyType != KeyType::RSA) {
+    NDN_THROW(std::invalid_argument("Unsupported key type of the key pair pool"));
+  }
+  std::array<uint8_t, 32> password;
+  random::generateSecureBytes(password.data(), password.size());
+  m_password = toHex(password.data(), password.size());
+  m_generator = std::thread(&KeyPairPool::generateKeyPairs, this);
+}
+
+KeyPairPool::~KeyPairPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shouldStop = true;
+  }
+  m_cv.notify_all();
+  m_generator.join();
+}
+
+security::Key
+KeyPairPool::acquire(security::KeyChain& keyChain, const Name& identityName)
+{
+  optional<KeyPair> keyPair;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_keyPairs.empty()) {
+      keyPair = std::move(m_keyPairs.front());
+      m_keyPairs.pop_front();
+    }
+    else {
+      m_nMisses++;
+    }
+  }
+  m_cv.notify_all();
+  if (!keyPair) {
+    NDN_LOG_DEBUG("Key pair pool is empty, generating the key of " << identityName << " inline");
+    keyPair = generateKeyPair();
+  }
+
+  Name keyName;
+  do {
+    keyName = Name(identityName).append("KEY").append(name::Component::fromNumber(random::generateSecureWord64()));
+  } while (keyChain.getTpm().hasKey(keyName));
+
+  // the certificate in a SafeBag must be signed, but the key is not in the TPM until imported
+  security::Certificate cert;
+  cert.setName(Name(keyName).append("self").appendVersion());
+  cert.setContentType(ndn::tlv::ContentType_Key);
+  cert.setFreshnessPeriod(time::hours(1));
+  cert.setContent(keyPair->publicKey.data(), keyPair->publicKey.size());
+  keyChain.sign(cert, security::signingWithSha256());
+  keyChain.importSafeBag(security::SafeBag(cert, keyPair->encryptedPrivateKey),
+                         m_password.data(), m_password.size());
+
+  auto key = keyChain.getPib().getIdentity(identityName).getKey(keyName);
+  auto now = time::system_clock::now();
+  SignatureInfo signatureInfo;
+  signatureInfo.setValidityPeriod(security::ValidityPeriod(now, now + SELF_SIGNED_VALIDITY));
+  keyChain.sign(cert, signingByKey(keyName).setSignatureInfo(signatureInfo));
+  keyChain.addCertificate(key, cert);
+  return key;
+}
+
+void
+KeyPairPool::reclaim(security::KeyChain& keyChain, const security::Key& key)
+{
+  KeyPair keyPair;
+  try {
+    auto safeBag = keyChain.exportSafeBag(key.getDefaultCertificate(),
+                                          m_password.data(), m_password.size());
+    keyPair.publicKey = key.getPublicKey();
+    keyPair.encryptedPrivateKey = safeBag->getEncryptedKeyBag();
+  }
+  catch (const std::exception& e) {
+    NDN_LOG_DEBUG("Cannot reclaim key " << key.getName() << ": " << e.what());
+    return;
+  }
+  // taken before the generated ones; the pool exceeds its capacity until it is drained again
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_keyPairs.push_front(std::move(keyPair));
+  NDN_LOG_TRACE("Reclaimed key " << key.getName());
+}
+
+size_t
+KeyPairPool::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_keyPairs.size();
+}
+
+KeyPairPool::KeyPair
+KeyPairPool::generateKeyPair() const
+{
+  unique_ptr<security::transform::PrivateKey> privateKey;
+  if (m_keyType == KeyType::RSA) {
+    privateKey = security::transform::generatePrivateKey(RsaKeyParams(m_keySize));
+  }
+  else {
+    privateKey = security::transform::generatePrivateKey(EcKeyParams(m_keySize));
+  }
+
+  KeyPair keyPair;
+  keyPair.publicKey = *privateKey->derivePublicKey();
+  std::ostringstream os;
+  privateKey->savePkcs8(os, m_password.data(), m_password.size());
+  auto encrypted = os.str();
+  keyPair.encryptedPrivateKey = Buffer(encrypted.data(), encrypted.size());
+  return keyPair;
+}
+
+void
+KeyPairPool::generateKeyPairs()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_shouldStop) {
+    if (m_keyPairs.size() >= m_capacity) {
+      m_cv.wait(lock);
+      continue;
+    }
+    lock.unlock();
+    KeyPair keyPair;
+    try {
+      keyPair = generateKeyPair();
+    }
+    catch (const std::exception& e) {
+      NDN_LOG_ERROR("Cannot generate key pairs, the pool stops filling: " << e.what());
+      return;
+    }
+    lock.lock();
+    m_keyPairs.push_back(std::move(keyPair));
+  }
+}
+
+} // namespace requester
+} // namespace ndncert
+} // namespace ndn
@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_REQUESTER_KEY_POOL_HPP
+#define NDNCERT_REQUESTER_KEY_POOL_HPP
+
+#include "detail/ndncert-common.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace ndn {
+namespace ndncert {
+namespace requester {
+
+/**
+ * @brief Key pairs generated ahead of time for the identities of new requests.
+ *
+ * A background thread keeps the pool filled up to its capacity. acquire() turns a pooled key
+ * pair into a key of the requested identity in the caller's KeyChain, which costs an import
+ * instead of a key generation. The private keys wait in the pool encrypted under a random
+ * password of the pool, and are imported into the TPM of the KeyChain when acquired, so the
+ * pool works with both TPM-backed and in-memory KeyChains.
+ *
+ * The KeyChain is only used on the thread calling acquire() and reclaim().
+ */
+class KeyPairPool : noncopyable
+{
+public:
+  /**
+   * @param capacity the number of key pairs to keep ready
+   * @param keyType either KeyType::EC or KeyType::RSA
+   * @param keySize the size of the keys in bits
+   */
+  explicit
+  KeyPairPool(size_t capacity, KeyType keyType = KeyType::EC, uint32_t keySize = 256);
+
+  ~KeyPairPool();
+
+  /**
+   * @brief Create a key of @p identityName in @p keyChain from a pooled key pair.
+   *
+   * The identity is created if it does not exist, and the key gets a self-signed certificate,
+   * like KeyChain::createKey(). When the pool is empty, the key pair is generated inline.
+   */
+  security::Key
+  acquire(security::KeyChain& keyChain, const Name& identityName);
+
+  /**
+   * @brief Put the key pair of @p key back into the pool, before its key is deleted from @p keyChain.
+   *
+   * The key pair is handed out by the next acquire().
+   */
+  void
+  reclaim(security::KeyChain& keyChain, const security::Key& key);
+
+  size_t
+  size() const;
+
+  size_t
+  getCapacity() const
+  {
+    return m_capacity;
+  }
+
+  /**
+   * @brief The number of keys acquired that had to be generated inline.
+   */
+  uint64_t
+  getMissCount() const
+  {
+    return m_nMisses;
+  }
+
+private:
+  struct KeyPair
+  {
+    Buffer publicKey;
+    /**
+     * @brief The private key in encrypted PKCS #8 format, under the password of the pool.
+     */
+    Buffer encryptedPrivateKey;
+  };
+
+  KeyPair
+  generateKeyPair() const;
+
+  void
+  generateKeyPairs();
+
+private:
+  const size_t m_capacity;
+  const KeyType m_keyType;
+  const uint32_t m_keySize;
+  std::string m_password;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<KeyPair> m_keyPairs;
+  bool m_shouldStop = false;
+  std::thread m_generator;
+  uint64_t m_nMisses = 0;
+};
+
+} // namespace requester
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_REQUESTER_KEY_POOL_HPP
@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "requester-renewal.hpp"
+
+#include <ndn-cxx/security/pib/identity.hpp>
+#include <ndn-cxx/security/pib/key.hpp>
+#include <ndn-cxx/util/random.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <limits>
+
+namespace ndn {
+namespace ndncert {
+namespace requester {
+
+NDN_LOG_INIT(ndncert.client.renewal);
+
+// the issuer component of the certificates issued by ndncert CAs
+static const name::Component ISSUER_ID("NDNCERT");
+
+RenewalScheduler::RenewalScheduler(const std::vector<Name>& caPrefixes, const RenewalOptions& options)
+  : m_caPrefixes(caPrefixes)
+  , m_options(options)
+{
+}
+
+size_t
+RenewalScheduler::scan(const security::pib::Pib& pib)
+{
+  for (const auto& identity : pib.getIdentities()) {
+    for (const auto& key : identity.getKeys()) {
+      for (const auto& cert : key.getCertificates()) {
+        add(cert);
+      }
+    }
+  }
+  NDN_LOG_DEBUG("Tracking " << m_entries.size() << " identities");
+  return m_entries.size();
+}
+
+bool
+RenewalScheduler::add(const security::Certificate& cert)
+{
+  auto caPrefix = findIssuingCa(cert);
+  if (!caPrefix) {
+    return false;
+  }
+  auto validity = cert.getValidityPeriod().getPeriod();
+  auto identityName = cert.getIdentity();
+  auto it = m_entries.find(identityName);
+  if (it != m_entries.end() && it->second.entry.notAfter >= validity.second) {
+    return false;
+  }
+
+  RenewalEntry entry;
+  entry.identityName = identityName;
+  entry.certName = cert.getName();
+  entry.caPrefix = *caPrefix;
+  entry.notAfter = validity.second;
+  auto saved = m_savedEntries.find(identityName);
+  if (saved != m_savedEntries.end() && saved->second.certName == entry.certName) {
+    entry.deadline = saved->second.deadline;
+    entry.nFailures = saved->second.nFailures;
+  }
+  else {
+    entry.deadline = computeDeadline(cert.getValidityPeriod(), time::system_clock::now());
+  }
+  m_entries[identityName].entry = std::move(entry);
+  schedule(identityName);
+  return true;
+}
+
+void
+RenewalScheduler::remove(const Name& identityName)
+{
+  // the heap item left behind is skipped as stale
+  m_entries.erase(identityName);
+}
+
+std::vector<RenewalEntry>
+RenewalScheduler::popDue(const time::system_clock::TimePoint& now, size_t limit)
+{
+  std::vector<RenewalEntry> due;
+  while (!m_heap.empty() && due.size() < limit && m_heap.top().deadline <= now) {
+    auto item = m_heap.top();
+    m_heap.pop();
+    auto it = m_entries.find(item.identityName);
+    if (it == m_entries.end() || it->second.generation != item.generation) {
+      continue;
+    }
+    due.push_back(it->second.entry);
+  }
+  return due;
+}
+
+void
+RenewalScheduler::reportFailure(const Name& identityName, const time::system_clock::TimePoint& now)
+{
+  auto it = m_entries.find(identityName);
+  if (it == m_entries.end()) {
+    return;
+  }
+  auto& entry = it->second.entry;
+  time::seconds delay = m_options.minRetryDelay;
+  for (size_t i = 0; i < entry.nFailures && delay < m_options.maxRetryDelay; i++) {
+    delay *= 2;
+  }
+  entry.nFailures++;
+  entry.deadline = now + std::min(delay, m_options.maxRetryDelay);
+  NDN_LOG_DEBUG("Renewal of " << identityName << " failed " << entry.nFailures << " times, retrying at "
+                << time::toIsoString(entry.deadline));
+  schedule(identityName);
+}
+
+optional<time::system_clock::TimePoint>
+RenewalScheduler::getNextDeadline()
+{
+  while (!m_heap.empty()) {
+    const auto& item = m_heap.top();
+    auto it = m_entries.find(item.identityName);
+    if (it != m_entries.end() && it->second.generation == item.generation) {
+      return item.deadline;
+    }
+    m_heap.pop();
+  }
+  return nullopt;
+}
+
+const RenewalEntry*
+RenewalScheduler::find(const Name& identityName) const
+{
+  auto it = m_entries.find(identityName);
+  return it == m_entries.end() ? nullptr : &it->second.entry;
+}
+
+void
+RenewalScheduler::load(const std::string& fileName)
+{
+  JsonSection json;
+  try {
+    boost::property_tree::read_json(fileName, json);
+  }
+  catch (const std::exception& error) {
+    NDN_THROW(std::runtime_error("Failed to parse renewal state file " + fileName + ", " + error.what()));
+  }
+  m_savedEntries.clear();
+  auto renewals = json.get_child_optional("renewals");
+  if (!renewals) {
+    return;
+  }
+  for (const auto& item : *renewals) {
+    RenewalEntry entry;
+    entry.identityName = Name(item.second.get("identity", ""));
+    entry.certName = Name(item.second.get("certificate", ""));
+    entry.caPrefix = Name(item.second.get("ca-prefix", ""));
+    entry.deadline = time::fromUnixTimestamp(time::milliseconds(item.second.get<int64_t>("deadline", 0)));
+    entry.nFailures = item.second.get<size_t>("failures", 0);
+    if (entry.identityName.empty() || entry.certName.empty()) {
+      NDN_THROW(std::runtime_error("Renewal state file " + fileName + " has an entry without identity or certificate"));
+    }
+    m_savedEntries[entry.identityName] = std::move(entry);
+  }
+}
+
+void
+RenewalScheduler::save(const std::string& fileName) const
+{
+  JsonSection renewals;
+  for (const auto& item : m_entries) {
+    const auto& entry = item.second.entry;
+    JsonSection entryJson;
+    entryJson.put("identity", entry.identityName.toUri());
+    entryJson.put("certificate", entry.certName.toUri());
+    entryJson.put("ca-prefix", entry.caPrefix.toUri());
+    entryJson.put("deadline", time::toUnixTimestamp(entry.deadline).count());
+    entryJson.put("failures", entry.nFailures);
+    renewals.push_back(std::make_pair("", entryJson));
+  }
+  JsonSection json;
+  json.add_child("renewals", renewals);
+
+  // write to a temporary file first, so a crash cannot leave a truncated state behind
+  auto tmpFileName = fileName + ".tmp";
+  boost::property_tree::write_json(tmpFileName, json);
+  boost::filesystem::rename(tmpFileName, fileName);
+}
+
+optional<Name>
+RenewalScheduler::findIssuingCa(const security::Certificate& cert) const
+{
+  const auto& certName = cert.getName();
+  if (certName.size() < 2 || certName.at(security::Certificate::ISSUER_ID_OFFSET) != ISSUER_ID) {
+    return nullopt;
+  }
+  const auto& signatureInfo = cert.getSignatureInfo();
+  if (!signatureInfo.hasKeyLocator() || signatureInfo.getKeyLocator().getType() != tlv::Name) {
+    return nullopt;
+  }
+  const auto& signerName = signatureInfo.getKeyLocator().getName();
+  optional<Name> caPrefix;
+  for (const auto& prefix : m_caPrefixes) {
+    if (prefix.isPrefixOf(signerName) && prefix.isPrefixOf(cert.getIdentity()) &&
+        (!caPrefix || prefix.size() > caPrefix->size())) {
+      caPrefix = prefix;
+    }
+  }
+  return caPrefix;
+}
+
+time::system_clock::TimePoint
+RenewalScheduler::computeDeadline(const security::ValidityPeriod& validity,
+                                  const time::system_clock::TimePoint& now) const
+{
+  auto period = validity.getPeriod();
+  if (period.second <= now) {
+    return now;
+  }
+  auto lifetime = time::duration_cast<time::milliseconds>(period.second - period.first);
+  auto randomFraction = static_cast<double>(random::generateWord32()) / std::numeric_limits<uint32_t>::max();
+  auto deadline = period.first + time::milliseconds(static_cast<int64_t>(lifetime.count() * m_options.renewAt)) -
+                  time::milliseconds(static_cast<int64_t>(lifetime.count() * m_options.jitter * randomFraction));
+  if (deadline < now) {
+    // already past its renewal time, spread over the first half of what is left
+    auto remaining = time::duration_cast<time::milliseconds>(period.second - now);
+    auto spread = std::min(remaining / 2, time::milliseconds(static_cast<int64_t>(lifetime.count() * m_options.jitter)));
+    deadline = now + time::milliseconds(static_cast<int64_t>(spread.count() * randomFraction));
+  }
+  return deadline;
+}
+
+void
+RenewalScheduler::schedule(const Name& identityName)
+{
+  auto& tracked = m_entries.at(identityName);
+  tracked.generation = m_nextGeneration++;
+  m_heap.push({tracked.entry.deadline, identityName, tracked.generation});
+}
+
+} // namespace requester
+} // namespace ndncert
+} // namespace ndn
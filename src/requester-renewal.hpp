@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#ifndef NDNCERT_REQUESTER_RENEWAL_HPP
+#define NDNCERT_REQUESTER_RENEWAL_HPP
+
+#include "detail/ndncert-common.hpp"
+
+#include <ndn-cxx/security/pib/pib.hpp>
+
+#include <map>
+#include <queue>
+
+namespace ndn {
+namespace ndncert {
+namespace requester {
+
+struct RenewalOptions
+{
+  /**
+   * @brief The fraction of a certificate's validity period after which it is renewed.
+   */
+  double renewAt = 2.0 / 3.0;
+  /**
+   * @brief The fraction of a certificate's validity period over which renewals are spread.
+   *
+   * The renewal deadline is moved earlier by a random offset up to this fraction, so that
+   * certificates issued together are not renewed together.
+   */
+  double jitter = 0.1;
+  /**
+   * @brief The delay before retrying a failed renewal, doubled for each following failure.
+   */
+  time::seconds minRetryDelay = time::seconds(60);
+  time::seconds maxRetryDelay = time::hours(1);
+};
+
+struct RenewalEntry
+{
+  Name identityName;
+  /**
+   * @brief The certificate to be renewed, the latest one of the identity issued by the CA.
+   */
+  Name certName;
+  Name caPrefix;
+  time::system_clock::TimePoint notAfter;
+  time::system_clock::TimePoint deadline;
+  size_t nFailures = 0;
+};
+
+/**
+ * @brief Keeps the renewal deadlines of the certificates issued by a set of CAs.
+ *
+ * The KeyChain is scanned once, and afterwards the scheduler is told about every renewed
+ * certificate, so the PIB is never polled. Deadlines are kept in a min-heap; an identity whose
+ * deadline changes leaves a stale heap item behind, which is skipped when it reaches the top.
+ *
+ * The state can be saved to a JSON file, so a restarted renewer keeps the deadlines and
+ * failure counts instead of drawing new jitter:
+ * {
+ *   "renewals":
+ *   [
+ *     { "identity": "/ndn/a", "certificate": "/ndn/a/KEY/...", "ca-prefix": "/ndn",
+ *       "deadline": "1600000000000", "failures": "0" }
+ *   ]
+ * }
+ */
+class RenewalScheduler : noncopyable
+{
+public:
+  explicit
+  RenewalScheduler(const std::vector<Name>& caPrefixes, const RenewalOptions& options = RenewalOptions());
+
+  /**
+   * @brief Track the certificates in @p pib issued by one of the CAs.
+   * @return the number of identities tracked
+   */
+  size_t
+  scan(const security::pib::Pib& pib);
+
+  /**
+   * @brief Track @p cert, replacing the older certificate of its identity.
+   * @return false if the certificate is not issued by one of the CAs, or older than the tracked one
+   */
+  bool
+  add(const security::Certificate& cert);
+
+  void
+  remove(const Name& identityName);
+
+  /**
+   * @brief Take up to @p limit identities whose deadlines have passed, earliest first.
+   *
+   * Each of them stays tracked but is not returned again until add() or reportFailure()
+   * is called for it.
+   */
+  std::vector<RenewalEntry>
+  popDue(const time::system_clock::TimePoint& now, size_t limit);
+
+  /**
+   * @brief Schedule a retry of the failed renewal of @p identityName, with exponential backoff.
+   */
+  void
+  reportFailure(const Name& identityName, const time::system_clock::TimePoint& now);
+
+  /**
+   * @return the earliest deadline, or nullopt when nothing is scheduled
+   */
+  optional<time::system_clock::TimePoint>
+  getNextDeadline();
+
+  const RenewalEntry*
+  find(const Name& identityName) const;
+
+  size_t
+  size() const
+  {
+    return m_entries.size();
+  }
+
+  /**
+   * @brief Load the state saved by a previous run. Call before scan().
+   * @throw std::runtime_error when the file cannot be correctly parsed.
+   */
+  void
+  load(const std::string& fileName);
+
+  void
+  save(const std::string& fileName) const;
+
+NDNCERT_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  /**
+   * @return the prefix of the CA that issued @p cert, the longest one if several match
+   */
+  optional<Name>
+  findIssuingCa(const security::Certificate& cert) const;
+
+  time::system_clock::TimePoint
+  computeDeadline(const security::ValidityPeriod& validity, const time::system_clock::TimePoint& now) const;
+
+private:
+  void
+  schedule(const Name& identityName);
+
+private:
+  struct Tracked
+  {
+    RenewalEntry entry;
+    uint64_t generation = 0;
+  };
+
+  struct HeapItem
+  {
+    time::system_clock::TimePoint deadline;
+    Name identityName;
+    uint64_t generation;
+
+    bool
+    operator>(const HeapItem& other) const
+    {
+      return deadline > other.deadline;
+    }
+  };
+
+  std::vector<Name> m_caPrefixes;
+  RenewalOptions m_options;
+  std::map<Name, Tracked> m_entries;
+  std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<HeapItem>> m_heap;
+  uint64_t m_nextGeneration = 1;
+  /**
+   * @brief Entries loaded from a saved state, reused by add() while the certificate is unchanged.
+   */
+  std::map<Name, RenewalEntry> m_savedEntries;
+};
+
+} // namespace requester
+} // namespace ndncert
+} // namespace ndn
+
+#endif // NDNCERT_REQUESTER_RENEWAL_HPP
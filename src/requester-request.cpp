@@ -19,6 +19,7 @@
  */
 
 #include "requester-request.hpp"
+#include "requester-key-pool.hpp"
 #include "challenge/challenge-module.hpp"
 #include "detail/crypto-helpers.hpp"
 #include "detail/challenge-encoder.hpp"
@@ -35,11 +36,31 @@
 #include <ndn-cxx/util/random.hpp>
 #include <ndn-cxx/metadata-object.hpp>
 #include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <unistd.h>
 
 namespace ndn {
 namespace ndncert {
 namespace requester {
 
+// leaves room for the name and the signature of a BATCH-NEW interest
+static const size_t BATCH_NEW_PARAMETERS_SIZE_LIMIT = MAX_NDN_PACKET_SIZE - 1024;
+
+// TLV types of a saved request, which is never sent over the network
+static const uint32_t TLV_SESSION_STATE = 211;
+static const uint32_t TLV_SESSION_KEY_NAME = 213;
+static const uint32_t TLV_SESSION_AES_KEY = 215;
+static const uint32_t TLV_SESSION_ENCRYPTION_IV = 217;
+static const uint32_t TLV_SESSION_DECRYPTION_IV = 219;
+static const uint32_t TLV_SESSION_FRESH_BEFORE = 221;
+static const uint32_t TLV_SESSION_FLAGS = 223;
+static const uint32_t TLV_SESSION_REQUEST_TYPE = 225;
+static const uint64_t SESSION_FLAG_NEW_IDENTITY = 1;
+static const uint64_t SESSION_FLAG_NEW_KEY = 2;
+
 NDN_LOG_INIT(ndncert.client);
 
 shared_ptr<Interest>
@@ -134,6 +155,73 @@ Request::genNewInterest(const Name& newIdentityName,
   if (!m_caProfile.caPrefix.isPrefixOf(newIdentityName)) {
     return nullptr;
   }
+  auto certRequest = genCertRequest(newIdentityName, notBefore, notAfter);
+
+  // generate Interest packet
+  Name interestName = m_caProfile.caPrefix;
+  interestName.append("CA").append("NEW");
+  auto interest =std::make_shared<Interest>(interestName);
+  interest->setMustBeFresh(true);
+  interest->setCanBePrefix(false);
+  interest->setApplicationParameters(
+          requesttlv::encodeApplicationParameters(RequestType::NEW, m_ecdh.getSelfPubKey(), certRequest));
+
+  // sign the Interest packet
+  m_keyChain.sign(*interest, signingByKey(m_keyPair.getName()));
+  return interest;
+}
+
+std::vector<std::pair<shared_ptr<Interest>, size_t>>
+Request::genBatchNewInterests(const std::vector<Request*>& requests, const std::vector<Name>& identityNames,
+                              const time::system_clock::TimePoint& notBefore,
+                              const time::system_clock::TimePoint& notAfter)
+{
+  BOOST_ASSERT(requests.size() == identityNames.size());
+  std::vector<std::pair<shared_ptr<Interest>, size_t>> interests;
+  std::vector<Block> entries;
+  size_t entriesSize = 0;
+  Request* signer = nullptr;
+
+  auto finishInterest = [&] {
+    Name interestName = signer->m_caProfile.caPrefix;
+    interestName.append("CA").append("BATCH-NEW");
+    auto interest = std::make_shared<Interest>(interestName);
+    interest->setMustBeFresh(true);
+    interest->setCanBePrefix(false);
+    interest->setApplicationParameters(requesttlv::encodeBatchApplicationParameters(entries));
+    signer->m_keyChain.sign(*interest, signingByKey(signer->m_keyPair.getName()));
+    interests.emplace_back(interest, entries.size());
+    entries.clear();
+    entriesSize = 0;
+  };
+
+  for (size_t i = 0; i < requests.size(); i++) {
+    auto& request = *requests[i];
+    if (!request.m_caProfile.caPrefix.isPrefixOf(identityNames[i])) {
+      NDN_THROW(std::runtime_error("Identity " + identityNames[i].toUri() + " is not under the CA prefix"));
+    }
+    auto certRequest = request.genCertRequest(identityNames[i], notBefore, notAfter);
+    auto entry = requesttlv::encodeBatchEntry(request.m_ecdh.getSelfPubKey(), certRequest);
+    if (!entries.empty() && entriesSize + entry.size() > BATCH_NEW_PARAMETERS_SIZE_LIMIT) {
+      finishInterest();
+    }
+    if (entries.empty()) {
+      signer = &request;
+    }
+    entriesSize += entry.size();
+    entries.push_back(std::move(entry));
+  }
+  if (!entries.empty()) {
+    finishInterest();
+  }
+  return interests;
+}
+
+security::Certificate
+Request::genCertRequest(const Name& newIdentityName,
+                        const time::system_clock::TimePoint& notBefore,
+                        const time::system_clock::TimePoint& notAfter)
+{
   if (newIdentityName.empty()) {
     NDN_LOG_TRACE("Randomly create a new name because newIdentityName is empty and the param is empty.");
     m_identityName = m_caProfile.caPrefix;
@@ -150,7 +238,14 @@ Request::genNewInterest(const Name& newIdentityName,
     identity = pib.getIdentity(m_identityName);
   }
   catch (const security::Pib::Error& e) {
-    identity = m_keyChain.createIdentity(m_identityName);
+    if (m_keyPool != nullptr) {
+      // creates the identity along with the key
+      m_keyPool->acquire(m_keyChain, m_identityName);
+      identity = pib.getIdentity(m_identityName);
+    }
+    else {
+      identity = m_keyChain.createIdentity(m_identityName);
+    }
     m_isNewlyCreatedIdentity = true;
     m_isNewlyCreatedKey = true;
   }
@@ -158,7 +253,7 @@ Request::genNewInterest(const Name& newIdentityName,
     m_keyPair = identity.getDefaultKey();
   }
   catch (const security::Pib::Error& e) {
-    m_keyPair = m_keyChain.createKey(identity);
+    m_keyPair = m_keyPool != nullptr ? m_keyPool->acquire(m_keyChain, m_identityName) : m_keyChain.createKey(identity);
     m_isNewlyCreatedKey = true;
   }
   auto& keyName = m_keyPair.getName();
@@ -171,19 +266,7 @@ Request::genNewInterest(const Name& newIdentityName,
   SignatureInfo signatureInfo;
   signatureInfo.setValidityPeriod(security::ValidityPeriod(notBefore, notAfter));
   m_keyChain.sign(certRequest, signingByKey(keyName).setSignatureInfo(signatureInfo));
-
-  // generate Interest packet
-  Name interestName = m_caProfile.caPrefix;
-  interestName.append("CA").append("NEW");
-  auto interest =std::make_shared<Interest>(interestName);
-  interest->setMustBeFresh(true);
-  interest->setCanBePrefix(false);
-  interest->setApplicationParameters(
-          requesttlv::encodeApplicationParameters(RequestType::NEW, m_ecdh.getSelfPubKey(), certRequest));
-
-  // sign the Interest packet
-  m_keyChain.sign(*interest, signingByKey(keyName));
-  return interest;
+  return certRequest;
 }
 
 shared_ptr<Interest>
@@ -218,19 +301,62 @@ Request::onNewRenewRevokeResponse(const Data& reply)
   auto challenges = requesttlv::decodeDataContent(contentTLV, ecdhKey, salt, m_requestId);
 
   // ECDH and HKDF
+  deriveEncryptionKey(ecdhKey, salt);
+
+  // update state
+  if (!m_stateFile.empty()) {
+    saveState(m_stateFile);
+  }
+  return challenges;
+}
+
+std::list<std::string>
+Request::onBatchNewResponse(const Data& reply, const std::vector<Request*>& requests,
+                            std::vector<std::string>& errorInfos)
+{
+  if (requests.empty()) {
+    NDN_THROW(std::runtime_error("No request is carried by the BATCH-NEW interest."));
+  }
+  if (!security::verifySignature(reply, *requests.front()->m_caProfile.cert)) {
+    NDN_LOG_ERROR("Cannot verify replied Data packet signature.");
+    NDN_THROW(std::runtime_error("Cannot verify replied Data packet signature."));
+  }
+  processIfError(reply);
+
+  std::vector<requesttlv::BatchResult> results;
+  auto challenges = requesttlv::decodeBatchDataContent(reply.getContent(), results);
+  if (results.size() != requests.size()) {
+    NDN_THROW(std::runtime_error("The BATCH-NEW response does not match the requests."));
+  }
+  errorInfos.assign(requests.size(), "");
+  for (size_t i = 0; i < results.size(); i++) {
+    auto& request = *requests[i];
+    const auto& result = results[i];
+    if (result.error != ErrorCode::NO_ERROR) {
+      NDN_LOG_DEBUG("Request of " << request.m_identityName << " rejected: " << result.errorInfo);
+      request.m_status = Status::FAILURE;
+      errorInfos[i] = result.errorInfo;
+      continue;
+    }
+    request.m_requestId = result.requestId;
+    request.deriveEncryptionKey(result.ecdhKey, result.salt);
+  }
+  return challenges;
+}
+
+void
+Request::deriveEncryptionKey(const std::vector<uint8_t>& ecdhKey, const std::array<uint8_t, 32>& salt)
+{
   auto sharedSecret = m_ecdh.deriveSecret(ecdhKey);
   hkdf(sharedSecret.data(), sharedSecret.size(),
        salt.data(), salt.size(), m_aesKey.data(), m_aesKey.size(),
        m_requestId.data(), m_requestId.size());
-
-  // update state
-  return challenges;
 }
 
 std::multimap<std::string, std::string>
 Request::selectOrContinueChallenge(const std::string& challengeSelected)
 {
-  auto challenge = ChallengeModule::createChallengeModule(challengeSelected);
+  auto challenge = ChallengeModule::getChallengeModule(challengeSelected);
   if (challenge == nullptr) {
     NDN_THROW(std::runtime_error("The challenge selected is not supported by your current version of NDNCERT."));
   }
@@ -244,7 +370,7 @@ Request::genChallengeInterest(std::multimap<std::string, std::string>&& paramete
   if (m_challengeType == "") {
     NDN_THROW(std::runtime_error("The challenge has not been selected."));
   }
-  auto challenge = ChallengeModule::createChallengeModule(m_challengeType);
+  auto challenge = ChallengeModule::getChallengeModule(m_challengeType);
   if (challenge == nullptr) {
     NDN_THROW(std::runtime_error("The challenge selected is not supported by your current version of NDNCERT."));
   }
@@ -261,6 +387,10 @@ Request::genChallengeInterest(std::multimap<std::string, std::string>&& paramete
                                              challengeParams.value(), challengeParams.value_size(),
                                              m_requestId.data(), m_requestId.size(),
                                              m_encryptionIv);
+  // the IV used above must be on disk before the ciphertext can leave the process
+  if (!m_stateFile.empty()) {
+    saveState(m_stateFile);
+  }
   interest->setApplicationParameters(paramBlock);
   m_keyChain.sign(*interest, signingByKey(m_keyPair.getName()));
   return interest;
@@ -275,6 +405,9 @@ Request::onChallengeResponse(const Data& reply)
   }
   processIfError(reply);
   challengetlv::decodeDataContent(reply.getContent(), *this);
+  if (!m_stateFile.empty()) {
+    saveState(m_stateFile);
+  }
 }
 
 shared_ptr<Interest>
@@ -306,6 +439,9 @@ Request::endSession()
   if (m_status == Status::SUCCESS) {
     return;
   }
+  if (m_keyPool != nullptr && m_isNewlyCreatedKey) {
+    m_keyPool->reclaim(m_keyChain, m_keyPair);
+  }
   if (m_isNewlyCreatedIdentity) {
     // put the identity into the if scope is because it may cause an error
     // outside since when endSession is called, identity may not have been created yet.
@@ -332,6 +468,140 @@ Request::processIfError(const Data& data)
                                " and Error Info: " + std::get<1>(errorInfo)));
 }
 
+Block
+Request::encodeState() const
+{
+  if (std::all_of(m_aesKey.begin(), m_aesKey.end(), [] (uint8_t byte) { return byte == 0; })) {
+    NDN_THROW(std::runtime_error("The request cannot be saved before the CA has replied to it"));
+  }
+  Block block(TLV_SESSION_STATE);
+  block.push_back(infotlv::encodeDataContent(m_caProfile, *m_caProfile.cert));
+  block.push_back(makeNonNegativeIntegerBlock(TLV_SESSION_REQUEST_TYPE, static_cast<uint64_t>(m_type)));
+  block.push_back(m_identityName.wireEncode());
+  block.push_back(makeNestedBlock(TLV_SESSION_KEY_NAME, m_keyPair.getName()));
+  block.push_back(makeBinaryBlock(tlv::RequestId, m_requestId.data(), m_requestId.size()));
+  block.push_back(makeNonNegativeIntegerBlock(tlv::Status, static_cast<uint64_t>(m_status)));
+  if (!m_challengeType.empty()) {
+    block.push_back(makeStringBlock(tlv::SelectedChallenge, m_challengeType));
+  }
+  if (!m_challengeStatus.empty()) {
+    block.push_back(makeStringBlock(tlv::ChallengeStatus, m_challengeStatus));
+  }
+  block.push_back(makeNonNegativeIntegerBlock(tlv::RemainingTries, std::max(m_remainingTries, 0)));
+  block.push_back(makeNonNegativeIntegerBlock(TLV_SESSION_FRESH_BEFORE,
+                                              time::toUnixTimestamp(m_freshBefore).count()));
+  if (!m_issuedCertName.empty()) {
+    block.push_back(makeNestedBlock(tlv::IssuedCertName, m_issuedCertName));
+  }
+  block.push_back(makeBinaryBlock(TLV_SESSION_AES_KEY, m_aesKey.data(), m_aesKey.size()));
+  block.push_back(makeBinaryBlock(TLV_SESSION_ENCRYPTION_IV, m_encryptionIv.data(), m_encryptionIv.size()));
+  block.push_back(makeBinaryBlock(TLV_SESSION_DECRYPTION_IV, m_decryptionIv.data(), m_decryptionIv.size()));
+  block.push_back(makeNonNegativeIntegerBlock(TLV_SESSION_FLAGS,
+                                              (m_isNewlyCreatedIdentity ? SESSION_FLAG_NEW_IDENTITY : 0) |
+                                              (m_isNewlyCreatedKey ? SESSION_FLAG_NEW_KEY : 0)));
+  block.encode();
+  return block;
+}
+
+unique_ptr<Request>
+Request::decodeState(security::KeyChain& keyChain, const Block& block)
+{
+  try {
+    if (block.type() != TLV_SESSION_STATE) {
+      NDN_THROW(std::runtime_error("Unexpected TLV type " + std::to_string(block.type())));
+    }
+    block.parse();
+    auto profile = infotlv::decodeDataContent(block.get(ndn::tlv::Content));
+    auto type = static_cast<RequestType>(readNonNegativeInteger(block.get(TLV_SESSION_REQUEST_TYPE)));
+    auto request = std::make_unique<Request>(keyChain, profile, type);
+
+    request->m_identityName = Name(block.get(ndn::tlv::Name));
+    Name keyName(block.get(TLV_SESSION_KEY_NAME).blockFromValue());
+    request->m_keyPair = keyChain.getPib().getIdentity(request->m_identityName).getKey(keyName);
+
+    const auto& requestId = block.get(tlv::RequestId);
+    if (requestId.value_size() != request->m_requestId.size()) {
+      NDN_THROW(std::runtime_error("Invalid request ID"));
+    }
+    std::copy(requestId.value_begin(), requestId.value_end(), request->m_requestId.begin());
+    request->m_status = static_cast<Status>(readNonNegativeInteger(block.get(tlv::Status)));
+    auto element = block.find(tlv::SelectedChallenge);
+    if (element != block.elements_end()) {
+      request->m_challengeType = readString(*element);
+    }
+    element = block.find(tlv::ChallengeStatus);
+    if (element != block.elements_end()) {
+      request->m_challengeStatus = readString(*element);
+    }
+    request->m_remainingTries = static_cast<int>(readNonNegativeInteger(block.get(tlv::RemainingTries)));
+    request->m_freshBefore = time::fromUnixTimestamp(
+      time::milliseconds(readNonNegativeInteger(block.get(TLV_SESSION_FRESH_BEFORE))));
+    element = block.find(tlv::IssuedCertName);
+    if (element != block.elements_end()) {
+      request->m_issuedCertName = Name(element->blockFromValue());
+    }
+
+    const auto& aesKey = block.get(TLV_SESSION_AES_KEY);
+    if (aesKey.value_size() != request->m_aesKey.size()) {
+      NDN_THROW(std::runtime_error("Invalid AES key"));
+    }
+    std::copy(aesKey.value_begin(), aesKey.value_end(), request->m_aesKey.begin());
+    const auto& encryptionIv = block.get(TLV_SESSION_ENCRYPTION_IV);
+    request->m_encryptionIv.assign(encryptionIv.value_begin(), encryptionIv.value_end());
+    const auto& decryptionIv = block.get(TLV_SESSION_DECRYPTION_IV);
+    request->m_decryptionIv.assign(decryptionIv.value_begin(), decryptionIv.value_end());
+    auto flags = readNonNegativeInteger(block.get(TLV_SESSION_FLAGS));
+    request->m_isNewlyCreatedIdentity = (flags & SESSION_FLAG_NEW_IDENTITY) != 0;
+    request->m_isNewlyCreatedKey = (flags & SESSION_FLAG_NEW_KEY) != 0;
+    return request;
+  }
+  catch (const std::exception& e) {
+    NDN_THROW(std::runtime_error(std::string("Cannot decode the saved request: ") + e.what()));
+  }
+}
+
+void
+Request::saveState(const std::string& fileName) const
+{
+  auto block = encodeState();
+  auto tmpFileName = fileName + ".tmp";
+  int fd = ::open(tmpFileName.data(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  if (fd < 0) {
+    NDN_THROW(std::runtime_error("Cannot open " + tmpFileName));
+  }
+  size_t nWritten = 0;
+  while (nWritten < block.size()) {
+    auto n = ::write(fd, block.wire() + nWritten, block.size() - nWritten);
+    if (n < 0) {
+      break;
+    }
+    nWritten += static_cast<size_t>(n);
+  }
+  bool isOk = nWritten == block.size() && ::fsync(fd) == 0;
+  ::close(fd);
+  if (!isOk || std::rename(tmpFileName.data(), fileName.data()) != 0) {
+    std::remove(tmpFileName.data());
+    NDN_THROW(std::runtime_error("Cannot write the request state to " + fileName));
+  }
+}
+
+unique_ptr<Request>
+Request::loadState(security::KeyChain& keyChain, const std::string& fileName)
+{
+  std::ifstream is(fileName, std::ios::binary);
+  if (!is) {
+    NDN_THROW(std::runtime_error("Cannot open " + fileName));
+  }
+  auto buffer = make_shared<Buffer>(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+  bool isOk = false;
+  Block block;
+  std::tie(isOk, block) = Block::fromBuffer(buffer, 0);
+  if (!isOk || block.size() != buffer->size()) {
+    NDN_THROW(std::runtime_error("Cannot decode the saved request in " + fileName));
+  }
+  return decodeState(keyChain, block);
+}
+
 } // namespace requester
 } // namespace ndncert
 } // namespace ndn
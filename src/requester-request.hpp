@@ -29,6 +29,8 @@ namespace ndn {
 namespace ndncert {
 namespace requester {
 
+class KeyPairPool;
+
 class Request : noncopyable
 {
 public:
@@ -107,6 +109,18 @@ public:
   explicit
   Request(security::KeyChain& keyChain, const CaProfile& profile, RequestType requestType);
 
+  /**
+   * @brief Take the keys of newly created identities from @p keyPool instead of generating them.
+   *
+   * The key of an aborted request goes back to the pool when the session ends. The pool must
+   * outlive the request.
+   */
+  void
+  setKeyPairPool(KeyPairPool* keyPool)
+  {
+    m_keyPool = keyPool;
+  }
+
   // NEW/REVOKE/RENEW related helpers
   /**
    * @brief Generates a NEW interest to the CA.
@@ -122,6 +136,24 @@ public:
                  const time::system_clock::TimePoint& notBefore,
                  const time::system_clock::TimePoint& notAfter);
 
+  /**
+   * @brief Generates BATCH-NEW interests carrying the NEW requests of many identities at once.
+   *
+   * The requests are packed in order into as few interests as the packet size limit allows, each
+   * signed by the key of its first request.
+   *
+   * @param requests The NEW requests to the same CA, one per identity.
+   * @param identityNames The identity name to be requested by each request.
+   * @param notBefore The expected notBefore field for the certificates (starting time)
+   * @param notAfter The expected notAfter field for the certificates (expiration time)
+   * @return The interests, each with the number of requests it carries.
+   * @throw std::runtime_error if an identity name is not under the CA prefix.
+   */
+  static std::vector<std::pair<shared_ptr<Interest>, size_t>>
+  genBatchNewInterests(const std::vector<Request*>& requests, const std::vector<Name>& identityNames,
+                       const time::system_clock::TimePoint& notBefore,
+                       const time::system_clock::TimePoint& notAfter);
+
   /**
    * @brief Generates a REVOKE interest to the CA.
    *
@@ -143,6 +175,22 @@ public:
   std::list<std::string>
   onNewRenewRevokeResponse(const Data& reply);
 
+  /**
+   * @brief Decodes the replied data of a BATCH-NEW interest from the CA.
+   *
+   * Each accepted request is updated as by onNewRenewRevokeResponse(), and each rejected one is
+   * set to Status::FAILURE.
+   *
+   * @param reply The replied data from the network
+   * @param requests The requests carried by the interest, in order.
+   * @param errorInfos Set to why each request was rejected, empty for the accepted ones.
+   * @return the list of challenge accepted by the CA, for CHALLENGE step.
+   * @throw std::runtime_error if the decoding fails or receiving an error packet.
+   */
+  static std::list<std::string>
+  onBatchNewResponse(const Data& reply, const std::vector<Request*>& requests,
+                     std::vector<std::string>& errorInfos);
+
   // CHALLENGE helpers
   /**
    * @brief Generates the required parameter for the selected challenge for the request
@@ -162,7 +210,8 @@ public:
    * @param state, The requester state of the request.
    * @param parameters, The requirement list, in name, value mapping.
    * @return The shared pointer to the encoded interest
-   * @throw std::runtime_error if the challenge is not selected or is not supported.
+   * @throw std::runtime_error if the challenge is not selected or is not supported, or if the
+   *        state cannot be saved to the file set with setStateFile().
    */
   shared_ptr<Interest>
   genChallengeInterest(std::multimap<std::string, std::string>&& parameters);
@@ -203,10 +252,80 @@ public:
   void
   endSession();
 
+  // Session persistence
+  /**
+   * @brief Encodes the state of the request, so that another process can resume it.
+   *
+   * The state includes the AES key of the session and must be kept secret. The ECDH key pair is
+   * not included, so a request can only be saved once the CA has replied to its NEW, RENEW, or
+   * REVOKE interest. The encryption IV moves on with every CHALLENGE interest, and a resumed
+   * request must never reuse one, so the state has to be saved after genChallengeInterest() and
+   * before the interest is sent; setStateFile() does that automatically.
+   *
+   * @throw std::runtime_error if the CA has not replied to the request yet.
+   */
+  Block
+  encodeState() const;
+
+  /**
+   * @brief Keep the state of the request saved in @p fileName.
+   *
+   * The state is saved whenever it changes: when the CA replies to the NEW, RENEW, or REVOKE
+   * interest or to a CHALLENGE interest, and by genChallengeInterest() before the encrypted
+   * interest is returned, so a crash at any point never leads to an AES-GCM IV being reused.
+   * An empty @p fileName stops the saving.
+   */
+  void
+  setStateFile(const std::string& fileName)
+  {
+    m_stateFile = fileName;
+  }
+
+  /**
+   * @brief Restores a request encoded by encodeState().
+   *
+   * @param keyChain the KeyChain holding the key of the request
+   * @throw std::runtime_error if the state cannot be decoded or the key is not in @p keyChain.
+   */
+  static unique_ptr<Request>
+  decodeState(security::KeyChain& keyChain, const Block& block);
+
+  /**
+   * @brief Saves the state of the request to @p fileName, readable by the owner only.
+   *
+   * The file is replaced atomically and flushed to disk, so a crash leaves either the old or
+   * the new state behind.
+   *
+   * @throw std::runtime_error if the state cannot be encoded or written.
+   */
+  void
+  saveState(const std::string& fileName) const;
+
+  /**
+   * @brief Restores a request saved by saveState().
+   * @throw std::runtime_error if the file cannot be read or decoded.
+   */
+  static unique_ptr<Request>
+  loadState(security::KeyChain& keyChain, const std::string& fileName);
+
 private:
   static void
   processIfError(const Data& data);
 
+  /**
+   * @brief Generates the key pair of @p newIdentityName if needed and a self-signed certificate request.
+   */
+  security::Certificate
+  genCertRequest(const Name& newIdentityName,
+                 const time::system_clock::TimePoint& notBefore,
+                 const time::system_clock::TimePoint& notAfter);
+
+  /**
+   * @brief Derives the AES key from the CA's ECDH key and the salt.
+   */
+  void
+  deriveEncryptionKey(const std::vector<uint8_t>& ecdhKey, const std::array<uint8_t, 32>& salt);
+
 public:
   /**
    * @brief The CA profile for this request.
@@ -274,6 +393,10 @@ private:
    * @brief The local keychain to generate and install identities, keys and certificates
    */
   security::KeyChain& m_keyChain;
+  /**
+   * @brief Where the state is kept saved, empty if it is not.
+   */
+  std::string m_stateFile;
   /**
    * @brief State about how identity/key is generated.
    */
@@ -283,6 +406,7 @@ private:
    * @brief The keypair for the request.
    */
   security::Key m_keyPair;
+  KeyPairPool* m_keyPool = nullptr;
 };
 
 } // namespace requester
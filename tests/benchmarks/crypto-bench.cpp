@@ -0,0 +1,325 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/crypto-helpers.hpp"
+
+#include <ndn-cxx/util/random.hpp>
+
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <openssl/crypto.h>
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace ndn {
+namespace ndncert {
+namespace bench {
+
+using Operation = function<void()>;
+/**
+ * @brief Creates one operation with its own state for each benchmark thread.
+ */
+using OperationFactory = function<Operation(size_t payloadSize)>;
+
+struct Benchmark
+{
+  std::string name;
+  bool hasPayload;
+  OperationFactory makeOperation;
+};
+
+struct Measurement
+{
+  std::string name;
+  size_t payloadSize;
+  size_t nThreads;
+  uint64_t nOperations;
+  double nsPerOperation;     ///< average latency of one operation on one thread
+  double operationsPerSecond; ///< aggregate throughput of all threads
+};
+
+static const std::vector<size_t> PAYLOAD_SIZES = {32, 128, 512, 2048, 8192};
+static const size_t BATCH_SIZE = 4;
+
+static Measurement
+measure(const Benchmark& benchmark, size_t payloadSize, size_t nThreads, time::milliseconds duration)
+{
+  std::vector<Operation> operations;
+  for (size_t i = 0; i < nThreads; i++) {
+    operations.push_back(benchmark.makeOperation(payloadSize));
+  }
+
+  std::atomic<bool> isStopped(false);
+  std::vector<uint64_t> counts(nThreads, 0);
+  std::vector<time::nanoseconds> elapsed(nThreads, time::nanoseconds::zero());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < nThreads; i++) {
+    threads.emplace_back([&, i] {
+      auto& operation = operations[i];
+      for (size_t j = 0; j < BATCH_SIZE; j++) {
+        operation(); // warm up
+      }
+      uint64_t count = 0;
+      auto startTime = time::steady_clock::now();
+      do {
+        for (size_t j = 0; j < BATCH_SIZE; j++) {
+          operation();
+        }
+        count += BATCH_SIZE;
+      } while (!isStopped.load(std::memory_order_relaxed));
+      elapsed[i] = time::steady_clock::now() - startTime;
+      counts[i] = count;
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(duration.count()));
+  isStopped = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  Measurement result{benchmark.name, payloadSize, nThreads, 0, 0.0, 0.0};
+  for (size_t i = 0; i < nThreads; i++) {
+    result.nOperations += counts[i];
+    result.nsPerOperation += static_cast<double>(elapsed[i].count()) / counts[i] / nThreads;
+    result.operationsPerSecond += counts[i] * 1e9 / elapsed[i].count();
+  }
+  return result;
+}
+
+static std::vector<uint8_t>
+makeRandomBytes(size_t size)
+{
+  std::vector<uint8_t> bytes(size);
+  random::generateSecureBytes(bytes.data(), bytes.size());
+  return bytes;
+}
+
+/**
+ * @brief The crypto helpers, with the key, salt, and IV sizes NDNCERT uses them with.
+ */
+static std::vector<Benchmark>
+makeBenchmarks()
+{
+  std::vector<Benchmark> benchmarks;
+
+  benchmarks.push_back({"ecdh-keygen", false, [] (size_t) {
+    return [] {
+      ECDHState state;
+      state.getSelfPubKey();
+    };
+  }});
+
+  benchmarks.push_back({"ecdh-derive-secret", false, [] (size_t) {
+    auto self = make_shared<ECDHState>();
+    ECDHState peer;
+    auto peerKey = peer.getSelfPubKey();
+    return [self, peerKey] {
+      self->deriveSecret(peerKey);
+    };
+  }});
+
+  benchmarks.push_back({"hkdf", false, [] (size_t) {
+    auto secret = makeRandomBytes(32);
+    auto salt = makeRandomBytes(32);
+    auto info = makeRandomBytes(8);
+    return [secret, salt, info] {
+      uint8_t key[16];
+      hkdf(secret.data(), secret.size(), salt.data(), salt.size(), key, sizeof(key), info.data(), info.size());
+    };
+  }});
+
+  benchmarks.push_back({"hmac-sha256", true, [] (size_t payloadSize) {
+    auto data = makeRandomBytes(payloadSize);
+    auto key = makeRandomBytes(32);
+    return [data, key] {
+      uint8_t result[32];
+      hmacSha256(data.data(), data.size(), key.data(), key.size(), result);
+    };
+  }});
+
+  benchmarks.push_back({"aes-gcm-128-encrypt", true, [] (size_t payloadSize) {
+    auto plaintext = makeRandomBytes(payloadSize);
+    auto associated = makeRandomBytes(8);
+    auto key = makeRandomBytes(16);
+    auto iv = makeRandomBytes(12);
+    auto ciphertext = make_shared<std::vector<uint8_t>>(payloadSize);
+    return [=] {
+      uint8_t tag[16];
+      aesGcm128Encrypt(plaintext.data(), plaintext.size(), associated.data(), associated.size(),
+                       key.data(), iv.data(), ciphertext->data(), tag);
+    };
+  }});
+
+  benchmarks.push_back({"aes-gcm-128-decrypt", true, [] (size_t payloadSize) {
+    auto plaintext = makeRandomBytes(payloadSize);
+    auto associated = makeRandomBytes(8);
+    auto key = makeRandomBytes(16);
+    auto iv = makeRandomBytes(12);
+    std::vector<uint8_t> ciphertext(payloadSize);
+    std::array<uint8_t, 16> tag;
+    aesGcm128Encrypt(plaintext.data(), plaintext.size(), associated.data(), associated.size(),
+                     key.data(), iv.data(), ciphertext.data(), tag.data());
+    auto decrypted = make_shared<std::vector<uint8_t>>(payloadSize);
+    return [=] {
+      aesGcm128Decrypt(ciphertext.data(), ciphertext.size(), associated.data(), associated.size(),
+                       tag.data(), key.data(), iv.data(), decrypted->data());
+    };
+  }});
+
+  benchmarks.push_back({"encode-block-aes-gcm-128", true, [] (size_t payloadSize) {
+    auto payload = makeRandomBytes(payloadSize);
+    auto associated = makeRandomBytes(8);
+    auto key = makeRandomBytes(16);
+    auto initialIv = makeRandomBytes(12);
+    auto iv = make_shared<std::vector<uint8_t>>();
+    return [=] {
+      // restart the counter, so it never runs out however long the benchmark runs
+      *iv = initialIv;
+      encodeBlockWithAesGcm128(tlv::EncryptedPayload, key.data(), payload.data(), payload.size(),
+                               associated.data(), associated.size(), *iv);
+    };
+  }});
+
+  benchmarks.push_back({"decode-block-aes-gcm-128", true, [] (size_t payloadSize) {
+    auto payload = makeRandomBytes(payloadSize);
+    auto associated = makeRandomBytes(8);
+    auto key = makeRandomBytes(16);
+    std::vector<uint8_t> encryptionIv;
+    auto block = encodeBlockWithAesGcm128(tlv::EncryptedPayload, key.data(), payload.data(), payload.size(),
+                                          associated.data(), associated.size(), encryptionIv);
+    auto decryptionIv = make_shared<std::vector<uint8_t>>();
+    return [=] {
+      // the same block is decoded again and again, forget the counter of the last one
+      decryptionIv->clear();
+      decodeBlockWithAesGcm128(block, key.data(), associated.data(), associated.size(),
+                               *decryptionIv, std::vector<uint8_t>());
+    };
+  }});
+
+  return benchmarks;
+}
+
+static void
+writeJson(std::ostream& os, const std::vector<Measurement>& measurements, time::milliseconds duration)
+{
+  os << "{\n"
+     << "  \"openssl-version\": \"" << OpenSSL_version(OPENSSL_VERSION) << "\",\n"
+     << "  \"hardware-concurrency\": " << std::thread::hardware_concurrency() << ",\n"
+     << "  \"duration-ms\": " << duration.count() << ",\n"
+     << "  \"results\": [";
+  for (size_t i = 0; i < measurements.size(); i++) {
+    const auto& m = measurements[i];
+    os << (i == 0 ? "\n" : ",\n")
+       << "    {\"name\": \"" << m.name << "\", \"payload-size\": " << m.payloadSize
+       << ", \"threads\": " << m.nThreads << ", \"operations\": " << m.nOperations
+       << ", \"ns-per-op\": " << m.nsPerOperation
+       << ", \"ops-per-second\": " << m.operationsPerSecond << "}";
+  }
+  os << "\n  ]\n"
+     << "}" << std::endl;
+}
+
+static int
+main(int argc, char* argv[])
+{
+  int durationMs = 300;
+  size_t nThreads = std::max(1u, std::thread::hardware_concurrency());
+  std::string filter;
+  std::string outputFile;
+
+  namespace po = boost::program_options;
+  po::options_description optsDesc("Options");
+  optsDesc.add_options()
+  ("help,h", "print this help message and exit")
+  ("duration,d", po::value<int>(&durationMs)->default_value(durationMs), "milliseconds to run each case")
+  ("threads,t", po::value<size_t>(&nThreads)->default_value(nThreads),
+   "threads of the multi-threaded variant, the single-threaded one always runs")
+  ("filter,f", po::value<std::string>(&filter), "only run benchmarks whose name contains this string")
+  ("output,o", po::value<std::string>(&outputFile), "write the JSON results to this file instead of stdout");
+
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, optsDesc), vm);
+    po::notify(vm);
+  }
+  catch (const po::error& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 2;
+  }
+  if (vm.count("help") != 0) {
+    std::cout << "Usage: " << argv[0] << " [options]\n"
+              << "\n"
+              << optsDesc;
+    return 0;
+  }
+  if (durationMs <= 0 || nThreads == 0) {
+    std::cerr << "ERROR: duration and threads must be positive" << std::endl;
+    return 2;
+  }
+  time::milliseconds duration(durationMs);
+
+  std::vector<size_t> threadCounts{1};
+  if (nThreads > 1) {
+    threadCounts.push_back(nThreads);
+  }
+
+  std::vector<Measurement> measurements;
+  for (const auto& benchmark : makeBenchmarks()) {
+    if (benchmark.name.find(filter) == std::string::npos) {
+      continue;
+    }
+    auto payloadSizes = benchmark.hasPayload ? PAYLOAD_SIZES : std::vector<size_t>{0};
+    for (auto payloadSize : payloadSizes) {
+      for (auto threadCount : threadCounts) {
+        measurements.push_back(measure(benchmark, payloadSize, threadCount, duration));
+        // progress goes to stderr, so stdout stays valid JSON
+        std::cerr << benchmark.name << " " << payloadSize << " B x" << threadCount << ": "
+                  << measurements.back().nsPerOperation << " ns/op" << std::endl;
+      }
+    }
+  }
+
+  if (outputFile.empty()) {
+    writeJson(std::cout, measurements, duration);
+  }
+  else {
+    std::ofstream os(outputFile);
+    writeJson(os, measurements, duration);
+    if (!os) {
+      std::cerr << "ERROR: cannot write " << outputFile << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+} // namespace bench
+} // namespace ndncert
+} // namespace ndn
+
+int
+main(int argc, char* argv[])
+{
+  return ndn::ndncert::bench::main(argc, argv);
+}
@@ -0,0 +1,537 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "ca-host.hpp"
+#include "challenge/challenge-pin.hpp"
+#include "challenge/challenge-possession.hpp"
+#include "detail/ca-metrics.hpp"
+#include "requester-request.hpp"
+
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <ndn-cxx/util/dummy-client-face.hpp>
+#include <ndn-cxx/util/io.hpp>
+#include <ndn-cxx/util/signal/scoped-connection.hpp>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include <deque>
+#include <iomanip>
+#include <iostream>
+
+namespace ndn {
+namespace ndncert {
+namespace bench {
+
+using ca::LatencyHistogram;
+
+static const Name CA_PREFIX("/ndncert-bench");
+static const Name ANCHOR_IDENTITY("/ndncert-bench-anchor");
+static const Name CREDENTIAL_PREFIX("/ndncert-bench-credential");
+
+/**
+ * @brief The protocol steps of an enrollment, each one Interest/Data exchange with the CA.
+ */
+enum class Step : size_t {
+  NEW = 0,
+  CHALLENGE_SELECT = 1,
+  CHALLENGE_ANSWER = 2
+};
+
+const size_t STEP_COUNT = 3;
+
+static const std::array<std::string, STEP_COUNT> STEP_NAMES = {
+  "new", "challenge-select", "challenge-answer"
+};
+
+struct StepStatistics
+{
+  LatencyHistogram latency;
+  uint64_t nInterestBytes = 0;
+  uint64_t nDataBytes = 0;
+};
+
+struct Scenario
+{
+  std::string challenge;
+  std::string storageType;
+};
+
+/**
+ * @brief Drives a CA over a DummyClientFace with many interleaved requester sessions.
+ *
+ * The CA is hosted by a CaHost and configured through its configuration files only, as
+ * ndncert-ca-server would run it.
+ *
+ * Up to @p nConcurrent sessions are in flight at any time. The CA sees their Interests
+ * interleaved, one protocol step of one session after another, as it would from many
+ * requesters. Step latency is measured from handing the Interest to the face until the
+ * CA's reply leaves it, so it only covers CA-side processing.
+ */
+class EnrollmentBench : noncopyable
+{
+public:
+  EnrollmentBench(const Scenario& scenario, size_t nSessions, size_t nConcurrent,
+                  const boost::filesystem::path& workDir);
+
+  void
+  run();
+
+  void
+  report(std::ostream& os) const;
+
+private:
+  struct Session
+  {
+    unique_ptr<requester::Request> request;
+    Name credentialCertName;
+    Step step = Step::NEW;
+    shared_ptr<Interest> interest;
+  };
+
+  void
+  writeConfigFiles(const boost::filesystem::path& workDir);
+
+  void
+  createCredentials();
+
+  void
+  startSession(size_t index);
+
+  /**
+   * @return whether the session has finished
+   * @throw std::runtime_error the CA replied with an error or an unexpected status
+   */
+  bool
+  processResponse(Session& session, const Data& response);
+
+  void
+  finishSession(Session& session, bool isSuccessful);
+
+  void
+  pumpEvents();
+
+private:
+  Scenario m_scenario;
+  size_t m_nSessions;
+  size_t m_nConcurrent;
+  std::string m_challengeType;
+  std::string m_hostConfigPath;
+
+  boost::asio::io_service m_io;
+  security::KeyChain m_keyChain;
+  util::DummyClientFace m_face;
+  unique_ptr<ca::CaHost> m_host;
+  CaProfile m_caProfile;
+
+  std::vector<Session> m_sessions;
+  std::vector<Name> m_credentials;
+  std::array<StepStatistics, STEP_COUNT> m_steps;
+  uint64_t m_nSucceeded = 0;
+  uint64_t m_nFailed = 0;
+  std::string m_firstError;
+  time::nanoseconds m_wallTime = time::nanoseconds::zero();
+  time::nanoseconds m_caTime = time::nanoseconds::zero();
+};
+
+EnrollmentBench::EnrollmentBench(const Scenario& scenario, size_t nSessions, size_t nConcurrent,
+                                 const boost::filesystem::path& workDir)
+  : m_scenario(scenario)
+  , m_nSessions(nSessions)
+  , m_nConcurrent(std::max<size_t>(1, nConcurrent))
+  , m_challengeType(scenario.challenge == "possession" ? "Possession" : scenario.challenge)
+  , m_keyChain("pib-memory:", "tpm-memory:")
+  , m_face(m_io, m_keyChain, {false, true})
+  , m_sessions(nSessions)
+{
+  auto caIdentity = m_keyChain.createIdentity(CA_PREFIX);
+  writeConfigFiles(workDir);
+  m_host = std::make_unique<ca::CaHost>(m_face, m_keyChain, m_hostConfigPath, m_scenario.storageType);
+  pumpEvents();
+
+  m_caProfile = m_host->findCa(CA_PREFIX)->getCaConf().caProfile;
+  m_caProfile.cert = std::make_shared<security::Certificate>(caIdentity.getDefaultKey().getDefaultCertificate());
+  if (m_scenario.challenge == "possession") {
+    createCredentials();
+  }
+}
+
+void
+EnrollmentBench::writeConfigFiles(const boost::filesystem::path& workDir)
+{
+  JsonSection caConfig;
+  caConfig.put("ca-prefix", CA_PREFIX.toUri());
+  caConfig.put("ca-info", "ndncert benchmark CA");
+  caConfig.put("max-validity-period", "864000");
+  caConfig.put("max-suffix-length", "2");
+  JsonSection challenge;
+  challenge.put("challenge", m_scenario.challenge);
+  if (m_scenario.challenge == "possession") {
+    // the trust anchors of the possession challenge, written below
+    challenge.put("config", "challenge-credential.conf");
+  }
+  JsonSection challengeList;
+  challengeList.push_back(std::make_pair("", challenge));
+  caConfig.add_child("supported-challenges", challengeList);
+  boost::property_tree::write_json((workDir / "ca.conf").string(), caConfig);
+
+  // the storage is kept in the working directory, rather than under $HOME
+  JsonSection caItem;
+  caItem.put("config", "ca.conf");
+  JsonSection caList;
+  caList.push_back(std::make_pair("", caItem));
+  JsonSection hostConfig;
+  hostConfig.add_child("ca-list", caList);
+  hostConfig.put("storage-path", (workDir / "ca-storage.db").string());
+  m_hostConfigPath = (workDir / "ca-host.conf").string();
+  boost::property_tree::write_json(m_hostConfigPath, hostConfig);
+
+  if (m_scenario.challenge == "possession") {
+    auto anchor = m_keyChain.createIdentity(ANCHOR_IDENTITY).getDefaultKey().getDefaultCertificate();
+    std::ostringstream os;
+    io::save(anchor, os);
+    JsonSection anchorItem;
+    anchorItem.put("certificate", os.str());
+    JsonSection anchorList;
+    anchorList.push_back(std::make_pair("", anchorItem));
+    JsonSection credentialConfig;
+    credentialConfig.add_child("anchor-list", anchorList);
+    boost::property_tree::write_json((workDir / "challenge-credential.conf").string(), credentialConfig);
+  }
+}
+
+void
+EnrollmentBench::createCredentials()
+{
+  // credentials are set up before the clock starts, they are not part of an enrollment
+  auto now = time::system_clock::now();
+  SignatureInfo signatureInfo;
+  signatureInfo.setValidityPeriod(security::ValidityPeriod(now, now + time::days(1)));
+  auto signingInfo = security::signingByIdentity(ANCHOR_IDENTITY);
+  signingInfo.setSignatureInfo(signatureInfo);
+
+  m_credentials.reserve(m_nSessions);
+  for (size_t i = 0; i < m_nSessions; i++) {
+    auto key = m_keyChain.createIdentity(Name(CREDENTIAL_PREFIX).append(std::to_string(i))).getDefaultKey();
+    security::Certificate credential;
+    credential.setName(Name(key.getName()).append("bench-anchor").appendVersion());
+    credential.setContentType(ndn::tlv::ContentType_Key);
+    credential.setContent(key.getPublicKey().data(), key.getPublicKey().size());
+    credential.setFreshnessPeriod(time::hours(1));
+    m_keyChain.sign(credential, signingInfo);
+    m_keyChain.addCertificate(key, credential);
+    m_credentials.push_back(credential.getName());
+  }
+}
+
+void
+EnrollmentBench::pumpEvents()
+{
+  do {
+    if (m_io.stopped()) {
+      m_io.reset();
+    }
+  } while (m_io.poll() > 0);
+}
+
+void
+EnrollmentBench::startSession(size_t index)
+{
+  auto& session = m_sessions[index];
+  session.request = std::make_unique<requester::Request>(m_keyChain, m_caProfile, RequestType::NEW);
+  if (!m_credentials.empty()) {
+    session.credentialCertName = m_credentials[index];
+  }
+  auto now = time::system_clock::now();
+  session.interest = session.request->genNewInterest(Name(CA_PREFIX).append("requester-" + std::to_string(index)),
+                                                     now, now + time::days(1));
+  session.step = Step::NEW;
+}
+
+bool
+EnrollmentBench::processResponse(Session& session, const Data& response)
+{
+  auto& request = *session.request;
+  switch (session.step) {
+    case Step::NEW: {
+      request.onNewRenewRevokeResponse(response);
+      auto parameters = request.selectOrContinueChallenge(m_challengeType);
+      if (m_challengeType == "Possession") {
+        ChallengePossession::fulfillParameters(parameters, m_keyChain, session.credentialCertName,
+                                               std::array<uint8_t, 16>{});
+      }
+      session.interest = request.genChallengeInterest(std::move(parameters));
+      session.step = Step::CHALLENGE_SELECT;
+      return false;
+    }
+    case Step::CHALLENGE_SELECT: {
+      request.onChallengeResponse(response);
+      if (request.m_status != Status::CHALLENGE) {
+        NDN_THROW(std::runtime_error("Unexpected status after selecting the challenge"));
+      }
+      auto parameters = request.selectOrContinueChallenge(m_challengeType);
+      if (m_challengeType == "Possession") {
+        ChallengePossession::fulfillParameters(parameters, m_keyChain, session.credentialCertName,
+                                               request.m_nonce);
+      }
+      else {
+        // the requester would receive the PIN out of band, read it from the CA's storage instead
+        auto state = m_host->getCaStorage()->getRequest(request.m_requestId);
+        parameters.begin()->second = state.challengeState->secrets.get(ChallengePin::PARAMETER_KEY_CODE, "");
+      }
+      session.interest = request.genChallengeInterest(std::move(parameters));
+      session.step = Step::CHALLENGE_ANSWER;
+      return false;
+    }
+    case Step::CHALLENGE_ANSWER: {
+      request.onChallengeResponse(response);
+      if (request.m_status != Status::SUCCESS) {
+        NDN_THROW(std::runtime_error("Unexpected status after answering the challenge"));
+      }
+      return true;
+    }
+  }
+  return true;
+}
+
+void
+EnrollmentBench::finishSession(Session& session, bool isSuccessful)
+{
+  if (isSuccessful) {
+    m_nSucceeded++;
+    // keep the in-memory KeyChain small, the issued certificate is not installed anyway
+    try {
+      m_keyChain.deleteIdentity(m_keyChain.getPib().getIdentity(session.request->m_identityName));
+    }
+    catch (const security::Pib::Error&) {
+    }
+  }
+  else {
+    m_nFailed++;
+    session.request->endSession();
+  }
+  session.request.reset();
+  session.interest.reset();
+}
+
+void
+EnrollmentBench::run()
+{
+  optional<Data> response;
+  util::signal::ScopedConnection connection = m_face.onSendData.connect([&] (const Data& data) {
+    response = data;
+  });
+
+  std::deque<size_t> readySessions;
+  size_t nStarted = 0;
+  auto startTime = time::steady_clock::now();
+  for (; nStarted < std::min(m_nConcurrent, m_nSessions); nStarted++) {
+    startSession(nStarted);
+    readySessions.push_back(nStarted);
+  }
+
+  while (!readySessions.empty()) {
+    auto index = readySessions.front();
+    readySessions.pop_front();
+    auto& session = m_sessions[index];
+    auto& stepStatistics = m_steps[static_cast<size_t>(session.step)];
+
+    response = nullopt;
+    stepStatistics.nInterestBytes += session.interest->wireEncode().size();
+    auto sendTime = time::steady_clock::now();
+    m_face.receive(*session.interest);
+    pumpEvents();
+    auto latency = time::steady_clock::now() - sendTime;
+    m_caTime += latency;
+
+    bool isFinished = true;
+    bool isSuccessful = false;
+    if (!response) {
+      if (m_firstError.empty()) {
+        m_firstError = "The CA did not reply to " + session.interest->getName().toUri();
+      }
+    }
+    else {
+      stepStatistics.latency.record(latency);
+      stepStatistics.nDataBytes += response->wireEncode().size();
+      try {
+        isFinished = processResponse(session, *response);
+        isSuccessful = isFinished;
+      }
+      catch (const std::exception& e) {
+        if (m_firstError.empty()) {
+          m_firstError = e.what();
+        }
+      }
+    }
+
+    if (!isFinished) {
+      readySessions.push_back(index);
+      continue;
+    }
+    finishSession(session, isSuccessful);
+    if (nStarted < m_nSessions) {
+      startSession(nStarted);
+      readySessions.push_back(nStarted);
+      nStarted++;
+    }
+  }
+  m_wallTime = time::steady_clock::now() - startTime;
+}
+
+static double
+toMicroseconds(time::nanoseconds duration)
+{
+  return duration.count() / 1e3;
+}
+
+void
+EnrollmentBench::report(std::ostream& os) const
+{
+  uint64_t nRequests = 0;
+  for (const auto& step : m_steps) {
+    nRequests += step.latency.getCount();
+  }
+  double wallSeconds = m_wallTime.count() / 1e9;
+  double caSeconds = m_caTime.count() / 1e9;
+
+  os << "scenario: challenge=" << m_scenario.challenge << " storage=" << m_scenario.storageType
+     << " sessions=" << m_nSessions << " concurrency=" << m_nConcurrent << "\n"
+     << std::fixed << std::setprecision(2)
+     << "  enrolled " << m_nSucceeded << ", failed " << m_nFailed << " in " << wallSeconds << " s: "
+     << (wallSeconds > 0 ? m_nSucceeded / wallSeconds : 0) << " enrollments/s, "
+     << (wallSeconds > 0 ? nRequests / wallSeconds : 0) << " requests/s\n"
+     << "  CA busy " << caSeconds << " s: "
+     << (caSeconds > 0 ? nRequests / caSeconds : 0) << " requests/s\n";
+  if (!m_firstError.empty()) {
+    os << "  first error: " << m_firstError << "\n";
+  }
+
+  os << "  " << std::left << std::setw(18) << "step" << std::right
+     << std::setw(8) << "count" << std::setw(12) << "p50 (us)" << std::setw(12) << "p99 (us)"
+     << std::setw(12) << "p999 (us)" << std::setw(14) << "Interest (B)" << std::setw(12) << "Data (B)"
+     << std::setw(14) << "total (KiB)" << "\n";
+  for (size_t i = 0; i < STEP_COUNT; i++) {
+    const auto& step = m_steps[i];
+    auto count = step.latency.getCount();
+    os << "  " << std::left << std::setw(18) << STEP_NAMES[i] << std::right
+       << std::setw(8) << count
+       << std::setw(12) << toMicroseconds(step.latency.getPercentile(0.5))
+       << std::setw(12) << toMicroseconds(step.latency.getPercentile(0.99))
+       << std::setw(12) << toMicroseconds(step.latency.getPercentile(0.999))
+       << std::setw(14) << (count > 0 ? static_cast<double>(step.nInterestBytes) / count : 0)
+       << std::setw(12) << (count > 0 ? static_cast<double>(step.nDataBytes) / count : 0)
+       << std::setw(14) << (step.nInterestBytes + step.nDataBytes) / 1024.0 << "\n";
+  }
+  os << std::endl;
+}
+
+static std::vector<std::string>
+expandChoice(const std::string& value, const std::vector<std::string>& choices)
+{
+  if (value == "all") {
+    return choices;
+  }
+  if (std::find(choices.begin(), choices.end(), value) == choices.end()) {
+    NDN_THROW(std::invalid_argument("Unknown choice: " + value));
+  }
+  return {value};
+}
+
+static int
+main(int argc, char* argv[])
+{
+  size_t nSessions = 2000;
+  size_t nConcurrent = 500;
+  std::string challenge = "all";
+  std::string storage = "all";
+
+  namespace po = boost::program_options;
+  po::options_description optsDesc("Options");
+  optsDesc.add_options()
+  ("help,h", "print this help message and exit")
+  ("sessions,n", po::value<size_t>(&nSessions)->default_value(nSessions), "number of enrollments per scenario")
+  ("concurrency,c", po::value<size_t>(&nConcurrent)->default_value(nConcurrent),
+   "number of enrollments in flight at the same time")
+  ("challenge", po::value<std::string>(&challenge)->default_value(challenge), "pin, possession, or all")
+  ("storage", po::value<std::string>(&storage)->default_value(storage), "memory, sqlite, or all");
+
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, optsDesc), vm);
+    po::notify(vm);
+  }
+  catch (const po::error& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 2;
+  }
+  if (vm.count("help") != 0) {
+    std::cout << "Usage: " << argv[0] << " [options]\n"
+              << "\n"
+              << optsDesc;
+    return 0;
+  }
+
+  std::vector<Scenario> scenarios;
+  try {
+    for (const auto& challengeType : expandChoice(challenge, {"pin", "possession"})) {
+      for (const auto& storageType : expandChoice(storage, {"memory", "sqlite"})) {
+        scenarios.push_back({challengeType, storageType == "memory" ? "ca-storage-memory" : "ca-storage-sqlite3"});
+      }
+    }
+  }
+  catch (const std::invalid_argument& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 2;
+  }
+
+  // the storage and the configuration files of the CA are kept in a scratch directory
+  auto workDir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("ndncert-bench-%%%%-%%%%");
+  boost::filesystem::create_directories(workDir);
+
+  int exitCode = 0;
+  for (const auto& scenario : scenarios) {
+    boost::filesystem::remove(workDir / "ca-storage.db");
+    try {
+      EnrollmentBench bench(scenario, nSessions, nConcurrent, workDir);
+      bench.run();
+      bench.report(std::cout);
+    }
+    catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      exitCode = 1;
+    }
+  }
+  boost::filesystem::remove_all(workDir);
+  return exitCode;
+}
+
+} // namespace bench
+} // namespace ndncert
+} // namespace ndn
+
+int
+main(int argc, char* argv[])
+{
+  return ndn::ndncert::bench::main(argc, argv);
+}
@@ -0,0 +1,438 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/ca-metrics.hpp"
+#include "detail/ca-storage.hpp"
+
+#include <ndn-cxx/util/random.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+
+#include <unistd.h>
+
+namespace ndn {
+namespace ndncert {
+namespace bench {
+
+using ca::CaStorage;
+using ca::ChallengeState;
+using ca::LatencyHistogram;
+using ca::RequestState;
+
+static const Name CA_PREFIX("/ndncert-bench");
+static const size_t PREFILL_BATCH_SIZE = 1000;
+
+enum class StorageOperation : size_t {
+  ADD = 0,
+  GET = 1,
+  UPDATE = 2,
+  DELETE = 3,
+  LIST = 4
+};
+
+const size_t STORAGE_OPERATION_COUNT = 5;
+
+static const std::array<std::string, STORAGE_OPERATION_COUNT> OPERATION_NAMES = {
+  "add", "get", "update", "delete", "list"
+};
+
+struct WorkloadOptions
+{
+  size_t nThreads = 4;
+  uint64_t nRows = 10000;
+  time::seconds duration = time::seconds(30);
+  time::seconds reportInterval = time::seconds(5);
+  size_t nChallengeRounds = 2;
+  double listProbability = 0.0001;
+};
+
+/**
+ * @brief Replays the request lifecycle of a CA against a CaStorage backend.
+ *
+ * The storage is first filled with @c nRows pending requests, as left behind by requesters that
+ * never finish. Then every thread repeatedly runs the lifecycle of one enrollment: add on NEW,
+ * a get and an update per CHALLENGE round, and a get and a delete on completion. Occasionally
+ * all requests are listed, as ndncert-ca-status does.
+ *
+ * The threads call the storage directly, as the worker threads of the CA do, so the results
+ * include any contention within the backend itself, e.g., on the write lock of CaSqlite.
+ */
+class StorageBench : noncopyable
+{
+public:
+  StorageBench(CaStorage& storage, const WorkloadOptions& options, const security::Certificate& cert,
+               const std::string& dbPath);
+
+  void
+  prefill();
+
+  void
+  run();
+
+private:
+  RequestState
+  makeRequest(uint64_t sequence) const;
+
+  template<typename Func>
+  void
+  timed(StorageOperation operation, const Func& func);
+
+  void
+  runWorker(size_t threadIndex);
+
+  void
+  printHeader() const;
+
+  void
+  printReport(time::nanoseconds elapsed, uint64_t nIntervalOperations) const;
+
+  uint64_t
+  getTotalOperations() const;
+
+private:
+  CaStorage& m_storage;
+  WorkloadOptions m_options;
+  security::Certificate m_cert;
+  std::string m_dbPath;
+  std::array<LatencyHistogram, STORAGE_OPERATION_COUNT> m_latency;
+  std::atomic<uint64_t> m_nextSequence;
+  std::atomic<bool> m_isStopped;
+};
+
+StorageBench::StorageBench(CaStorage& storage, const WorkloadOptions& options,
+                           const security::Certificate& cert, const std::string& dbPath)
+  : m_storage(storage)
+  , m_options(options)
+  , m_cert(cert)
+  , m_dbPath(dbPath)
+  // a random start keeps the request IDs unique when an existing database is reused
+  , m_nextSequence(random::generateWord64() >> 1)
+  , m_isStopped(false)
+{
+}
+
+RequestState
+StorageBench::makeRequest(uint64_t sequence) const
+{
+  RequestState request;
+  request.caPrefix = CA_PREFIX;
+  // the CA uses HMAC outputs of the same size, so the ID is random but for its last 8 bytes,
+  // which hold the sequence number to keep the IDs unique without a lookup
+  const size_t nSequenceBytes = sizeof(sequence);
+  const size_t nRandomBytes = request.requestId.size() - nSequenceBytes;
+  random::generateSecureBytes(request.requestId.data(), nRandomBytes);
+  for (size_t i = 0; i < nSequenceBytes; i++) {
+    request.requestId[nRandomBytes + i] = static_cast<uint8_t>(sequence >> (8 * (nSequenceBytes - 1 - i)));
+  }
+  request.requestType = RequestType::NEW;
+  request.cert = m_cert;
+  random::generateSecureBytes(request.encryptionKey.data(), request.encryptionKey.size());
+  request.encryptionIv.resize(12);
+  request.decryptionIv.resize(12);
+  random::generateSecureBytes(request.encryptionIv.data(), request.encryptionIv.size());
+  random::generateSecureBytes(request.decryptionIv.data(), request.decryptionIv.size());
+  return request;
+}
+
+template<typename Func>
+void
+StorageBench::timed(StorageOperation operation, const Func& func)
+{
+  auto startTime = time::steady_clock::now();
+  func();
+  m_latency[static_cast<size_t>(operation)].record(time::steady_clock::now() - startTime);
+}
+
+void
+StorageBench::prefill()
+{
+  auto startTime = time::steady_clock::now();
+  // the rows are added in batches, each in one transaction, so that filling a large database
+  // takes a fraction of the time of the measured run
+  std::vector<RequestState> batch;
+  batch.reserve(PREFILL_BATCH_SIZE);
+  for (uint64_t i = 0; i < m_options.nRows; i++) {
+    auto request = makeRequest(m_nextSequence++);
+    request.status = Status::CHALLENGE;
+    request.challengeType = "pin";
+    JsonSection secrets;
+    secrets.add("code", "123456");
+    request.challengeState = ChallengeState("need-code", time::system_clock::now(), 3,
+                                            time::seconds(3600), std::move(secrets));
+    batch.push_back(std::move(request));
+    if (batch.size() == PREFILL_BATCH_SIZE || i + 1 == m_options.nRows) {
+      m_storage.addRequests(batch);
+      batch.clear();
+    }
+    if ((i + 1) % 100000 == 0) {
+      std::cerr << "prefilled " << (i + 1) << " rows" << std::endl;
+    }
+  }
+  std::cerr << "prefilled " << m_options.nRows << " rows in "
+            << time::duration_cast<time::milliseconds>(time::steady_clock::now() - startTime) << std::endl;
+}
+
+void
+StorageBench::runWorker(size_t threadIndex)
+{
+  std::mt19937_64 generator(random::generateWord64() + threadIndex);
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+  while (!m_isStopped.load(std::memory_order_relaxed)) {
+    auto request = makeRequest(m_nextSequence++);
+    timed(StorageOperation::ADD, [&] { m_storage.addRequest(request); });
+
+    for (size_t round = 0; round < m_options.nChallengeRounds; round++) {
+      timed(StorageOperation::GET, [&] { request = m_storage.getRequest(request.requestId); });
+      request.status = Status::CHALLENGE;
+      request.challengeType = "pin";
+      JsonSection secrets;
+      secrets.add("code", std::to_string(round));
+      request.challengeState = ChallengeState("need-code", time::system_clock::now(),
+                                              m_options.nChallengeRounds - round, time::seconds(300),
+                                              std::move(secrets));
+      timed(StorageOperation::UPDATE, [&] { m_storage.updateRequest(request); });
+    }
+
+    timed(StorageOperation::GET, [&] { request = m_storage.getRequest(request.requestId); });
+    timed(StorageOperation::DELETE, [&] { m_storage.deleteRequest(request.requestId); });
+
+    if (distribution(generator) < m_options.listProbability) {
+      timed(StorageOperation::LIST, [&] { m_storage.listAllRequests(CA_PREFIX); });
+    }
+  }
+}
+
+static uint64_t
+getResidentSetSize()
+{
+  std::ifstream statm("/proc/self/statm");
+  uint64_t size = 0;
+  uint64_t resident = 0;
+  if (!(statm >> size >> resident)) {
+    return 0;
+  }
+  return resident * static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+}
+
+static uint64_t
+getOnDiskSize(const std::string& dbPath)
+{
+  if (dbPath.empty()) {
+    return 0;
+  }
+  uint64_t total = 0;
+  for (const auto& suffix : {"", "-journal", "-wal", "-shm"}) {
+    boost::system::error_code error;
+    auto size = boost::filesystem::file_size(dbPath + suffix, error);
+    if (!error) {
+      total += size;
+    }
+  }
+  return total;
+}
+
+uint64_t
+StorageBench::getTotalOperations() const
+{
+  uint64_t total = 0;
+  for (const auto& histogram : m_latency) {
+    total += histogram.getCount();
+  }
+  return total;
+}
+
+void
+StorageBench::printHeader() const
+{
+  std::cout << std::setw(8) << "time (s)" << std::setw(12) << "ops/s";
+  for (const auto& name : OPERATION_NAMES) {
+    std::cout << std::setw(12) << (name + " p99") << std::setw(12) << (name + " p999");
+  }
+  std::cout << std::setw(12) << "RSS (MiB)" << std::setw(12) << "disk (MiB)" << "  (latency in us)" << std::endl;
+}
+
+void
+StorageBench::printReport(time::nanoseconds elapsed, uint64_t nIntervalOperations) const
+{
+  std::cout << std::fixed << std::setprecision(1)
+            << std::setw(8) << elapsed.count() / 1e9
+            << std::setw(12) << nIntervalOperations / static_cast<double>(m_options.reportInterval.count());
+  for (const auto& histogram : m_latency) {
+    std::cout << std::setw(12) << histogram.getPercentile(0.99).count() / 1e3
+              << std::setw(12) << histogram.getPercentile(0.999).count() / 1e3;
+  }
+  std::cout << std::setw(12) << getResidentSetSize() / 1048576.0
+            << std::setw(12) << getOnDiskSize(m_dbPath) / 1048576.0 << std::endl;
+}
+
+void
+StorageBench::run()
+{
+  printHeader();
+  auto startTime = time::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < m_options.nThreads; i++) {
+    threads.emplace_back([this, i] {
+      try {
+        runWorker(i);
+      }
+      catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        m_isStopped = true;
+      }
+    });
+  }
+
+  uint64_t nLastOperations = 0;
+  auto elapsed = time::nanoseconds::zero();
+  while (elapsed < m_options.duration && !m_isStopped) {
+    std::this_thread::sleep_for(std::chrono::seconds(m_options.reportInterval.count()));
+    elapsed = time::steady_clock::now() - startTime;
+    auto nOperations = getTotalOperations();
+    printReport(elapsed, nOperations - nLastOperations);
+    nLastOperations = nOperations;
+  }
+  m_isStopped = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  elapsed = time::steady_clock::now() - startTime;
+
+  std::cout << "\nsummary: " << getTotalOperations() << " operations in " << elapsed.count() / 1e9 << " s, "
+            << getTotalOperations() / (elapsed.count() / 1e9) << " ops/s\n"
+            << std::setw(8) << "op" << std::setw(12) << "count" << std::setw(12) << "p50 (us)"
+            << std::setw(12) << "p99 (us)" << std::setw(12) << "p999 (us)" << std::setw(12) << "max (us)" << "\n";
+  for (size_t i = 0; i < STORAGE_OPERATION_COUNT; i++) {
+    const auto& histogram = m_latency[i];
+    std::cout << std::setw(8) << OPERATION_NAMES[i] << std::setw(12) << histogram.getCount()
+              << std::setw(12) << histogram.getPercentile(0.5).count() / 1e3
+              << std::setw(12) << histogram.getPercentile(0.99).count() / 1e3
+              << std::setw(12) << histogram.getPercentile(0.999).count() / 1e3
+              << std::setw(12) << histogram.getMax().count() / 1e3 << "\n";
+  }
+  std::cout << std::flush;
+}
+
+static int
+main(int argc, char* argv[])
+{
+  WorkloadOptions options;
+  std::string storageType = "ca-storage-sqlite3";
+  std::string dbPath;
+  int durationSeconds = options.duration.count();
+  int intervalSeconds = options.reportInterval.count();
+
+  namespace po = boost::program_options;
+  po::options_description optsDesc("Options");
+  optsDesc.add_options()
+  ("help,h", "print this help message and exit")
+  ("storage,s", po::value<std::string>(&storageType)->default_value(storageType),
+   "registered CaStorage type, e.g., ca-storage-sqlite3 or ca-storage-memory")
+  ("path,p", po::value<std::string>(&dbPath),
+   "database file of the storage, a temporary file by default; an existing file is reused")
+  ("threads,t", po::value<size_t>(&options.nThreads)->default_value(options.nThreads), "concurrent clients")
+  ("rows,r", po::value<uint64_t>(&options.nRows)->default_value(options.nRows),
+   "pending requests inserted before the measurement")
+  ("duration,d", po::value<int>(&durationSeconds)->default_value(durationSeconds), "seconds to run")
+  ("interval,i", po::value<int>(&intervalSeconds)->default_value(intervalSeconds), "seconds between reports")
+  ("challenge-rounds", po::value<size_t>(&options.nChallengeRounds)->default_value(options.nChallengeRounds),
+   "get/update pairs per enrollment")
+  ("list-probability", po::value<double>(&options.listProbability)->default_value(options.listProbability),
+   "probability of listing all requests after an enrollment");
+
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, optsDesc), vm);
+    po::notify(vm);
+  }
+  catch (const po::error& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 2;
+  }
+  if (vm.count("help") != 0) {
+    std::cout << "Usage: " << argv[0] << " [options]\n"
+              << "\n"
+              << optsDesc;
+    return 0;
+  }
+  if (durationSeconds <= 0 || intervalSeconds <= 0 || options.nThreads == 0) {
+    std::cerr << "ERROR: duration, interval, and threads must be positive" << std::endl;
+    return 2;
+  }
+  options.duration = time::seconds(durationSeconds);
+  options.reportInterval = time::seconds(intervalSeconds);
+
+  bool isTemporaryPath = false;
+  if (dbPath.empty()) {
+    dbPath = (boost::filesystem::temp_directory_path() /
+              boost::filesystem::unique_path("ndncert-bench-storage-%%%%-%%%%.db")).string();
+    isTemporaryPath = true;
+  }
+
+  int exitCode = 0;
+  try {
+    auto storage = CaStorage::createCaStorage(storageType, CA_PREFIX, dbPath);
+    if (storage == nullptr) {
+      std::cerr << "ERROR: unknown storage type " << storageType << std::endl;
+      return 2;
+    }
+
+    // a realistic certificate request, as carried by NEW
+    security::KeyChain keyChain("pib-memory:", "tpm-memory:");
+    auto cert = keyChain.createIdentity(Name(CA_PREFIX).append("requester")).getDefaultKey().getDefaultCertificate();
+
+    StorageBench bench(*storage, options, cert, storageType == "ca-storage-memory" ? "" : dbPath);
+    bench.prefill();
+    bench.run();
+  }
+  catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    exitCode = 1;
+  }
+
+  if (isTemporaryPath) {
+    for (const auto& suffix : {"", "-journal", "-wal", "-shm"}) {
+      boost::system::error_code error;
+      boost::filesystem::remove(dbPath + suffix, error);
+    }
+  }
+  return exitCode;
+}
+
+} // namespace bench
+} // namespace ndncert
+} // namespace ndn
+
+int
+main(int argc, char* argv[])
+{
+  return ndn::ndncert::bench::main(argc, argv);
+}
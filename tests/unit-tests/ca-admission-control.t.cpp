@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "ca-module.hpp"
+#include "detail/ca-admission-control.hpp"
+#include "test-common.hpp"
+
+namespace ndn {
+namespace ndncert {
+namespace tests {
+
+using namespace ca;
+
+BOOST_FIXTURE_TEST_SUITE(TestCaAdmissionControl, IdentityManagementTimeFixture)
+
+BOOST_AUTO_TEST_CASE(UnlimitedByDefault)
+{
+  AdmissionController controller;
+  for (int i = 0; i < 1000; i++) {
+    BOOST_CHECK(controller.admit(AdmissionEndpoint::NEW));
+  }
+  BOOST_CHECK_EQUAL(controller.getAdmittedCount(AdmissionEndpoint::NEW), 1000);
+  BOOST_CHECK_EQUAL(controller.getShedCount(AdmissionEndpoint::NEW), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TokenBucketRefill)
+{
+  AdmissionPolicy policy;
+  policy.limits[static_cast<size_t>(AdmissionEndpoint::PROBE)] = {10.0, 5.0};
+  AdmissionController controller;
+  controller.setPolicy(policy);
+
+  for (int i = 0; i < 5; i++) {
+    BOOST_CHECK(controller.admit(AdmissionEndpoint::PROBE));
+  }
+  BOOST_CHECK(!controller.admit(AdmissionEndpoint::PROBE));
+  // other endpoints are not affected
+  BOOST_CHECK(controller.admit(AdmissionEndpoint::NEW));
+
+  advanceClocks(time::milliseconds(100));
+  BOOST_CHECK(controller.admit(AdmissionEndpoint::PROBE));
+  BOOST_CHECK(!controller.admit(AdmissionEndpoint::PROBE));
+
+  // refill never exceeds the burst size
+  advanceClocks(time::seconds(10));
+  for (int i = 0; i < 5; i++) {
+    BOOST_CHECK(controller.admit(AdmissionEndpoint::PROBE));
+  }
+  BOOST_CHECK(!controller.admit(AdmissionEndpoint::PROBE));
+
+  BOOST_CHECK_EQUAL(controller.getAdmittedCount(AdmissionEndpoint::PROBE), 11);
+  BOOST_CHECK_EQUAL(controller.getShedCount(AdmissionEndpoint::PROBE), 3);
+}
+
+BOOST_AUTO_TEST_CASE(ChallengePriority)
+{
+  AdmissionPolicy policy;
+  policy.limits[static_cast<size_t>(AdmissionEndpoint::NEW)] = {1.0, 2.0};
+  policy.limits[static_cast<size_t>(AdmissionEndpoint::CHALLENGE)] = {1.0, 1.0};
+  AdmissionController controller;
+  controller.setPolicy(policy);
+
+  // CHALLENGE borrows from the NEW bucket once its own bucket is empty
+  BOOST_CHECK(controller.admit(AdmissionEndpoint::CHALLENGE));
+  BOOST_CHECK(controller.admit(AdmissionEndpoint::CHALLENGE));
+  BOOST_CHECK(controller.admit(AdmissionEndpoint::CHALLENGE));
+  BOOST_CHECK(!controller.admit(AdmissionEndpoint::NEW));
+  BOOST_CHECK(!controller.admit(AdmissionEndpoint::CHALLENGE));
+
+  BOOST_CHECK_EQUAL(controller.getAdmittedCount(AdmissionEndpoint::CHALLENGE), 3);
+  BOOST_CHECK_EQUAL(controller.getShedCount(AdmissionEndpoint::CHALLENGE), 1);
+  BOOST_CHECK_EQUAL(controller.getShedCount(AdmissionEndpoint::NEW), 1);
+}
+
+BOOST_AUTO_TEST_CASE(ChallengeLimitOnly)
+{
+  AdmissionPolicy policy;
+  policy.limits[static_cast<size_t>(AdmissionEndpoint::CHALLENGE)] = {1.0, 2.0};
+  AdmissionController controller;
+  controller.setPolicy(policy);
+
+  // an unlimited NEW bucket lends nothing
+  BOOST_CHECK(controller.admit(AdmissionEndpoint::CHALLENGE));
+  BOOST_CHECK(controller.admit(AdmissionEndpoint::CHALLENGE));
+  BOOST_CHECK(!controller.admit(AdmissionEndpoint::CHALLENGE));
+  BOOST_CHECK(controller.admit(AdmissionEndpoint::NEW));
+
+  BOOST_CHECK_EQUAL(controller.getAdmittedCount(AdmissionEndpoint::CHALLENGE), 2);
+  BOOST_CHECK_EQUAL(controller.getShedCount(AdmissionEndpoint::CHALLENGE), 1);
+}
+
+BOOST_AUTO_TEST_CASE(BatchCost)
+{
+  AdmissionPolicy policy;
+  policy.limits[static_cast<size_t>(AdmissionEndpoint::NEW)] = {1.0, 3.0};
+  AdmissionController controller;
+  controller.setPolicy(policy);
+
+  // a batch pays for all its entries at once, or is shed without taking any token
+  BOOST_CHECK(controller.admit(AdmissionEndpoint::NEW, 3));
+  BOOST_CHECK(!controller.admit(AdmissionEndpoint::NEW));
+  advanceClocks(time::seconds(2));
+  BOOST_CHECK(!controller.admit(AdmissionEndpoint::NEW, 3));
+  BOOST_CHECK(controller.admit(AdmissionEndpoint::NEW, 2));
+}
+
+BOOST_AUTO_TEST_CASE(BatchLargerThanBurst)
+{
+  AdmissionPolicy policy;
+  policy.limits[static_cast<size_t>(AdmissionEndpoint::NEW)] = {1.0, 3.0};
+  AdmissionController controller;
+  controller.setPolicy(policy);
+
+  // a batch with more entries than the burst takes a full bucket, even on an idle CA
+  BOOST_CHECK(controller.admit(AdmissionEndpoint::NEW));
+  BOOST_CHECK(!controller.admit(AdmissionEndpoint::NEW, 10));
+  advanceClocks(time::seconds(1));
+  BOOST_CHECK(controller.admit(AdmissionEndpoint::NEW, 10));
+  BOOST_CHECK(!controller.admit(AdmissionEndpoint::NEW));
+  BOOST_CHECK_EQUAL(controller.getAdmittedCount(AdmissionEndpoint::NEW), 2);
+  BOOST_CHECK_EQUAL(controller.getShedCount(AdmissionEndpoint::NEW), 2);
+}
+
+BOOST_AUTO_TEST_CASE(PolicyReload)
+{
+  AdmissionPolicy policy;
+  policy.limits[static_cast<size_t>(AdmissionEndpoint::NEW)] = {1.0, 3.0};
+  AdmissionController controller;
+  controller.setPolicy(policy);
+
+  // reapplying the policy does not refill an empty bucket
+  BOOST_CHECK(controller.admit(AdmissionEndpoint::NEW, 3));
+  controller.setPolicy(policy);
+  BOOST_CHECK(!controller.admit(AdmissionEndpoint::NEW));
+
+  // a changed limit keeps the tokens left, up to the new burst
+  advanceClocks(time::seconds(3));
+  policy.limits[static_cast<size_t>(AdmissionEndpoint::NEW)] = {2.0, 2.0};
+  controller.setPolicy(policy);
+  BOOST_CHECK(controller.admit(AdmissionEndpoint::NEW, 2));
+  BOOST_CHECK(!controller.admit(AdmissionEndpoint::NEW));
+
+  // an endpoint that was not limited starts with a full bucket
+  policy.limits[static_cast<size_t>(AdmissionEndpoint::PROBE)] = {1.0, 2.0};
+  controller.setPolicy(policy);
+  BOOST_CHECK(controller.admit(AdmissionEndpoint::PROBE, 2));
+  BOOST_CHECK(!controller.admit(AdmissionEndpoint::PROBE));
+}
+
+BOOST_AUTO_TEST_CASE(PolicyFromJson)
+{
+  JsonSection json;
+  json.put("action", "drop");
+  json.put("new.rate", "20");
+  json.put("new.burst", "40");
+  auto policy = AdmissionPolicy::fromJson(json);
+  BOOST_CHECK(policy.shedAction == ShedAction::DROP);
+  BOOST_CHECK_EQUAL(policy.limits[static_cast<size_t>(AdmissionEndpoint::NEW)].rate, 20.0);
+  BOOST_CHECK_EQUAL(policy.limits[static_cast<size_t>(AdmissionEndpoint::NEW)].burst, 40.0);
+  BOOST_CHECK_EQUAL(policy.limits[static_cast<size_t>(AdmissionEndpoint::PROBE)].rate, 0.0);
+
+  json.put("action", "reject");
+  BOOST_CHECK_THROW(AdmissionPolicy::fromJson(json), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(ShedWithNack)
+{
+  addIdentity(Name("/ndn"));
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaModule ca(face, m_keyChain, "tests/unit-tests/config-files/config-ca-7", "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+
+  Block paramTLV = makeEmptyBlock(ndn::tlv::ApplicationParameters);
+  paramTLV.push_back(makeStringBlock(tlv::ParameterKey, "name"));
+  paramTLV.push_back(makeStringBlock(tlv::ParameterValue, "zhiyi"));
+  paramTLV.encode();
+
+  for (int i = 0; i < 3; i++) {
+    Interest interest("/ndn/CA/PROBE");
+    interest.setCanBePrefix(false);
+    interest.setApplicationParameters(paramTLV);
+    face.receive(interest);
+  }
+  advanceClocks(time::milliseconds(20), 10);
+
+  BOOST_CHECK_EQUAL(face.sentData.size(), 2);
+  BOOST_REQUIRE_EQUAL(face.sentNacks.size(), 1);
+  BOOST_CHECK_EQUAL(face.sentNacks.front().getReason(), lp::NackReason::CONGESTION);
+  BOOST_CHECK_EQUAL(ca.getAdmissionController().getAdmittedCount(AdmissionEndpoint::PROBE), 2);
+  BOOST_CHECK_EQUAL(ca.getAdmissionController().getShedCount(AdmissionEndpoint::PROBE), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // TestCaAdmissionControl
+
+} // namespace tests
+} // namespace ndncert
+} // namespace ndn
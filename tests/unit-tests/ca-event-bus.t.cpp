@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/ca-audit-log.hpp"
+#include "detail/ca-event-bus.hpp"
+#include "test-common.hpp"
+
+#include <condition_variable>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace ndn {
+namespace ndncert {
+namespace tests {
+
+using namespace ca;
+
+static RequestState
+makeRequestState(uint8_t id)
+{
+  RequestState request;
+  request.caPrefix = Name("/ndn");
+  request.requestId = {0, 0, 0, 0, 0, 0, 0, id};
+  request.requestType = RequestType::NEW;
+  request.status = Status::CHALLENGE;
+  return request;
+}
+
+BOOST_FIXTURE_TEST_SUITE(TestEventBus, DatabaseFixture)
+
+BOOST_AUTO_TEST_CASE(MultipleSubscribers)
+{
+  EventBus bus;
+  std::vector<uint8_t> first;
+  std::vector<uint8_t> second;
+  auto firstId = bus.subscribe([&] (const StatusEvent& event) { first.push_back(event.request.requestId[7]); });
+  auto secondId = bus.subscribe([&] (const StatusEvent& event) { second.push_back(event.request.requestId[7]); });
+  BOOST_CHECK_EQUAL(bus.getSubscriberCount(), 2);
+
+  for (uint8_t i = 0; i < 100; i++) {
+    bus.publish(makeRequestState(i));
+  }
+  // queued events are delivered before a subscriber stops
+  bus.unsubscribe(firstId);
+  bus.unsubscribe(secondId);
+  BOOST_CHECK_EQUAL(bus.getSubscriberCount(), 0);
+  bus.publish(makeRequestState(100));
+
+  BOOST_REQUIRE_EQUAL(first.size(), 100);
+  BOOST_REQUIRE_EQUAL(second.size(), 100);
+  for (uint8_t i = 0; i < 100; i++) {
+    BOOST_CHECK_EQUAL(first[i], i);
+    BOOST_CHECK_EQUAL(second[i], i);
+  }
+  BOOST_CHECK_EQUAL(bus.getDroppedCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(OverflowPolicies)
+{
+  EventBus bus;
+  std::mutex mutex;
+  std::condition_variable released;
+  bool isReleased = false;
+  size_t nDelivered = 0;
+  SubscriptionOptions dropOptions;
+  dropOptions.queueCapacity = 4;
+  auto dropId = bus.subscribe([&] (const StatusEvent&) {
+    std::unique_lock<std::mutex> lock(mutex);
+    released.wait(lock, [&] { return isReleased; });
+    nDelivered++;
+  }, dropOptions);
+
+  std::atomic<size_t> nBlockDelivered(0);
+  SubscriptionOptions blockOptions;
+  blockOptions.queueCapacity = 2;
+  blockOptions.overflowPolicy = OverflowPolicy::BLOCK;
+  auto blockId = bus.subscribe([&] (const StatusEvent&) {
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+    nBlockDelivered++;
+  }, blockOptions);
+
+  // the stalled subscriber loses what does not fit in its queue, the other one slows publishing down
+  for (uint8_t i = 0; i < 20; i++) {
+    bus.publish(makeRequestState(i));
+  }
+  BOOST_CHECK_GE(bus.getDroppedCount(), 20 - 4 - 1);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    isReleased = true;
+  }
+  released.notify_all();
+  bus.unsubscribe(dropId);
+  bus.unsubscribe(blockId);
+  BOOST_CHECK_EQUAL(nDelivered + bus.getDroppedCount(), 20);
+  BOOST_CHECK_EQUAL(nBlockDelivered.load(), 20);
+}
+
+BOOST_AUTO_TEST_CASE(AuditLog)
+{
+  auto fileName = (dbDir / "audit.log").string();
+  {
+    EventBus bus;
+    AuditLogWriter::attach(bus, fileName);
+    bus.publish(makeRequestState(1));
+    auto request = makeRequestState(2);
+    request.status = Status::SUCCESS;
+    request.challengeType = "pin";
+    request.challengeState = ChallengeState("need \"code\"\n", time::system_clock::now(), 3,
+                                            time::seconds(3600), JsonSection());
+    request.cert.setName(Name("/ndn/alice/KEY/1/self/v=1"));
+    bus.publish(request);
+  }
+
+  std::ifstream is(fileName);
+  std::vector<JsonSection> records;
+  std::string line;
+  while (std::getline(is, line)) {
+    std::istringstream ss(line);
+    JsonSection record;
+    boost::property_tree::read_json(ss, record);
+    records.push_back(record);
+  }
+  BOOST_REQUIRE_EQUAL(records.size(), 2);
+  BOOST_CHECK_EQUAL(records[0].get<std::string>("ca"), "/ndn");
+  BOOST_CHECK_EQUAL(records[0].get<std::string>("request"), "0000000000000001");
+  BOOST_CHECK_EQUAL(records[0].get<std::string>("status"), statusToString(Status::CHALLENGE));
+  BOOST_CHECK_EQUAL(records[1].get<std::string>("type"), "New");
+  BOOST_CHECK_EQUAL(records[1].get<std::string>("status"), statusToString(Status::SUCCESS));
+  BOOST_CHECK_EQUAL(records[1].get<std::string>("challenge"), "pin");
+  BOOST_CHECK_EQUAL(records[1].get<std::string>("challenge-status"), "need \"code\"\n");
+  BOOST_CHECK_EQUAL(records[1].get<std::string>("certificate"), "/ndn/alice/KEY/1/self/v=1");
+  BOOST_CHECK_GT(records[1].get<uint64_t>("time"), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestEventBus
+
+} // namespace tests
+} // namespace ndncert
+} // namespace ndn
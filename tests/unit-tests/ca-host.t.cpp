@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "ca-host.hpp"
+#include "detail/probe-encoder.hpp"
+#include "requester-request.hpp"
+#include "test-common.hpp"
+
+namespace ndn {
+namespace ndncert {
+namespace tests {
+
+using namespace ca;
+
+BOOST_FIXTURE_TEST_SUITE(TestCaHost, IdentityManagementTimeFixture)
+
+BOOST_AUTO_TEST_CASE(LongestPrefixMatch)
+{
+  addIdentity(Name("/ndn"));
+  addIdentity(Name("/ndn/site1"));
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaHost host(face, m_keyChain, "tests/unit-tests/config-files/config-ca-host-1", "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+
+  BOOST_CHECK_EQUAL(host.getCaCount(), 2);
+  BOOST_REQUIRE(host.findCa("/ndn/CA/PROBE") != nullptr);
+  BOOST_CHECK_EQUAL(host.findCa("/ndn/CA/PROBE")->getCaConf().caProfile.caPrefix, "/ndn");
+  BOOST_REQUIRE(host.findCa("/ndn/site1/CA/PROBE") != nullptr);
+  BOOST_CHECK_EQUAL(host.findCa("/ndn/site1/CA/PROBE")->getCaConf().caProfile.caPrefix, "/ndn/site1");
+  BOOST_CHECK_EQUAL(host.findCa("/ndn/site1")->getCaConf().caProfile.caPrefix, "/ndn/site1");
+  BOOST_CHECK(host.findCa("/example/CA/PROBE") == nullptr);
+
+  // all CAs share one storage
+  size_t nCas = 0;
+  host.forEachCa([&] (CaModule& ca) {
+    BOOST_CHECK(ca.getCaStorage() == host.getCaStorage());
+    nCas++;
+  });
+  BOOST_CHECK_EQUAL(nCas, 2);
+}
+
+BOOST_AUTO_TEST_CASE(DispatchProbe)
+{
+  addIdentity(Name("/ndn"));
+  auto siteCert = addIdentity(Name("/ndn/site1")).getDefaultKey().getDefaultCertificate();
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaHost host(face, m_keyChain, "tests/unit-tests/config-files/config-ca-host-1", "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+
+  Block paramTLV = makeEmptyBlock(ndn::tlv::ApplicationParameters);
+  paramTLV.push_back(makeStringBlock(tlv::ParameterKey, "name"));
+  paramTLV.push_back(makeStringBlock(tlv::ParameterValue, "zhiyi"));
+  paramTLV.encode();
+  Interest interest("/ndn/site1/CA/PROBE");
+  interest.setCanBePrefix(false);
+  interest.setApplicationParameters(paramTLV);
+  face.receive(interest);
+  advanceClocks(time::milliseconds(20), 60);
+
+  // only the CA with the longest prefix answers
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 1);
+  const auto& response = face.sentData.front();
+  BOOST_CHECK(security::verifySignature(response, siteCert));
+  std::vector<std::pair<Name, int>> names;
+  std::vector<Name> redirects;
+  probetlv::decodeDataContent(response.getContent(), names, redirects);
+  BOOST_REQUIRE_EQUAL(names.size(), 1);
+  BOOST_CHECK(Name("/ndn/site1").isPrefixOf(names.front().first));
+
+  auto metrics = host.collectMetrics();
+  BOOST_REQUIRE(!metrics.empty());
+  BOOST_CHECK_EQUAL(metrics.front().labels.front().first, "ca");
+  BOOST_CHECK_EQUAL(metrics.back().name, "ndncert_event_bus_dropped_total");
+  BOOST_CHECK(metrics.back().labels.empty());
+  BOOST_CHECK_EQUAL(metrics.back().value, 0);
+}
+
+BOOST_AUTO_TEST_CASE(RequestOfAnotherCa)
+{
+  addIdentity(Name("/ndn"));
+  auto siteCert = addIdentity(Name("/ndn/site1")).getDefaultKey().getDefaultCertificate();
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaHost host(face, m_keyChain, "tests/unit-tests/config-files/config-ca-host-1", "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+
+  CaProfile item;
+  item.caPrefix = Name("/ndn/site1");
+  item.cert = std::make_shared<security::Certificate>(siteCert);
+  requester::Request state(m_keyChain, item, RequestType::NEW);
+  face.receive(*state.genNewInterest(Name("/ndn/site1/zhiyi"), time::system_clock::now(),
+                                     time::system_clock::now() + time::days(1)));
+  advanceClocks(time::milliseconds(20), 60);
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 1);
+  state.onNewRenewRevokeResponse(face.sentData.back());
+  BOOST_REQUIRE_EQUAL(host.getCaStorage()->listAllRequests().size(), 1);
+
+  // the request ID issued by /ndn/site1, sent in a CHALLENGE to /ndn
+  state.m_caProfile.caPrefix = Name("/ndn");
+  face.receive(*state.genChallengeInterest(state.selectOrContinueChallenge("pin")));
+  advanceClocks(time::milliseconds(20), 60);
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 2);
+  BOOST_CHECK(Name("/ndn/CA/CHALLENGE").isPrefixOf(face.sentData.back().getName()));
+  auto contentTlv = face.sentData.back().getContent();
+  contentTlv.parse();
+  BOOST_CHECK(static_cast<ErrorCode>(readNonNegativeInteger(contentTlv.get(tlv::ErrorCode))) ==
+              ErrorCode::INVALID_PARAMETER);
+  // the request is left as it was
+  auto requests = host.getCaStorage()->listAllRequests();
+  BOOST_REQUIRE_EQUAL(requests.size(), 1);
+  BOOST_CHECK(requests.front().status == Status::BEFORE_CHALLENGE);
+  BOOST_CHECK(!requests.front().challengeState);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // TestCaHost
+
+} // namespace tests
+} // namespace ndncert
+} // namespace ndn
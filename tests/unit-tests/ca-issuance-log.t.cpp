@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/ca-issuance-log.hpp"
+#include "detail/log-encoder.hpp"
+#include "ca-module.hpp"
+#include "test-common.hpp"
+
+#include <ndn-cxx/util/dummy-client-face.hpp>
+
+#include <fstream>
+
+namespace ndn {
+namespace ndncert {
+namespace tests {
+
+using namespace ca;
+
+// the Merkle tree hash of RFC 9162 Section 2.1.1, computed from its definition
+static MerkleHash
+computeRootHash(const std::vector<MerkleHash>& leaves, size_t begin, size_t end)
+{
+  if (end - begin == 1) {
+    return leaves[begin];
+  }
+  size_t k = 1;
+  while (k * 2 < end - begin) {
+    k *= 2;
+  }
+  return MerkleTree::hashChildren(computeRootHash(leaves, begin, begin + k),
+                                  computeRootHash(leaves, begin + k, end));
+}
+
+BOOST_FIXTURE_TEST_SUITE(TestIssuanceLog, DatabaseFixture)
+
+BOOST_AUTO_TEST_CASE(MerkleTreeProofs)
+{
+  MerkleTree tree;
+  std::vector<MerkleHash> leaves;
+  for (uint8_t i = 0; i < 33; i++) {
+    leaves.push_back(MerkleTree::hashLeaf(&i, 1));
+    BOOST_CHECK_EQUAL(tree.append(leaves.back()), i);
+  }
+
+  for (uint64_t treeSize = 1; treeSize <= tree.size(); treeSize++) {
+    auto rootHash = tree.getRootHash(treeSize);
+    BOOST_CHECK(rootHash == computeRootHash(leaves, 0, treeSize));
+    for (uint64_t index = 0; index < treeSize; index++) {
+      auto proof = tree.getInclusionProof(index, treeSize);
+      BOOST_CHECK(MerkleTree::verifyInclusion(leaves[index], proof, rootHash));
+    }
+  }
+
+  auto proof = tree.getInclusionProof(5, 20);
+  BOOST_CHECK(!MerkleTree::verifyInclusion(leaves[6], proof, tree.getRootHash(20)));
+  BOOST_CHECK(!MerkleTree::verifyInclusion(leaves[5], proof, tree.getRootHash(21)));
+  proof.auditPath.front()[0] ^= 1;
+  BOOST_CHECK(!MerkleTree::verifyInclusion(leaves[5], proof, tree.getRootHash(20)));
+
+  BOOST_CHECK_THROW(tree.getInclusionProof(20, 20), std::out_of_range);
+  BOOST_CHECK_THROW(tree.getRootHash(34), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(Persistence)
+{
+  auto fileName = (dbDir / "issuance.log").string();
+  std::vector<security::Certificate> certs;
+  MerkleHash rootHash;
+  {
+    IssuanceLog log(fileName);
+    for (int i = 0; i < 5; i++) {
+      certs.push_back(addIdentity(Name("/ndn/site" + std::to_string(i))).getDefaultKey().getDefaultCertificate());
+      BOOST_CHECK_EQUAL(log.append(certs.back()), i);
+    }
+    rootHash = log.getRootHash(log.size());
+  }
+
+  // an entry cut short by a crash
+  {
+    std::ofstream os(fileName, std::ios::binary | std::ios::app);
+    os.put(ndn::tlv::Data);
+    os.put(static_cast<char>(0xFD));
+  }
+
+  IssuanceLog log(fileName);
+  BOOST_REQUIRE_EQUAL(log.size(), 5);
+  BOOST_CHECK(log.getRootHash(5) == rootHash);
+  BOOST_CHECK(log.getEntry(3) == certs[3].wireEncode());
+  BOOST_CHECK_THROW(log.getEntry(5), std::out_of_range);
+
+  // appending continues right after the last complete entry
+  auto cert = addIdentity(Name("/ndn/site5")).getDefaultKey().getDefaultCertificate();
+  BOOST_CHECK_EQUAL(log.append(cert), 5);
+  BOOST_CHECK(log.getEntry(5) == cert.wireEncode());
+}
+
+BOOST_AUTO_TEST_CASE(ServeLog)
+{
+  auto caCert = addIdentity(Name("/ndn")).getDefaultKey().getDefaultCertificate();
+  JsonSection config;
+  boost::property_tree::read_json("tests/unit-tests/config-files/config-ca-1", config);
+  config.put(CONFIG_ISSUANCE_LOG, "issuance.log");
+  auto configPath = (dbDir / "config-ca-log").string();
+  boost::property_tree::write_json(configPath, config);
+
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaModule ca(face, m_keyChain, configPath, "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+  BOOST_REQUIRE(ca.m_issuanceLog != nullptr);
+  BOOST_CHECK_EQUAL(ca.m_issuanceLog->getFileName(), (dbDir / "issuance.log").string());
+
+  std::vector<security::Certificate> certs;
+  for (int i = 0; i < 3; i++) {
+    certs.push_back(addIdentity(Name("/ndn/site" + std::to_string(i))).getDefaultKey().getDefaultCertificate());
+    ca.m_issuanceLog->append(certs.back());
+  }
+
+  Interest headInterest(Name("/ndn/CA/LOG/HEAD"));
+  headInterest.setCanBePrefix(true);
+  face.receive(headInterest);
+  face.receive(Interest(Name("/ndn/CA/LOG/PROOF").appendNumber(1).appendNumber(3)));
+  face.receive(Interest(Name("/ndn/CA/LOG/ENTRY").appendNumber(2)));
+  advanceClocks(time::milliseconds(20), 10);
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 3);
+
+  const auto& headData = face.sentData[0];
+  BOOST_CHECK(security::verifySignature(headData, caCert));
+  BOOST_CHECK_EQUAL(headData.getName()[-1].toVersion(), 3);
+  auto head = logtlv::decodeTreeHead(headData.getContent());
+  BOOST_CHECK_EQUAL(head.treeSize, 3);
+
+  MerkleHash rootHash;
+  auto proof = logtlv::decodeInclusionProof(face.sentData[1].getContent(), rootHash);
+  BOOST_CHECK(rootHash == head.rootHash);
+  const auto& wire = certs[1].wireEncode();
+  BOOST_CHECK(MerkleTree::verifyInclusion(MerkleTree::hashLeaf(wire.wire(), wire.size()), proof, head.rootHash));
+
+  BOOST_CHECK(security::Certificate(face.sentData[2].getContent().blockFromValue()) == certs[2]);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestIssuanceLog
+
+} // namespace tests
+} // namespace ndncert
+} // namespace ndn
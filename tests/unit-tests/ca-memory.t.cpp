@@ -93,6 +93,38 @@ BOOST_AUTO_TEST_CASE(RequestOperations)
   BOOST_CHECK_EQUAL(allRequests.size(), 1);
 }
 
+BOOST_AUTO_TEST_CASE(RequestIdKey)
+{
+  CaMemory storage;
+  auto key1 = storage.getRequestIdKey(Name("/ndn/site1"));
+  auto key2 = storage.getRequestIdKey(Name("/ndn/site2"));
+  BOOST_CHECK_EQUAL(key1.size(), REQUEST_ID_KEY_SIZE);
+  BOOST_CHECK(key1 != key2);
+  BOOST_CHECK(storage.getRequestIdKey(Name("/ndn/site1")) == key1);
+}
+
+BOOST_AUTO_TEST_CASE(DefaultRequestIdKey)
+{
+  // a storage that does not keep the key gets one for the lifetime of the process
+  class KeylessStorage : public CaMemory
+  {
+  public:
+    Buffer
+    getRequestIdKey(const Name& caName) override
+    {
+      return CaStorage::getRequestIdKey(caName);
+    }
+  };
+
+  KeylessStorage storage;
+  auto key1 = storage.getRequestIdKey(Name("/ndn/site1"));
+  auto key2 = storage.getRequestIdKey(Name("/ndn/site2"));
+  BOOST_CHECK_EQUAL(key1.size(), REQUEST_ID_KEY_SIZE);
+  BOOST_CHECK(key1 != key2);
+  BOOST_CHECK(storage.getRequestIdKey(Name("/ndn/site1")) == key1);
+  BOOST_CHECK(KeylessStorage().getRequestIdKey(Name("/ndn/site1")) == key1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()  // TestCaModule
 
 } // namespace tests
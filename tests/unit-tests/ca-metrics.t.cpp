@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "ca-module.hpp"
+#include "detail/ca-metrics.hpp"
+#include "test-common.hpp"
+
+#include <ndn-cxx/security/verification-helpers.hpp>
+#include <ndn-cxx/util/dummy-client-face.hpp>
+
+namespace ndn {
+namespace ndncert {
+namespace tests {
+
+using namespace ca;
+
+BOOST_FIXTURE_TEST_SUITE(TestCaMetrics, IdentityManagementTimeFixture)
+
+BOOST_AUTO_TEST_CASE(HistogramBuckets)
+{
+  // small values are exact
+  for (uint64_t value = 0; value < 2 * LatencyHistogram::SUB_BUCKET_COUNT; value++) {
+    BOOST_CHECK_EQUAL(LatencyHistogram::getBucketIndex(value), value);
+    BOOST_CHECK_EQUAL(LatencyHistogram::getBucketHighestValue(value), value);
+  }
+  // larger values keep a relative error below 1/32
+  for (uint64_t value : {100ull, 1000ull, 123456ull, 1000000000ull}) {
+    auto index = LatencyHistogram::getBucketIndex(value);
+    auto highest = LatencyHistogram::getBucketHighestValue(index);
+    BOOST_CHECK_GE(highest, value);
+    BOOST_CHECK_LE(highest - value, value / LatencyHistogram::SUB_BUCKET_COUNT);
+    BOOST_CHECK_EQUAL(LatencyHistogram::getBucketIndex(highest), index);
+    BOOST_CHECK_EQUAL(LatencyHistogram::getBucketIndex(highest + 1), index + 1);
+  }
+  BOOST_CHECK_LT(LatencyHistogram::getBucketIndex(uint64_t(1) << 50), LatencyHistogram::BUCKET_COUNT);
+}
+
+BOOST_AUTO_TEST_CASE(HistogramPercentiles)
+{
+  LatencyHistogram histogram;
+  BOOST_CHECK_EQUAL(histogram.getPercentile(0.5), time::nanoseconds::zero());
+  for (int i = 1; i <= 1000; i++) {
+    histogram.record(time::microseconds(i));
+  }
+  BOOST_CHECK_EQUAL(histogram.getCount(), 1000);
+  BOOST_CHECK_EQUAL(histogram.getMax(), time::microseconds(1000));
+  BOOST_CHECK_EQUAL(histogram.getSum(), time::microseconds(500500));
+
+  auto median = histogram.getPercentile(0.5).count();
+  BOOST_CHECK_GE(median, 500000);
+  BOOST_CHECK_LE(median, 500000 + 500000 / 32);
+  auto p99 = histogram.getPercentile(0.99).count();
+  BOOST_CHECK_GE(p99, 990000);
+  BOOST_CHECK_LE(p99, 990000 + 990000 / 32);
+  BOOST_CHECK_EQUAL(histogram.getPercentile(1.0), time::microseconds(1000));
+}
+
+BOOST_AUTO_TEST_CASE(PrometheusText)
+{
+  CaMetrics metrics;
+  metrics.recordHandler(CaHandler::PROBE, time::milliseconds(2));
+  metrics.recordError(ErrorCode::BAD_SIGNATURE);
+  metrics.recordError(ErrorCode::BAD_SIGNATURE);
+
+  std::vector<MetricSample> samples;
+  metrics.collect(samples);
+  auto text = formatPrometheusText(samples);
+  BOOST_CHECK_NE(text.find("ndncert_request_latency_seconds_count{handler=\"probe\"} 1\n"), std::string::npos);
+  BOOST_CHECK_NE(text.find("ndncert_request_latency_seconds_count{handler=\"challenge\"} 0\n"), std::string::npos);
+  BOOST_CHECK_EQUAL(metrics.getErrorCount(ErrorCode::BAD_SIGNATURE), 2);
+  BOOST_CHECK_EQUAL(metrics.getErrorCount(ErrorCode::NO_ERROR), 0);
+}
+
+BOOST_AUTO_TEST_CASE(StatusDataset)
+{
+  auto identity = addIdentity(Name("/ndn"));
+  auto key = identity.getDefaultKey();
+  auto cert = key.getDefaultCertificate();
+
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaModule ca(face, m_keyChain, "tests/unit-tests/config-files/config-ca-1", "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+
+  // every handled PROBE is counted
+  Interest probe(Name("/ndn/CA/PROBE"));
+  probe.setCanBePrefix(false);
+  probe.setApplicationParameters(makeEmptyBlock(tlv::ApplicationParameters));
+  face.receive(probe);
+  advanceClocks(time::milliseconds(20), 60);
+  BOOST_CHECK_EQUAL(ca.getMetrics().getHandlerCount(CaHandler::PROBE), 1);
+
+  std::vector<Data> responses;
+  face.onSendData.connect([&] (const Data& response) {
+    responses.push_back(response);
+  });
+  Interest interest(Name("/ndn/CA/STATUS/metrics"));
+  interest.setCanBePrefix(true);
+  interest.setMustBeFresh(true);
+  face.receive(interest);
+  advanceClocks(time::milliseconds(20), 10);
+  BOOST_REQUIRE_EQUAL(responses.size(), 1);
+  BOOST_CHECK(security::verifySignature(responses[0], cert));
+  BOOST_CHECK(responses[0].getName()[-2].isVersion());
+  BOOST_CHECK_EQUAL(responses[0].getName()[-1].toSegment(), 0);
+  BOOST_REQUIRE(responses[0].getFinalBlock());
+
+  // fetch every segment of the same version and reassemble the snapshot
+  auto nSegments = responses[0].getFinalBlock()->toSegment() + 1;
+  std::string content(reinterpret_cast<const char*>(responses[0].getContent().value()),
+                      responses[0].getContent().value_size());
+  for (uint64_t i = 1; i < nSegments; i++) {
+    Interest segmentInterest(responses[0].getName().getPrefix(-1).appendSegment(i));
+    face.receive(segmentInterest);
+    advanceClocks(time::milliseconds(20), 10);
+    BOOST_REQUIRE_EQUAL(responses.size(), i + 1);
+    content.append(reinterpret_cast<const char*>(responses[i].getContent().value()),
+                   responses[i].getContent().value_size());
+  }
+
+  std::istringstream is(content);
+  JsonSection json;
+  boost::property_tree::read_json(is, json);
+  BOOST_CHECK_EQUAL(json.get<std::string>("ca-prefix"), "/ndn");
+  bool hasProbeCount = false;
+  for (const auto& item : json.get_child("metrics")) {
+    if (item.second.get<std::string>("name") == "ndncert_request_latency_seconds_count" &&
+        item.second.get<std::string>("labels.handler") == "probe") {
+      BOOST_CHECK_EQUAL(item.second.get<double>("value"), 1);
+      hasProbeCount = true;
+    }
+  }
+  BOOST_CHECK(hasProbeCount);
+
+  // within the snapshot period the same snapshot is served again
+  interest.refreshNonce();
+  face.receive(interest);
+  advanceClocks(time::milliseconds(20), 10);
+  BOOST_REQUIRE_EQUAL(responses.size(), nSegments + 1);
+  BOOST_CHECK_EQUAL(responses.back().wireEncode(), responses[0].wireEncode());
+
+  // a stale version is not served
+  Interest staleInterest(Name("/ndn/CA/STATUS/metrics").appendVersion(1).appendSegment(0));
+  face.receive(staleInterest);
+  advanceClocks(time::milliseconds(20), 10);
+  BOOST_CHECK_EQUAL(responses.size(), nSegments + 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // TestCaMetrics
+
+} // namespace tests
+} // namespace ndncert
+} // namespace ndn
@@ -23,9 +23,13 @@
 #include "challenge/challenge-email.hpp"
 #include "challenge/challenge-pin.hpp"
 #include "detail/info-encoder.hpp"
+#include "detail/probe-encoder.hpp"
 #include "requester-request.hpp"
 #include "test-common.hpp"
 
+#include <ndn-cxx/security/interest-signer.hpp>
+#include <thread>
+
 namespace ndn {
 namespace ndncert {
 namespace tests {
@@ -42,7 +46,7 @@ BOOST_AUTO_TEST_CASE(Initialization)
 
   advanceClocks(time::milliseconds(20), 60);
   BOOST_CHECK_EQUAL(ca.m_registeredPrefixHandles.size(), 1); // removed local discovery registration
-  BOOST_CHECK_EQUAL(ca.m_interestFilterHandles.size(), 5);  // infoMeta, onProbe, onNew, onChallenge, onRevoke
+  BOOST_CHECK_EQUAL(ca.m_interestFilterHandles.size(), 9);  // infoMeta, onProbe, onNew, onBatchNew, onChallenge, onRevoke, onReload, onLog, onStatusMetrics
 }
 
 BOOST_AUTO_TEST_CASE(HandleProfileFetching)
@@ -101,6 +105,45 @@ BOOST_AUTO_TEST_CASE(HandleProfileFetching)
   BOOST_CHECK_EQUAL(count, 2);
 }
 
+BOOST_AUTO_TEST_CASE(HandleProfileDiscoveryCached)
+{
+  auto identity = addIdentity(Name("/ndn"));
+  auto key = identity.getDefaultKey();
+  auto cert = key.getDefaultCertificate();
+
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaModule ca(face, m_keyChain, "tests/unit-tests/config-files/config-ca-1", "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+
+  std::vector<Data> responses;
+  face.onSendData.connect([&](const Data& response) {
+    responses.push_back(response);
+  });
+  Interest interest = MetadataObject::makeDiscoveryInterest(Name("/ndn/CA/INFO"));
+  face.receive(interest);
+  advanceClocks(time::milliseconds(20), 60);
+  interest.refreshNonce();
+  face.receive(interest);
+  advanceClocks(time::milliseconds(20), 60);
+
+  BOOST_REQUIRE_EQUAL(responses.size(), 2);
+  BOOST_CHECK(security::verifySignature(responses[0], cert));
+  // the second discovery is served from the cache without signing again
+  BOOST_CHECK_EQUAL(responses[0].wireEncode(), responses[1].wireEncode());
+  auto profileName = ca.getCaProfileData().getName();
+
+  // a new CA certificate invalidates the cached profile
+  auto newKey = m_keyChain.createKey(identity);
+  m_keyChain.setDefaultKey(identity, newKey);
+  advanceClocks(time::seconds(1));
+  ca.invalidateCaProfileData();
+  face.receive(interest);
+  advanceClocks(time::milliseconds(20), 60);
+  BOOST_REQUIRE_EQUAL(responses.size(), 3);
+  BOOST_CHECK(security::verifySignature(responses[2], newKey.getDefaultCertificate()));
+  BOOST_CHECK_NE(ca.getCaProfileData().getName(), profileName);
+}
+
 BOOST_AUTO_TEST_CASE(HandleProbe)
 {
   auto identity = addIdentity(Name("/ndn"));
@@ -139,6 +182,41 @@ BOOST_AUTO_TEST_CASE(HandleProbe)
   BOOST_CHECK_EQUAL(count, 1);
 }
 
+BOOST_AUTO_TEST_CASE(HandleProbeOnWorkers)
+{
+  auto identity = addIdentity(Name("/ndn"));
+  auto cert = identity.getDefaultKey().getDefaultCertificate();
+
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaModule ca(face, m_keyChain, "tests/unit-tests/config-files/config-ca-8", "ca-storage-memory");
+  BOOST_CHECK_EQUAL(ca.getWorkerCount(), 2);
+  advanceClocks(time::milliseconds(20), 60);
+
+  Block paramTLV = makeEmptyBlock(ndn::tlv::ApplicationParameters);
+  paramTLV.push_back(makeStringBlock(tlv::ParameterKey, "name"));
+  paramTLV.push_back(makeStringBlock(tlv::ParameterValue, "zhiyi"));
+  paramTLV.encode();
+
+  int count = 0;
+  face.onSendData.connect([&](const Data& response) {
+    count++;
+    BOOST_CHECK(security::verifySignature(response, cert));
+  });
+  for (int i = 0; i < 4; i++) {
+    Interest interest("/ndn/CA/PROBE");
+    interest.setCanBePrefix(false);
+    interest.setApplicationParameters(paramTLV);
+    face.receive(interest);
+  }
+
+  // the replies are signed on the workers and sent once the face thread runs again
+  for (int i = 0; i < 200 && count < 4; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    advanceClocks(time::milliseconds(1));
+  }
+  BOOST_CHECK_EQUAL(count, 4);
+}
+
 BOOST_AUTO_TEST_CASE(HandleProbeUsingDefaultHandler)
 {
   auto identity = addIdentity(Name("/ndn"));
@@ -220,6 +298,155 @@ BOOST_AUTO_TEST_CASE(HandleProbeRedirection)
   BOOST_CHECK_EQUAL(count, 1);
 }
 
+BOOST_AUTO_TEST_CASE(HandleProbeCached)
+{
+  auto identity = addIdentity(Name("/ndn"));
+  auto cert = identity.getDefaultKey().getDefaultCertificate();
+
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaModule ca(face, m_keyChain, "tests/unit-tests/config-files/config-ca-11", "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+
+  auto makeProbe = [] (const std::string& key, const std::string& value) {
+    Interest interest("/ndn/CA/PROBE");
+    interest.setCanBePrefix(false);
+    Block paramTLV = makeEmptyBlock(ndn::tlv::ApplicationParameters);
+    paramTLV.push_back(makeStringBlock(tlv::ParameterKey, key));
+    paramTLV.push_back(makeStringBlock(tlv::ParameterValue, value));
+    paramTLV.encode();
+    interest.setApplicationParameters(paramTLV);
+    return interest;
+  };
+  auto interest = makeProbe("name", "zhiyi");
+
+  for (int i = 0; i < 2; i++) {
+    face.receive(interest);
+    advanceClocks(time::milliseconds(20), 10);
+  }
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 2);
+  // the names of the first reply are offered again without signing another Data
+  BOOST_CHECK(face.sentData[0].wireEncode() == face.sentData[1].wireEncode());
+  BOOST_CHECK_EQUAL(ca.m_probeCache.getHitCount(), 1);
+
+  // once a suggested name is taken, a new reply is generated
+  std::vector<std::pair<Name, int>> names;
+  std::vector<Name> redirections;
+  probetlv::decodeDataContent(face.sentData[0].getContent(), names, redirections);
+  BOOST_REQUIRE_EQUAL(names.size(), 2);
+  ca.m_identityIndex.addPending(RequestId{}, names.front().first);
+  face.receive(interest);
+  advanceClocks(time::milliseconds(20), 10);
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 3);
+  BOOST_CHECK(face.sentData[2].wireEncode() != face.sentData[0].wireEncode());
+  BOOST_CHECK(security::verifySignature(face.sentData[2], cert));
+
+  // error replies are not cached
+  auto badInterest = makeProbe("email", "zhiyi@cs.ucla.edu");
+  face.receive(badInterest);
+  advanceClocks(time::milliseconds(20), 10);
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 4);
+  BOOST_CHECK_EQUAL(ca.m_probeCache.size(), 1);
+
+  // a reload or a new CA certificate starts over
+  ca.invalidateCaProfileData();
+  BOOST_CHECK_EQUAL(ca.m_probeCache.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(HandleProbeRandomNotCached)
+{
+  addIdentity(Name("/ndn"));
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaModule ca(face, m_keyChain, "tests/unit-tests/config-files/config-ca-1", "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+
+  Interest interest("/ndn/CA/PROBE");
+  interest.setCanBePrefix(false);
+  Block paramTLV = makeEmptyBlock(ndn::tlv::ApplicationParameters);
+  paramTLV.push_back(makeStringBlock(tlv::ParameterKey, "name"));
+  paramTLV.push_back(makeStringBlock(tlv::ParameterValue, "zhiyi"));
+  paramTLV.encode();
+  interest.setApplicationParameters(paramTLV);
+
+  // each requester gets a random name of its own
+  for (int i = 0; i < 2; i++) {
+    face.receive(interest);
+    advanceClocks(time::milliseconds(20), 10);
+  }
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 2);
+  BOOST_CHECK(face.sentData[0].getContent() != face.sentData[1].getContent());
+  BOOST_CHECK_EQUAL(ca.m_probeCache.size(), 0);
+  BOOST_CHECK_EQUAL(ca.m_probeCache.getHitCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(HandleProbeSkipsNamesInUse)
+{
+  auto identity = addIdentity(Name("/ndn"));
+  auto cert = identity.getDefaultKey().getDefaultCertificate();
+
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaModule ca(face, m_keyChain, "tests/unit-tests/config-files/config-ca-5", "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+  ca.m_identityIndex.addPending(RequestId{}, Name("/ndn/irl/zhiyi"));
+
+  Interest interest("/ndn/CA/PROBE");
+  interest.setCanBePrefix(false);
+  Block paramTLV = makeEmptyBlock(ndn::tlv::ApplicationParameters);
+  paramTLV.push_back(makeStringBlock(tlv::ParameterKey, "group"));
+  paramTLV.push_back(makeStringBlock(tlv::ParameterValue, "irl"));
+  paramTLV.push_back(makeStringBlock(tlv::ParameterKey, "email"));
+  paramTLV.push_back(makeStringBlock(tlv::ParameterValue, "zhiyi@cs.ucla.edu"));
+  paramTLV.push_back(makeStringBlock(tlv::ParameterKey, "name"));
+  paramTLV.push_back(makeStringBlock(tlv::ParameterValue, "zhiyi"));
+  paramTLV.encode();
+  interest.setApplicationParameters(paramTLV);
+
+  int count = 0;
+  face.onSendData.connect([&](const Data& response) {
+    count++;
+    std::vector<std::pair<Name, int>> names;
+    std::vector<Name> redirections;
+    probetlv::decodeDataContent(response.getContent(), names, redirections);
+    // the email and the random names are left
+    BOOST_CHECK_EQUAL(names.size(), 2);
+    for (const auto& name : names) {
+      BOOST_CHECK_NE(name.first, Name("/ndn/irl/zhiyi"));
+    }
+  });
+  face.receive(interest);
+  advanceClocks(time::milliseconds(20), 60);
+  BOOST_CHECK_EQUAL(count, 1);
+}
+
+BOOST_AUTO_TEST_CASE(HandleNewWithIssuedName)
+{
+  auto identity = addIdentity(Name("/ndn"));
+  auto cert = identity.getDefaultKey().getDefaultCertificate();
+
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaModule ca(face, m_keyChain, "tests/unit-tests/config-files/config-ca-1", "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+  ca.m_identityIndex.addIssued(Name("/ndn/zhiyi"), Name("/ndn/zhiyi/KEY/%01"));
+
+  CaProfile item;
+  item.caPrefix = Name("/ndn");
+  item.cert = std::make_shared<security::Certificate>(cert);
+  requester::Request state(m_keyChain, item, RequestType::NEW);
+  auto interest = state.genNewInterest(Name("/ndn/zhiyi"), time::system_clock::now(),
+                                       time::system_clock::now() + time::days(1));
+
+  // the index only keeps PROBE from suggesting the name; it does not refuse it to another key,
+  // as it knows nothing of the names issued before the CA started
+  std::vector<Data> responses;
+  face.onSendData.connect([&](const Data& response) { responses.push_back(response); });
+  face.receive(*interest);
+  advanceClocks(time::milliseconds(20), 60);
+  BOOST_REQUIRE_EQUAL(responses.size(), 1);
+  auto challenges = state.onNewRenewRevokeResponse(responses.back());
+  BOOST_CHECK(!challenges.empty());
+  BOOST_CHECK_EQUAL(ca.m_identityIndex.getPendingCount(), 1);
+  BOOST_CHECK(ca.m_identityIndex.isUsed(Name("/ndn/zhiyi")));
+}
+
 BOOST_AUTO_TEST_CASE(HandleNew)
 {
   auto identity = addIdentity(Name("/ndn"));
@@ -271,6 +498,103 @@ BOOST_AUTO_TEST_CASE(HandleNew)
   BOOST_CHECK_EQUAL(count, 1);
 }
 
+BOOST_AUTO_TEST_CASE(HandleBatchNew)
+{
+  auto identity = addIdentity(Name("/ndn"));
+  auto cert = identity.getDefaultKey().getDefaultCertificate();
+
+  CaProfile item;
+  item.caPrefix = Name("/ndn");
+  item.cert = std::make_shared<security::Certificate>(cert);
+
+  // processed on the face thread, then spread over two workers
+  for (const auto& configPath : {"tests/unit-tests/config-files/config-ca-1",
+                                 "tests/unit-tests/config-files/config-ca-8"}) {
+    util::DummyClientFace face(io, m_keyChain, {true, true});
+    CaModule ca(face, m_keyChain, configPath, "ca-storage-memory");
+    advanceClocks(time::milliseconds(20), 60);
+
+    std::vector<std::unique_ptr<requester::Request>> states;
+    std::vector<requester::Request*> requests;
+    for (int i = 0; i < 3; i++) {
+      states.push_back(std::make_unique<requester::Request>(m_keyChain, item, RequestType::NEW));
+      requests.push_back(states.back().get());
+    }
+    // the last name is longer than the max suffix length
+    auto interests = requester::Request::genBatchNewInterests(requests,
+                                                              {Name("/ndn/a"), Name("/ndn/b"), Name("/ndn/c/d/e/f")},
+                                                              time::system_clock::now(),
+                                                              time::system_clock::now() + time::days(1));
+    BOOST_REQUIRE_EQUAL(interests.size(), 1);
+    BOOST_CHECK_EQUAL(interests.front().second, 3);
+
+    int count = 0;
+    face.onSendData.connect([&](const Data& response) {
+      count++;
+      BOOST_CHECK(security::verifySignature(response, cert));
+      std::vector<std::string> errorInfos;
+      auto challenges = requester::Request::onBatchNewResponse(response, requests, errorInfos);
+      BOOST_CHECK_EQUAL(challenges.size(), 1);
+      BOOST_REQUIRE_EQUAL(errorInfos.size(), 3);
+      BOOST_CHECK_EQUAL(errorInfos[0], "");
+      BOOST_CHECK_EQUAL(errorInfos[1], "");
+      BOOST_CHECK_NE(errorInfos[2], "");
+      BOOST_CHECK(requests[2]->m_status == Status::FAILURE);
+      for (int i = 0; i < 2; i++) {
+        auto caEncryptionKey = ca.getCaStorage()->getRequest(requests[i]->m_requestId).encryptionKey;
+        BOOST_CHECK_EQUAL_COLLECTIONS(requests[i]->m_aesKey.begin(), requests[i]->m_aesKey.end(),
+                                      caEncryptionKey.begin(), caEncryptionKey.end());
+      }
+    });
+    face.receive(*interests.front().first);
+
+    for (int i = 0; i < 200 && count < 1; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      advanceClocks(time::milliseconds(1));
+    }
+    BOOST_CHECK_EQUAL(count, 1);
+    BOOST_CHECK_EQUAL(ca.getCaStorage()->listAllRequests().size(), 2);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(HandleNewAfterDeadline)
+{
+  auto identity = addIdentity(Name("/ndn"));
+  auto key = identity.getDefaultKey();
+  auto cert = key.getDefaultCertificate();
+
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaModule ca(face, m_keyChain, "tests/unit-tests/config-files/config-ca-1", "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+
+  CaProfile item;
+  item.caPrefix = Name("/ndn");
+  item.cert = std::make_shared<security::Certificate>(cert);
+  requester::Request state(m_keyChain, item, RequestType::NEW);
+  auto interest = state.genNewInterest(Name("/ndn/zhiyi"),
+                                       time::system_clock::now(),
+                                       time::system_clock::now() + time::days(1));
+  interest->setInterestLifetime(time::seconds(1));
+
+  // the Interest arrived two seconds ago and its requester has already given up
+  RequestDeadline deadline(*interest, time::steady_clock::now() - time::seconds(2));
+  BOOST_CHECK(deadline.hasExpired());
+  ca.onNewRenewRevoke(*interest, RequestType::NEW, deadline);
+  advanceClocks(time::milliseconds(20), 60);
+
+  BOOST_CHECK_EQUAL(face.sentData.size(), 0);
+  BOOST_CHECK_EQUAL(ca.getCaStorage()->listAllRequests().size(), 0);
+  BOOST_CHECK_EQUAL(ca.getDeadlineStatistics().getSkippedCount(ProcessingStage::ECDH), 1);
+  BOOST_CHECK_EQUAL(ca.getDeadlineStatistics().getExpiredRequestCount(), 1);
+
+  // the same Interest is processed when it is still within its lifetime
+  ca.onNewRenewRevoke(*interest, RequestType::NEW, RequestDeadline(*interest));
+  advanceClocks(time::milliseconds(20), 60);
+  BOOST_CHECK_EQUAL(face.sentData.size(), 1);
+  BOOST_CHECK_EQUAL(ca.getCaStorage()->listAllRequests().size(), 1);
+  BOOST_CHECK_EQUAL(ca.getDeadlineStatistics().getExpiredRequestCount(), 1);
+}
+
 BOOST_AUTO_TEST_CASE(HandleNewWithInvalidValidityPeriod1)
 {
   auto identity = addIdentity(Name("/ndn"));
@@ -382,6 +706,15 @@ BOOST_AUTO_TEST_CASE(HandleNewWithLongSuffix)
   face.receive(*interest2);
   face.receive(*interest3);
   advanceClocks(time::milliseconds(20), 60);
+
+  // the long suffix is rejected by the policy stage, before any signature or ECDH work
+  const auto& stats = ca.getPipelineStatistics();
+  BOOST_CHECK_EQUAL(stats.get(PipelineStage::DECODE).nProcessed, 3);
+  BOOST_CHECK_EQUAL(stats.get(PipelineStage::POLICY).nRejected, 1);
+  BOOST_CHECK_EQUAL(stats.get(PipelineStage::SIGNATURE).nProcessed, 2);
+  BOOST_CHECK_EQUAL(stats.get(PipelineStage::ECDH).nProcessed, 2);
+  BOOST_CHECK_EQUAL(stats.get(PipelineStage::STORAGE).nProcessed, 2);
+  BOOST_CHECK_EQUAL(stats.get(PipelineStage::STORAGE).nRejected, 0);
 }
 
 BOOST_AUTO_TEST_CASE(HandleNewWithInvalidLength1)
@@ -602,6 +935,138 @@ BOOST_AUTO_TEST_CASE(HandleRevokeWithBadCert)
   BOOST_CHECK_EQUAL(receiveData, true);
 }
 
+BOOST_AUTO_TEST_CASE(ReloadConfig)
+{
+  addIdentity(Name("/ndn"));
+  auto configPath = (dbDir / "config-ca-reload").string();
+  JsonSection configJson;
+  boost::property_tree::read_json("tests/unit-tests/config-files/config-ca-1", configJson);
+  boost::property_tree::write_json(configPath, configJson);
+
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaModule ca(face, m_keyChain, configPath, "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+  auto requestIdKey = ca.getCaStorage()->getRequestIdKey(Name("/ndn"));
+
+  bool isDone = false;
+  std::string reloadError;
+  auto reload = [&] {
+    isDone = false;
+    ca.reloadConfig([&] (const std::string& error) {
+      isDone = true;
+      reloadError = error;
+    });
+    for (int i = 0; i < 200 && !isDone; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      advanceClocks(time::milliseconds(1));
+    }
+  };
+
+  configJson.put("ca-info", "reloaded ca");
+  boost::property_tree::write_json(configPath, configJson);
+  reload();
+  BOOST_REQUIRE(isDone);
+  BOOST_CHECK_EQUAL(reloadError, "");
+  BOOST_CHECK_EQUAL(ca.getCaConf().caProfile.caInfo, "reloaded ca");
+  BOOST_CHECK_EQUAL(infotlv::decodeDataContent(ca.getCaProfileData().getContent()).caInfo, "reloaded ca");
+  BOOST_CHECK(ca.getCaStorage()->getRequestIdKey(Name("/ndn")) == requestIdKey);
+
+  // the CA prefix cannot be changed, and a failed reload keeps the current configuration
+  configJson.put("ca-prefix", "/example");
+  configJson.put("ca-info", "another ca");
+  boost::property_tree::write_json(configPath, configJson);
+  reload();
+  BOOST_REQUIRE(isDone);
+  BOOST_CHECK_NE(reloadError, "");
+  BOOST_CHECK_EQUAL(ca.getCaConf().caProfile.caPrefix, "/ndn");
+  BOOST_CHECK_EQUAL(ca.getCaConf().caProfile.caInfo, "reloaded ca");
+}
+
+BOOST_AUTO_TEST_CASE(ReloadOnInterest)
+{
+  addIdentity(Name("/ndn"));
+  addIdentity(Name("/other"));
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaModule ca(face, m_keyChain, "tests/unit-tests/config-files/config-ca-1", "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+
+  security::InterestSigner signer(m_keyChain);
+  auto checkError = [&face] (ErrorCode expected) {
+    auto contentTlv = face.sentData.back().getContent();
+    contentTlv.parse();
+    BOOST_CHECK(static_cast<ErrorCode>(readNonNegativeInteger(contentTlv.get(tlv::ErrorCode))) == expected);
+  };
+
+  // signed by a key other than the CA's
+  auto badInterest = signer.makeSignedInterest(Interest(Name("/ndn/CA/RELOAD")), signingByIdentity(Name("/other")));
+  face.receive(badInterest);
+  advanceClocks(time::milliseconds(20), 60);
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 1);
+  checkError(ErrorCode::BAD_SIGNATURE);
+
+  // signed by the CA's key, but without a signature time and nonce
+  Interest oldFormatInterest(Name("/ndn/CA/RELOAD"));
+  m_keyChain.sign(oldFormatInterest, signingByIdentity(Name("/ndn")));
+  face.receive(oldFormatInterest);
+  advanceClocks(time::milliseconds(20), 60);
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 2);
+  checkError(ErrorCode::BAD_INTEREST_FORMAT);
+
+  auto interest = signer.makeSignedInterest(Interest(Name("/ndn/CA/RELOAD")), signingByIdentity(Name("/ndn")));
+  face.receive(interest);
+  for (int i = 0; i < 200 && face.sentData.size() < 3; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    advanceClocks(time::milliseconds(1));
+  }
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 3);
+  BOOST_CHECK_EQUAL(face.sentData.back().getContent().value_size(), 0);
+
+  // the same Interest replayed
+  face.receive(interest);
+  advanceClocks(time::milliseconds(20), 60);
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 4);
+  checkError(ErrorCode::BAD_SIGNATURE);
+
+  // signed too long ago
+  SignatureInfo staleInfo;
+  staleInfo.setTime(time::system_clock::now() - time::minutes(5));
+  staleInfo.setNonce(std::vector<uint8_t>{1, 2, 3, 4, 5, 6, 7, 8});
+  Interest staleInterest(Name("/ndn/CA/RELOAD"));
+  m_keyChain.sign(staleInterest, signingByIdentity(Name("/ndn"))
+                                   .setSignedInterestFormat(security::SignedInterestFormat::V03)
+                                   .setSignatureInfo(staleInfo));
+  face.receive(staleInterest);
+  advanceClocks(time::milliseconds(20), 60);
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 5);
+  checkError(ErrorCode::BAD_SIGNATURE);
+}
+
+BOOST_AUTO_TEST_CASE(ReloadCoalesced)
+{
+  addIdentity(Name("/ndn"));
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  CaModule ca(face, m_keyChain, "tests/unit-tests/config-files/config-ca-1", "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+
+  // reloads requested while one is running do not wait for it, and are served by one more reload
+  std::vector<std::string> errors;
+  for (int i = 0; i < 3; i++) {
+    ca.reloadConfig([&errors] (const std::string& error) { errors.push_back(error); });
+    BOOST_CHECK(ca.m_isReloading);
+  }
+  BOOST_CHECK(ca.m_isReloadQueued);
+  for (int i = 0; i < 400 && errors.size() < 3; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    advanceClocks(time::milliseconds(1));
+  }
+  BOOST_REQUIRE_EQUAL(errors.size(), 3);
+  for (const auto& error : errors) {
+    BOOST_CHECK_EQUAL(error, "");
+  }
+  BOOST_CHECK(!ca.m_isReloading);
+  BOOST_CHECK(!ca.m_isReloadQueued);
+}
+
 BOOST_AUTO_TEST_SUITE_END()  // TestCaModule
 
 } // namespace tests
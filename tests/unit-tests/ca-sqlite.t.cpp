@@ -127,7 +127,49 @@ BOOST_AUTO_TEST_CASE(DuplicateAdd)
   BOOST_CHECK_NO_THROW(storage.addRequest(request1));
 
   // add again
-  BOOST_CHECK_THROW(storage.addRequest(request1), std::runtime_error);
+  BOOST_CHECK_THROW(storage.addRequest(request1), DuplicateRequestError);
+}
+
+BOOST_AUTO_TEST_CASE(BatchAdd)
+{
+  CaSqlite storage(Name(), dbDir.string() + "/TestCaSqlite_BatchAdd.db");
+
+  auto identity1 = addIdentity(Name("/ndn/site1"));
+  auto cert1 = identity1.getDefaultKey().getDefaultCertificate();
+
+  std::vector<RequestState> requests(3);
+  for (size_t i = 0; i < requests.size(); i++) {
+    requests[i].caPrefix = Name("/ndn/site1");
+    requests[i].requestId = {{static_cast<uint8_t>(101 + i)}};
+    requests[i].requestType = RequestType::NEW;
+    requests[i].cert = cert1;
+  }
+  storage.addRequest(requests[1]);
+
+  // the duplicate is skipped, the others are committed
+  auto isAdded = storage.addRequests(requests);
+  BOOST_CHECK(isAdded == std::vector<bool>({true, false, true}));
+  BOOST_CHECK_EQUAL(storage.listAllRequests().size(), 3);
+  BOOST_CHECK_EQUAL(storage.getRequest(requests[2].requestId).cert, cert1);
+}
+
+BOOST_AUTO_TEST_CASE(RequestIdKey)
+{
+  auto dbPath = dbDir.string() + "/TestCaSqlite_RequestIdKey.db";
+  Buffer key1, key2;
+  {
+    CaSqlite storage(Name(), dbPath);
+    key1 = storage.getRequestIdKey(Name("/ndn/site1"));
+    key2 = storage.getRequestIdKey(Name("/ndn/site2"));
+    BOOST_CHECK_EQUAL(key1.size(), REQUEST_ID_KEY_SIZE);
+    BOOST_CHECK(key1 != key2);
+    BOOST_CHECK(storage.getRequestIdKey(Name("/ndn/site1")) == key1);
+  }
+
+  // the keys survive reopening the database
+  CaSqlite storage(Name(), dbPath);
+  BOOST_CHECK(storage.getRequestIdKey(Name("/ndn/site1")) == key1);
+  BOOST_CHECK(storage.getRequestIdKey(Name("/ndn/site2")) == key2);
 }
 
 BOOST_AUTO_TEST_SUITE_END() // TestCaModule
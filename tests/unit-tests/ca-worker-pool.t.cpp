@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/ca-worker-pool.hpp"
+#include "test-common.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <set>
+
+namespace ndn {
+namespace ndncert {
+namespace tests {
+
+using namespace ca;
+
+BOOST_AUTO_TEST_SUITE(TestCaWorkerPool)
+
+BOOST_AUTO_TEST_CASE(Construction)
+{
+  BOOST_CHECK_THROW(WorkerPool(0), std::invalid_argument);
+  WorkerPool pool(3);
+  BOOST_CHECK_EQUAL(pool.getWorkerCount(), 3);
+  BOOST_CHECK_EQUAL(WorkerPool::getCurrentWorkerIndex(), WorkerPool::NOT_A_WORKER);
+}
+
+BOOST_AUTO_TEST_CASE(TasksOfOneWorkerInOrder)
+{
+  std::mutex mutex;
+  std::vector<std::vector<int>> executed(2);
+  std::vector<std::vector<size_t>> runOn(2);
+  {
+    WorkerPool pool(2);
+    for (int i = 0; i < 1000; i++) {
+      size_t workerIndex = i % 2;
+      pool.post(workerIndex, [&, workerIndex, i] {
+        std::lock_guard<std::mutex> lock(mutex);
+        executed[workerIndex].push_back(i);
+        runOn[workerIndex].push_back(WorkerPool::getCurrentWorkerIndex());
+      });
+    }
+    // the destructor runs all posted tasks
+  }
+  for (size_t workerIndex = 0; workerIndex < 2; workerIndex++) {
+    BOOST_REQUIRE_EQUAL(executed[workerIndex].size(), 500);
+    BOOST_CHECK(std::is_sorted(executed[workerIndex].begin(), executed[workerIndex].end()));
+    BOOST_CHECK(std::all_of(runOn[workerIndex].begin(), runOn[workerIndex].end(),
+                            [workerIndex] (size_t index) { return index == workerIndex; }));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(WorkerSelection)
+{
+  WorkerPool pool(4);
+  std::set<size_t> selected;
+  for (int i = 0; i < 4; i++) {
+    selected.insert(pool.getNextWorker());
+  }
+  BOOST_CHECK_EQUAL(selected.size(), 4);
+
+  std::array<uint8_t, 8> id1, id2;
+  id1.fill(1);
+  id2.fill(2);
+  auto worker1 = pool.getWorkerForKey(id1.data(), id1.size());
+  BOOST_CHECK_LT(worker1, 4);
+  BOOST_CHECK_EQUAL(pool.getWorkerForKey(id1.data(), id1.size()), worker1);
+  BOOST_CHECK_EQUAL(pool.getWorkerForKey(id2.data(), id2.size()), pool.getWorkerForKey(id2.data(), id2.size()));
+}
+
+BOOST_AUTO_TEST_CASE(ExceptionInTask)
+{
+  std::atomic<int> nRun(0);
+  {
+    WorkerPool pool(1);
+    pool.post(0, [] { NDN_THROW(std::runtime_error("task failed")); });
+    pool.post(0, [&] { nRun++; });
+  }
+  BOOST_CHECK_EQUAL(nRun, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // TestCaWorkerPool
+
+} // namespace tests
+} // namespace ndncert
+} // namespace ndn
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "challenge/challenge-token.hpp"
+#include "test-common.hpp"
+
+#include <ndn-cxx/util/string-helper.hpp>
+
+namespace ndn {
+namespace ndncert {
+namespace tests {
+
+BOOST_FIXTURE_TEST_SUITE(TestChallengeToken, IdentityManagementFixture)
+
+static const std::string TOKEN_CONFIG = "./tests/unit-tests/config-files/config-challenge-token";
+
+static Buffer
+loadHmacKey()
+{
+  ChallengeToken challenge(TOKEN_CONFIG);
+  challenge.parseConfigFile();
+  return challenge.m_hmacKey;
+}
+
+static ca::RequestState
+makeRequestState(const security::Certificate& cert)
+{
+  ca::RequestState state;
+  state.caPrefix = Name("/example");
+  state.requestId = {{101}};
+  state.requestType = RequestType::NEW;
+  state.cert = cert;
+  return state;
+}
+
+BOOST_AUTO_TEST_CASE(LoadConfig)
+{
+  ChallengeToken challenge(TOKEN_CONFIG);
+  BOOST_CHECK_EQUAL(challenge.CHALLENGE_TYPE, "token");
+
+  challenge.parseConfigFile();
+  BOOST_CHECK_EQUAL(challenge.m_hmacKey.size(), 32);
+  BOOST_CHECK_EQUAL(challenge.m_hmacKey[31], 0x1f);
+}
+
+BOOST_AUTO_TEST_CASE(LoadBadConfig)
+{
+  // a configured file is checked when the module is built
+  BOOST_CHECK_THROW(ChallengeToken("./tests/unit-tests/config-files/nonexistent"), std::runtime_error);
+  BOOST_CHECK_THROW(ChallengeToken("./tests/unit-tests/config-files/config-challenge-possession"),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(HandleChallengeRequestUnconfigured)
+{
+  auto cert = addIdentity(Name("/example/device1")).getDefaultKey().getDefaultCertificate();
+  auto state = makeRequestState(cert);
+  ChallengeToken challenge(TOKEN_CONFIG);
+  // the key of the default file is loaded on the first request, which answers if that fails
+  challenge.m_hmacKey.clear();
+  challenge.m_configFile = "./tests/unit-tests/config-files/nonexistent";
+
+  std::multimap<std::string, std::string> params;
+  params.emplace(ChallengeToken::PARAMETER_KEY_TOKEN,
+                 ChallengeToken::generateToken(loadHmacKey(), Name("/example/device1"),
+                                               time::system_clock::now() + time::hours(1)));
+  Block paramsTlv = challenge.genChallengeRequestTLV(state.status, "", params);
+  std::tuple<ErrorCode, std::string> result;
+  BOOST_CHECK_NO_THROW(result = challenge.handleChallengeRequest(paramsTlv, state));
+  BOOST_CHECK_EQUAL(std::get<0>(result), ErrorCode::INVALID_PARAMETER);
+  BOOST_CHECK_EQUAL(statusToString(state.status), statusToString(Status::FAILURE));
+}
+
+BOOST_AUTO_TEST_CASE(HandleChallengeRequest)
+{
+  auto cert = addIdentity(Name("/example/device1")).getDefaultKey().getDefaultCertificate();
+  auto state = makeRequestState(cert);
+  ChallengeToken challenge(TOKEN_CONFIG);
+
+  auto params = challenge.getRequestedParameterList(state.status, "");
+  BOOST_REQUIRE_EQUAL(params.size(), 1);
+  params.begin()->second = ChallengeToken::generateToken(loadHmacKey(), Name("/example/device1"),
+                                                         time::system_clock::now() + time::hours(1));
+  Block paramsTlv = challenge.genChallengeRequestTLV(state.status, "", params);
+  auto result = challenge.handleChallengeRequest(paramsTlv, state);
+
+  // done in one round trip, with nothing to store
+  BOOST_CHECK_EQUAL(std::get<0>(result), ErrorCode::NO_ERROR);
+  BOOST_CHECK_EQUAL(statusToString(state.status), statusToString(Status::PENDING));
+  BOOST_CHECK_EQUAL(state.challengeType, "token");
+  BOOST_CHECK(!state.challengeState);
+}
+
+BOOST_AUTO_TEST_CASE(HandleChallengeRequestOtherIdentity)
+{
+  auto cert = addIdentity(Name("/example/device1")).getDefaultKey().getDefaultCertificate();
+  auto state = makeRequestState(cert);
+  ChallengeToken challenge(TOKEN_CONFIG);
+
+  std::multimap<std::string, std::string> params;
+  params.emplace(ChallengeToken::PARAMETER_KEY_TOKEN,
+                 ChallengeToken::generateToken(loadHmacKey(), Name("/example/device2"),
+                                               time::system_clock::now() + time::hours(1)));
+  Block paramsTlv = challenge.genChallengeRequestTLV(state.status, "", params);
+  auto result = challenge.handleChallengeRequest(paramsTlv, state);
+  BOOST_CHECK_EQUAL(std::get<0>(result), ErrorCode::INVALID_PARAMETER);
+  BOOST_CHECK_EQUAL(statusToString(state.status), statusToString(Status::FAILURE));
+}
+
+BOOST_AUTO_TEST_CASE(HandleChallengeRequestTampered)
+{
+  auto cert = addIdentity(Name("/example/device1")).getDefaultKey().getDefaultCertificate();
+  ChallengeToken challenge(TOKEN_CONFIG);
+
+  // extending the expiration time invalidates the MAC
+  auto token = ChallengeToken::generateToken(loadHmacKey(), Name("/example/device1"),
+                                             time::system_clock::now() + time::hours(1));
+  auto separator = token.find(':');
+  auto extended = std::to_string(std::stoull(token.substr(0, separator)) + 3600) + token.substr(separator);
+  for (const auto& badToken : {extended, std::string("no-separator"), std::string("123:not-hex")}) {
+    auto state = makeRequestState(cert);
+    std::multimap<std::string, std::string> params;
+    params.emplace(ChallengeToken::PARAMETER_KEY_TOKEN, badToken);
+    Block paramsTlv = challenge.genChallengeRequestTLV(state.status, "", params);
+    auto result = challenge.handleChallengeRequest(paramsTlv, state);
+    BOOST_CHECK_EQUAL(std::get<0>(result), ErrorCode::INVALID_PARAMETER);
+    BOOST_CHECK_EQUAL(statusToString(state.status), statusToString(Status::FAILURE));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(HandleChallengeRequestExpired)
+{
+  auto cert = addIdentity(Name("/example/device1")).getDefaultKey().getDefaultCertificate();
+  auto state = makeRequestState(cert);
+  ChallengeToken challenge(TOKEN_CONFIG);
+
+  std::multimap<std::string, std::string> params;
+  params.emplace(ChallengeToken::PARAMETER_KEY_TOKEN,
+                 ChallengeToken::generateToken(loadHmacKey(), Name("/example/device1"),
+                                               time::system_clock::now() - time::seconds(1)));
+  Block paramsTlv = challenge.genChallengeRequestTLV(state.status, "", params);
+  auto result = challenge.handleChallengeRequest(paramsTlv, state);
+  BOOST_CHECK_EQUAL(std::get<0>(result), ErrorCode::OUT_OF_TIME);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndncert
+} // namespace ndn
@@ -19,6 +19,7 @@
  */
 
 #include "detail/ca-configuration.hpp"
+#include "challenge/challenge-module.hpp"
 #include "detail/profile-storage.hpp"
 #include "detail/info-encoder.hpp"
 #include "test-common.hpp"
@@ -71,6 +72,42 @@ BOOST_AUTO_TEST_CASE(CAConfigFile)
   BOOST_CHECK_EQUAL(names[0], Name("/irl/1@1.edu"));
   BOOST_CHECK_EQUAL(names[1], Name("/irl/ndncert"));
   BOOST_CHECK_EQUAL(names[2].size(), 1);
+  BOOST_CHECK_EQUAL(config.nWorkerThreads, 0);
+
+  config.load("tests/unit-tests/config-files/config-ca-8");
+  BOOST_CHECK_EQUAL(config.nWorkerThreads, 2);
+  BOOST_CHECK(config.challengeConfigPaths.empty());
+
+  // the configuration file of a challenge is relative to that of the CA
+  config.load("tests/unit-tests/config-files/config-ca-10");
+  BOOST_REQUIRE_EQUAL(config.challengeConfigPaths.count("token"), 1);
+  BOOST_CHECK_EQUAL(config.challengeConfigPaths["token"],
+                    "tests/unit-tests/config-files/config-challenge-token");
+}
+
+BOOST_AUTO_TEST_CASE(ChallengeTypeCase)
+{
+  // challenge types are matched regardless of case and kept as registered
+  BOOST_CHECK_EQUAL(ChallengeModule::findChallengeType("PIN"), "pin");
+  BOOST_CHECK_EQUAL(ChallengeModule::findChallengeType("possession"), "Possession");
+  BOOST_CHECK_EQUAL(ChallengeModule::findChallengeType("unknown"), "");
+}
+
+BOOST_AUTO_TEST_CASE(CAHostConfigFile)
+{
+  ca::CaHostConfig config;
+  config.load("tests/unit-tests/config-files/config-ca-host-1");
+  BOOST_REQUIRE_EQUAL(config.caConfigFiles.size(), 2);
+  BOOST_CHECK_EQUAL(config.caConfigFiles[0], "tests/unit-tests/config-files/config-ca-1");
+  BOOST_CHECK_EQUAL(config.caConfigFiles[1], "tests/unit-tests/config-files/config-ca-9");
+  BOOST_CHECK_EQUAL(config.nWorkerThreads, 0);
+  BOOST_CHECK_EQUAL(config.storagePath, "");
+
+  // the configuration of a single CA
+  config.load("tests/unit-tests/config-files/config-ca-8");
+  BOOST_REQUIRE_EQUAL(config.caConfigFiles.size(), 1);
+  BOOST_CHECK_EQUAL(config.caConfigFiles[0], "tests/unit-tests/config-files/config-ca-8");
+  BOOST_CHECK_EQUAL(config.nWorkerThreads, 2);
 }
 
 BOOST_AUTO_TEST_CASE(CAConfigFileWithErrors)
@@ -33,11 +33,13 @@ BOOST_AUTO_TEST_CASE(NameAssignmentRandom)
   AssignmentRandom assignment;
   BOOST_CHECK_EQUAL(assignment.assignName(std::multimap<std::string, std::string>()).size(), 1);
   BOOST_CHECK_EQUAL(assignment.assignName(std::multimap<std::string, std::string>()).begin()->size(), 1);
+  BOOST_CHECK(!assignment.isDeterministic());
 }
 
 BOOST_AUTO_TEST_CASE(NameAssignmentParam)
 {
   AssignmentParam assignment("/abc/xyz");
+  BOOST_CHECK(assignment.isDeterministic());
   std::multimap<std::string, std::string> params;
   params.emplace("abc", "123");
   BOOST_CHECK_EQUAL(assignment.assignName(params).size(), 0);
@@ -68,6 +70,24 @@ BOOST_AUTO_TEST_CASE(NameAssignmentHash)
   BOOST_CHECK_EQUAL(assignment.assignName(params).begin()->size(), 2);
 }
 
+BOOST_AUTO_TEST_CASE(RepeatedFormatKeys)
+{
+  AssignmentParam param("/abc/xyz/abc");
+  BOOST_CHECK_EQUAL(param.m_formatKeys.size(), 2);
+  BOOST_CHECK((param.m_formatPlan == std::vector<size_t>{0, 1, 0}));
+  std::multimap<std::string, std::string> params;
+  params.emplace("abc", "123");
+  params.emplace("xyz", "789");
+  params.emplace("abc", "456");
+  BOOST_CHECK_EQUAL(*param.assignName(params).begin(), Name("/123/789/123"));
+
+  AssignmentHash hash("/abc/xyz/abc");
+  auto names = hash.assignName(params);
+  BOOST_REQUIRE_EQUAL(names.size(), 1);
+  BOOST_CHECK_EQUAL(names.begin()->size(), 3);
+  BOOST_CHECK_EQUAL(names.begin()->at(0), names.begin()->at(2));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace tests
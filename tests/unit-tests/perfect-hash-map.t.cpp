@@ -0,0 +1,70 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/perfect-hash-map.hpp"
+#include "challenge/challenge-module.hpp"
+#include "test-common.hpp"
+
+namespace ndn {
+namespace ndncert {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestPerfectHashMap)
+
+BOOST_AUTO_TEST_CASE(Lookup)
+{
+  std::vector<std::pair<std::string, int>> entries;
+  for (int i = 0; i < 100; i++) {
+    entries.emplace_back("key" + std::to_string(i), i);
+  }
+  entries.emplace_back("key7", 1000);
+  PerfectHashMap<int> map(std::move(entries));
+  BOOST_CHECK_EQUAL(map.size(), 100);
+  for (int i = 0; i < 100; i++) {
+    auto value = map.find("key" + std::to_string(i));
+    BOOST_REQUIRE(value != nullptr);
+    BOOST_CHECK_EQUAL(*value, i);
+  }
+  BOOST_CHECK(map.find("key100") == nullptr);
+  BOOST_CHECK(map.find("") == nullptr);
+
+  PerfectHashMap<int> empty;
+  BOOST_CHECK_EQUAL(empty.size(), 0);
+  BOOST_CHECK(empty.find("key1") == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(ChallengeRegistry)
+{
+  for (const std::string type : {"pin", "email", "token", "Possession"}) {
+    auto challenge = ChallengeModule::getChallengeModule(type);
+    BOOST_REQUIRE(challenge != nullptr);
+    BOOST_CHECK_EQUAL(challenge->CHALLENGE_TYPE, type);
+    // the shared instance is created once
+    BOOST_CHECK_EQUAL(ChallengeModule::getChallengeModule(type), challenge);
+  }
+  BOOST_CHECK(ChallengeModule::getChallengeModule("unknown") == nullptr);
+  BOOST_CHECK(!ChallengeModule::isChallengeSupported("unknown"));
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestPerfectHashMap
+
+} // namespace tests
+} // namespace ndncert
+} // namespace ndn
@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "detail/profile-cache.hpp"
+#include "ca-module.hpp"
+#include "test-common.hpp"
+
+#include <ndn-cxx/util/dummy-client-face.hpp>
+
+#include <fstream>
+
+namespace ndn {
+namespace ndncert {
+namespace tests {
+
+using namespace requester;
+
+class ProfileCacheFixture : public DatabaseFixture
+{
+public:
+  ProfileCacheFixture()
+    : face(io, m_keyChain, {true, true})
+  {
+    addIdentity(Name("/ndn"));
+    ca = std::make_unique<ca::CaModule>(face, m_keyChain, "tests/unit-tests/config-files/config-ca-1",
+                                        "ca-storage-memory");
+    advanceClocks(time::milliseconds(20), 60);
+  }
+
+public:
+  util::DummyClientFace face;
+  unique_ptr<ca::CaModule> ca;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestProfileCache, ProfileCacheFixture)
+
+BOOST_AUTO_TEST_CASE(InsertAndConfirm)
+{
+  ProfileCache cache(time::minutes(10));
+  auto now = time::system_clock::now();
+  auto infoData = ca->getCaProfileData();
+  BOOST_CHECK_EQUAL(cache.insert(infoData, now).caPrefix, Name("/ndn"));
+  auto entry = cache.find(Name("/ndn"));
+  BOOST_REQUIRE(entry != nullptr);
+  BOOST_CHECK_EQUAL(entry->version, infoData.getName().at(-2).toVersion());
+  BOOST_CHECK(cache.find(Name("/ndn/site1")) == nullptr);
+
+  // no discovery is needed within the freshness period
+  BOOST_CHECK(cache.isFresh(Name("/ndn"), now + time::minutes(9)));
+  BOOST_CHECK(!cache.isFresh(Name("/ndn"), now + time::minutes(10)));
+
+  // a discovery reply pointing to the cached version confirms the profile
+  auto later = now + time::minutes(20);
+  BOOST_CHECK(cache.confirm(Name("/ndn"), ca->getCaProfileMetadata(), later));
+  BOOST_CHECK(cache.isFresh(Name("/ndn"), later + time::minutes(9)));
+
+  // a regenerated profile has a new version
+  ca->invalidateCaProfileData();
+  advanceClocks(time::milliseconds(1), 2);
+  BOOST_CHECK(!cache.confirm(Name("/ndn"), ca->getCaProfileMetadata(), later));
+
+  // a discovery reply not signed by the CA is ignored
+  auto forged = ca->getCaProfileMetadata();
+  m_keyChain.sign(forged, signingByIdentity(addIdentity(Name("/other"))));
+  BOOST_CHECK(!cache.confirm(Name("/ndn"), forged, later));
+}
+
+BOOST_AUTO_TEST_CASE(RejectInvalid)
+{
+  ProfileCache cache;
+  auto infoData = ca->getCaProfileData();
+  m_keyChain.sign(infoData, signingByIdentity(addIdentity(Name("/other"))));
+  BOOST_CHECK_THROW(cache.insert(infoData), std::runtime_error);
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SaveAndLoad)
+{
+  auto fileName = (dbDir / "profile-cache").string();
+  auto now = time::system_clock::now();
+  ProfileCache cache;
+  cache.insert(ca->getCaProfileData(), now);
+  cache.save(fileName);
+
+  ProfileCache loaded;
+  loaded.load(fileName);
+  BOOST_CHECK_EQUAL(loaded.size(), 1);
+  auto entry = loaded.find(Name("/ndn"));
+  BOOST_REQUIRE(entry != nullptr);
+  BOOST_CHECK(entry->infoData.wireEncode() == ca->getCaProfileData().wireEncode());
+  BOOST_CHECK_EQUAL(entry->profile.maxSuffixLength.value_or(0), 3);
+  BOOST_CHECK_EQUAL(entry->profile.cert->getName(), cache.find(Name("/ndn"))->profile.cert->getName());
+  BOOST_CHECK(time::toUnixTimestamp(entry->confirmedAt) == time::toUnixTimestamp(now));
+
+  // a damaged file leaves the cache untouched
+  std::ofstream(fileName, std::ios::binary | std::ios::app) << "garbage";
+  BOOST_CHECK_THROW(loaded.load(fileName), std::runtime_error);
+  BOOST_CHECK_EQUAL(loaded.size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndncert
+} // namespace ndn
@@ -135,6 +135,50 @@ BOOST_AUTO_TEST_CASE(NewRevokeEncodingData)
   BOOST_CHECK_EQUAL_COLLECTIONS(returnedPub.begin(), returnedPub.end(), pub.begin(), pub.end());
   BOOST_CHECK_EQUAL_COLLECTIONS(returnedSalt.begin(), returnedSalt.end(), salt.begin(), salt.end());
   BOOST_CHECK_EQUAL_COLLECTIONS(returnedId.begin(), returnedId.end(), id.begin(), id.end());
+  BOOST_CHECK_EQUAL_COLLECTIONS(retlist.begin(), retlist.end(), list.begin(), list.end());
+
+  // pre-encoded challenge list yields the same wire encoding
+  auto b2 = requesttlv::encodeDataContent(pub, salt, id, requesttlv::encodeChallengeList(list));
+  BOOST_CHECK_EQUAL(b, b2);
+}
+
+BOOST_AUTO_TEST_CASE(BatchNewEncoding)
+{
+  requester::ProfileStorage caCache;
+  caCache.load("tests/unit-tests/config-files/config-client-1");
+  auto& certRequest = caCache.getKnownProfiles().front().cert;
+  std::vector<uint8_t> pub1 = ECDHState().getSelfPubKey();
+  std::vector<uint8_t> pub2 = ECDHState().getSelfPubKey();
+  auto param = requesttlv::encodeBatchApplicationParameters({requesttlv::encodeBatchEntry(pub1, *certRequest),
+                                                             requesttlv::encodeBatchEntry(pub2, *certRequest)});
+  BOOST_CHECK_EQUAL(requesttlv::countBatchEntries(param), 2);
+  std::vector<std::vector<uint8_t>> returnedPubs;
+  std::vector<shared_ptr<security::Certificate>> returnedCerts;
+  requesttlv::decodeBatchApplicationParameters(param, returnedPubs, returnedCerts);
+  BOOST_REQUIRE_EQUAL(returnedPubs.size(), 2);
+  BOOST_REQUIRE_EQUAL(returnedCerts.size(), 2);
+  BOOST_CHECK(returnedPubs[0] == pub1);
+  BOOST_CHECK(returnedPubs[1] == pub2);
+  BOOST_CHECK_EQUAL(*returnedCerts[1], *certRequest);
+
+  std::vector<requesttlv::BatchResult> results(2);
+  results[0].ecdhKey = pub1;
+  results[0].salt = {{101}};
+  results[0].requestId = {{102}};
+  results[1].error = ErrorCode::BAD_VALIDITY_PERIOD;
+  results[1].errorInfo = "invalid period";
+  std::vector<std::string> list{"abc", "def"};
+  auto content = requesttlv::encodeBatchDataContent(results, requesttlv::encodeChallengeList(list));
+  std::vector<requesttlv::BatchResult> returnedResults;
+  auto retlist = requesttlv::decodeBatchDataContent(content, returnedResults);
+  BOOST_CHECK_EQUAL_COLLECTIONS(retlist.begin(), retlist.end(), list.begin(), list.end());
+  BOOST_REQUIRE_EQUAL(returnedResults.size(), 2);
+  BOOST_CHECK_EQUAL(returnedResults[0].error, ErrorCode::NO_ERROR);
+  BOOST_CHECK(returnedResults[0].ecdhKey == pub1);
+  BOOST_CHECK(returnedResults[0].salt == results[0].salt);
+  BOOST_CHECK(returnedResults[0].requestId == results[0].requestId);
+  BOOST_CHECK_EQUAL(returnedResults[1].error, ErrorCode::BAD_VALIDITY_PERIOD);
+  BOOST_CHECK_EQUAL(returnedResults[1].errorInfo, "invalid period");
 }
 
 BOOST_AUTO_TEST_CASE(ChallengeEncoding)
@@ -170,6 +214,20 @@ BOOST_AUTO_TEST_CASE(ChallengeEncoding)
   BOOST_CHECK_EQUAL(context.m_issuedCertName, "/ndn/ucla/a/b/c");
 }
 
+BOOST_AUTO_TEST_CASE(NameConcatenation)
+{
+  BOOST_CHECK_EQUAL(concatenateNames(Name("/ndn/ucla"), PartialName("/alice/laptop")), Name("/ndn/ucla/alice/laptop"));
+  BOOST_CHECK_EQUAL(concatenateNames(Name("/ndn"), PartialName()), Name("/ndn"));
+  BOOST_CHECK_EQUAL(concatenateNames(Name(), PartialName("/alice")), Name("/alice"));
+
+  // a suffix long enough to need a three-octet TLV-LENGTH
+  PartialName suffix;
+  suffix.append(std::string(300, 'a'));
+  auto name = concatenateNames(Name("/ndn"), suffix);
+  BOOST_CHECK_EQUAL(name.size(), 2);
+  BOOST_CHECK_EQUAL(name, Name("/ndn").append(suffix));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace tests
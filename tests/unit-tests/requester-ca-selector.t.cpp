@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "requester-ca-selector.hpp"
+#include "ca-module.hpp"
+#include "test-common.hpp"
+
+#include <ndn-cxx/util/dummy-client-face.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
+
+namespace ndn {
+namespace ndncert {
+namespace tests {
+
+using namespace requester;
+
+class CaSelectorFixture : public DatabaseFixture
+{
+public:
+  CaSelectorFixture()
+    : caFace(io, m_keyChain, {true, true})
+    , requesterFace(io, m_keyChain, {true, true})
+    , scheduler(io)
+  {
+    auto rootCert = addIdentity(Name("/ndn")).getDefaultKey().getDefaultCertificate();
+    auto siteCert = addIdentity(Name("/ndn/site1")).getDefaultKey().getDefaultCertificate();
+    auto deadCert = addIdentity(Name("/dead")).getDefaultKey().getDefaultCertificate();
+
+    std::stringstream siteCertBase64;
+    security::transform::bufferSource(siteCert.wireEncode().wire(), siteCert.wireEncode().size())
+      >> security::transform::base64Encode(false) >> security::transform::streamSink(siteCertBase64);
+    JsonSection redirect;
+    redirect.put(CONFIG_CA_PREFIX, "/ndn/site1");
+    redirect.put(CONFIG_CERTIFICATE, siteCertBase64.str());
+    JsonSection redirects;
+    redirects.push_back(std::make_pair("", redirect));
+
+    rootCa = makeCa(Name("/ndn"), &redirects);
+    siteCa = makeCa(Name("/ndn/site1"), nullptr);
+    advanceClocks(time::milliseconds(20), 60);
+
+    // the CA profile packets are served by the application hosting the CA
+    caFace.setInterestFilter(InterestFilter("/ndn/site1/CA/INFO"), [this] (const auto&, const Interest& interest) {
+      auto profileData = siteCa->getCaProfileData();
+      if (interest.getName().isPrefixOf(profileData.getName())) {
+        caFace.put(profileData);
+      }
+    }, nullptr, nullptr);
+    advanceClocks(time::milliseconds(20), 60);
+
+    profiles.push_back(makeProfile(Name("/ndn"), rootCert));
+    profiles.push_back(makeProfile(Name("/dead"), deadCert));
+
+    // the root CA answers its PROBEs slowly
+    requesterFace.onSendInterest.connect([this] (const Interest& interest) {
+      io.post([this, interest] { caFace.receive(interest); });
+    });
+    caFace.onSendData.connect([this] (const Data& data) {
+      auto delay = Name("/ndn/CA/PROBE").isPrefixOf(data.getName()) ? time::milliseconds(50) : time::milliseconds(1);
+      scheduler.schedule(delay, [this, data] { requesterFace.receive(data); });
+    });
+  }
+
+  unique_ptr<ca::CaModule>
+  makeCa(const Name& caPrefix, const JsonSection* redirects)
+  {
+    JsonSection config;
+    config.put(CONFIG_CA_PREFIX, caPrefix.toUri());
+    config.put(CONFIG_CA_INFO, "test ca");
+    config.put(CONFIG_MAX_VALIDITY_PERIOD, "864000");
+    config.put(CONFIG_MAX_SUFFIX_LENGTH, "3");
+    JsonSection probeParameter;
+    probeParameter.put(CONFIG_PROBE_PARAMETER, "full name");
+    JsonSection probeParameters;
+    probeParameters.push_back(std::make_pair("", probeParameter));
+    config.add_child(CONFIG_PROBE_PARAMETERS, probeParameters);
+    JsonSection challenge;
+    challenge.put(CONFIG_CHALLENGE, "pin");
+    JsonSection challenges;
+    challenges.push_back(std::make_pair("", challenge));
+    config.add_child(CONFIG_SUPPORTED_CHALLENGES, challenges);
+    if (redirects != nullptr) {
+      config.add_child(CONFIG_REDIRECTION, *redirects);
+    }
+    config.put(CONFIG_NAME_ASSIGNMENT + ".random", "");
+
+    auto configPath = (dbDir / ("config-" + std::to_string(caPrefix.size()))).string();
+    boost::property_tree::write_json(configPath, config);
+    return std::make_unique<ca::CaModule>(caFace, m_keyChain, configPath, "ca-storage-memory");
+  }
+
+  static CaProfile
+  makeProfile(const Name& caPrefix, const security::Certificate& cert)
+  {
+    CaProfile profile;
+    profile.caPrefix = caPrefix;
+    profile.probeParameterKeys.push_back("full name");
+    profile.cert = std::make_shared<security::Certificate>(cert);
+    return profile;
+  }
+
+public:
+  util::DummyClientFace caFace;
+  util::DummyClientFace requesterFace;
+  Scheduler scheduler;
+  unique_ptr<ca::CaModule> rootCa;
+  unique_ptr<ca::CaModule> siteCa;
+  std::list<CaProfile> profiles;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestCaSelector, CaSelectorFixture)
+
+BOOST_AUTO_TEST_CASE(ProbeAndRank)
+{
+  CaSelector selector(requesterFace);
+  std::vector<ProbeResult> results;
+  bool isComplete = false;
+  selector.probe(profiles, {{"full name", "zhiyi"}}, [&] (std::vector<ProbeResult>&& rankedResults) {
+    isComplete = true;
+    results = std::move(rankedResults);
+  });
+  advanceClocks(time::milliseconds(10), 400);
+  BOOST_REQUIRE(isComplete);
+  BOOST_REQUIRE_EQUAL(results.size(), 3);
+
+  // the CA found through the redirection answers faster than the root CA
+  BOOST_CHECK_EQUAL(results[0].profile.caPrefix, Name("/ndn/site1"));
+  BOOST_CHECK_EQUAL(results[0].outcome, ProbeResult::Outcome::OK);
+  BOOST_CHECK_EQUAL(results[0].redirectDepth, 1);
+  BOOST_CHECK_EQUAL(results[0].availableNames.size(), 1);
+  BOOST_CHECK(results[0].profile.cert != nullptr);
+
+  BOOST_CHECK_EQUAL(results[1].profile.caPrefix, Name("/ndn"));
+  BOOST_CHECK_EQUAL(results[1].outcome, ProbeResult::Outcome::OK);
+  BOOST_CHECK_EQUAL(results[1].redirects.size(), 1);
+  BOOST_CHECK_GE(results[1].rtt, time::milliseconds(50));
+  BOOST_CHECK_LT(results[0].rtt, results[1].rtt);
+
+  BOOST_CHECK_EQUAL(results[2].profile.caPrefix, Name("/dead"));
+  BOOST_CHECK_EQUAL(results[2].outcome, ProbeResult::Outcome::TIMEOUT);
+}
+
+BOOST_AUTO_TEST_CASE(MissingParameter)
+{
+  CaSelectorOptions options;
+  options.maxRedirectDepth = 0;
+  CaSelector selector(requesterFace, options);
+  std::vector<ProbeResult> results;
+  selector.probe(profiles, {}, [&] (std::vector<ProbeResult>&& rankedResults) {
+    results = std::move(rankedResults);
+  });
+  // nothing is sent when no CA can be asked
+  BOOST_REQUIRE_EQUAL(results.size(), 2);
+  BOOST_CHECK_EQUAL(results[0].outcome, ProbeResult::Outcome::ERROR);
+  BOOST_CHECK_EQUAL(results[1].outcome, ProbeResult::Outcome::ERROR);
+  BOOST_CHECK_EQUAL(requesterFace.sentInterests.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Rank)
+{
+  std::vector<ProbeResult> results(4);
+  results[0].profile.caPrefix = Name("/timeout");
+  results[1].profile.caPrefix = Name("/nack");
+  results[1].outcome = ProbeResult::Outcome::NACK;
+  results[2].profile.caPrefix = Name("/slow");
+  results[2].outcome = ProbeResult::Outcome::OK;
+  results[2].availableNames.emplace_back(Name("/slow/a"), 1);
+  results[2].rtt = time::milliseconds(30);
+  results[3].profile.caPrefix = Name("/fast");
+  results[3].outcome = ProbeResult::Outcome::OK;
+  results[3].availableNames.emplace_back(Name("/fast/a"), 1);
+  results[3].rtt = time::milliseconds(10);
+
+  CaSelector::rank(results);
+  BOOST_CHECK_EQUAL(results[0].profile.caPrefix, Name("/fast"));
+  BOOST_CHECK_EQUAL(results[1].profile.caPrefix, Name("/slow"));
+  BOOST_CHECK_EQUAL(results[2].profile.caPrefix, Name("/nack"));
+  BOOST_CHECK_EQUAL(results[3].profile.caPrefix, Name("/timeout"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndncert
+} // namespace ndn
@@ -0,0 +1,194 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "requester-engine.hpp"
+#include "ca-module.hpp"
+#include "challenge/challenge-token.hpp"
+#include "test-common.hpp"
+
+#include <ndn-cxx/util/dummy-client-face.hpp>
+#include <ndn-cxx/util/string-helper.hpp>
+
+namespace ndn {
+namespace ndncert {
+namespace tests {
+
+using namespace requester;
+
+class EnrollmentEngineFixture : public DatabaseFixture
+{
+public:
+  EnrollmentEngineFixture()
+    : caFace(io, m_keyChain, {true, true})
+    , requesterFace(io, m_keyChain, {true, true})
+  {
+    hmacKey = *fromHex("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f");
+    caCert = addIdentity(Name("/ndn")).getDefaultKey().getDefaultCertificate();
+    ca = std::make_unique<ca::CaModule>(caFace, m_keyChain, "tests/unit-tests/config-files/config-ca-10",
+                                        "ca-storage-memory");
+    advanceClocks(time::milliseconds(20), 60);
+
+    profile.caPrefix = Name("/ndn");
+    profile.cert = std::make_shared<security::Certificate>(caCert);
+
+    // connect the two faces, dropping the first few Interests to exercise the retransmissions
+    requesterFace.onSendInterest.connect([this] (const Interest& interest) {
+      if (nDroppedInterests > 0) {
+        nDroppedInterests--;
+        return;
+      }
+      // /<ca-prefix>/CA/<type>/...
+      auto typeIndex = profile.caPrefix.size() + 1;
+      auto dropped = interest.getName().size() > typeIndex ?
+                     nDroppedByType.find(interest.getName()[typeIndex]) : nDroppedByType.end();
+      if (dropped != nDroppedByType.end() && dropped->second > 0) {
+        dropped->second--;
+        return;
+      }
+      io.post([this, interest] { caFace.receive(interest); });
+    });
+    caFace.onSendData.connect([this] (const Data& data) {
+      io.post([this, data] { requesterFace.receive(data); });
+    });
+  }
+
+  EnrollmentTask
+  makeTask(const Name& identityName)
+  {
+    EnrollmentTask task;
+    task.identityName = identityName;
+    task.challengeType = "token";
+    task.challengeParameters.emplace(ChallengeToken::PARAMETER_KEY_TOKEN,
+                                     ChallengeToken::generateToken(hmacKey, identityName,
+                                                                   time::system_clock::now() + time::hours(1)));
+    return task;
+  }
+
+public:
+  util::DummyClientFace caFace;
+  util::DummyClientFace requesterFace;
+  Buffer hmacKey;
+  security::Certificate caCert;
+  unique_ptr<ca::CaModule> ca;
+  CaProfile profile;
+  int nDroppedInterests = 0;
+  /**
+   * The number of Interests to drop of each type, e.g., CHALLENGE
+   */
+  std::map<name::Component, int> nDroppedByType;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestEnrollmentEngine, EnrollmentEngineFixture)
+
+BOOST_AUTO_TEST_CASE(EnrollMany)
+{
+  EnrollmentOptions options;
+  options.maxInFlight = 2;
+  options.validityPeriod = time::days(1);
+  options.wantFetchCertificate = false;
+  EnrollmentEngine engine(requesterFace, m_keyChain, profile, options);
+  nDroppedInterests = 2;
+
+  std::vector<EnrollmentTask> tasks;
+  for (int i = 0; i < 5; i++) {
+    tasks.push_back(makeTask(Name("/ndn").append("service" + std::to_string(i))));
+  }
+  // the suffix is longer than the CA allows
+  tasks.push_back(makeTask(Name("/ndn/a/b")));
+
+  size_t maxInFlight = 0;
+  engine.setProgressCallback([&] (const Request&) {
+    maxInFlight = std::max(maxInFlight, engine.getInFlightCount());
+  });
+  std::vector<Name> enrolled;
+  engine.setResultCallback([&] (const Name& identityName, const shared_ptr<security::Certificate>&,
+                                const std::string& error) {
+    if (error.empty()) {
+      enrolled.push_back(identityName);
+    }
+  });
+  bool isComplete = false;
+  engine.enroll(std::move(tasks), [&] (const EnrollmentSummary& summary) {
+    isComplete = true;
+    BOOST_CHECK_EQUAL(summary.nSucceeded, 5);
+    BOOST_CHECK_EQUAL(summary.nFailed, 1);
+    BOOST_CHECK_EQUAL(summary.nRetransmissions, 2);
+    BOOST_REQUIRE_EQUAL(summary.failures.size(), 1);
+    BOOST_CHECK_EQUAL(summary.failures.front().first, Name("/ndn/a/b"));
+  });
+  BOOST_CHECK_EQUAL(engine.getInFlightCount(), 2);
+  BOOST_CHECK_EQUAL(engine.getQueuedCount(), 4);
+
+  advanceClocks(time::milliseconds(100), 200);
+  BOOST_CHECK(isComplete);
+  BOOST_CHECK_EQUAL(enrolled.size(), 5);
+  BOOST_CHECK_LE(maxInFlight, 2);
+  // the token challenge finishes in one round trip, after which the CA forgets the request
+  BOOST_CHECK_EQUAL(ca->getCaStorage()->listAllRequests().size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(GiveUpAfterRetries)
+{
+  EnrollmentOptions options;
+  options.maxRetries = 2;
+  options.validityPeriod = time::days(1);
+  options.interestLifetime = time::seconds(1);
+  EnrollmentEngine engine(requesterFace, m_keyChain, profile, options);
+  nDroppedInterests = 100;
+
+  bool isComplete = false;
+  engine.enroll({makeTask(Name("/ndn/service"))}, [&] (const EnrollmentSummary& summary) {
+    isComplete = true;
+    BOOST_CHECK_EQUAL(summary.nSucceeded, 0);
+    BOOST_CHECK_EQUAL(summary.nFailed, 1);
+    BOOST_CHECK_EQUAL(summary.nRetransmissions, 2);
+  });
+  advanceClocks(time::milliseconds(100), 100);
+  BOOST_CHECK(isComplete);
+}
+
+BOOST_AUTO_TEST_CASE(RetriesPerStage)
+{
+  EnrollmentOptions options;
+  options.maxRetries = 1;
+  options.validityPeriod = time::days(1);
+  options.interestLifetime = time::seconds(1);
+  options.wantFetchCertificate = false;
+  EnrollmentEngine engine(requesterFace, m_keyChain, profile, options);
+  // one loss in each stage is within the limit of each stage, though not of the whole exchange
+  nDroppedByType[name::Component("NEW")] = 1;
+  nDroppedByType[name::Component("CHALLENGE")] = 1;
+
+  bool isComplete = false;
+  engine.enroll({makeTask(Name("/ndn/service"))}, [&] (const EnrollmentSummary& summary) {
+    isComplete = true;
+    BOOST_CHECK_EQUAL(summary.nSucceeded, 1);
+    BOOST_CHECK_EQUAL(summary.nFailed, 0);
+    BOOST_CHECK_EQUAL(summary.nRetransmissions, 2);
+  });
+  advanceClocks(time::milliseconds(100), 100);
+  BOOST_CHECK(isComplete);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndncert
+} // namespace ndn
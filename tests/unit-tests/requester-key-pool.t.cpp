@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "requester-key-pool.hpp"
+#include "requester-request.hpp"
+#include "test-common.hpp"
+
+#include <ndn-cxx/security/verification-helpers.hpp>
+
+#include <thread>
+
+namespace ndn {
+namespace ndncert {
+namespace tests {
+
+using namespace requester;
+
+static bool
+waitUntilFilled(const KeyPairPool& pool)
+{
+  for (int i = 0; i < 500 && pool.size() < pool.getCapacity(); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return pool.size() >= pool.getCapacity();
+}
+
+BOOST_FIXTURE_TEST_SUITE(TestKeyPairPool, IdentityManagementFixture)
+
+BOOST_AUTO_TEST_CASE(Acquire)
+{
+  KeyPairPool pool(2);
+  BOOST_REQUIRE(waitUntilFilled(pool));
+
+  auto key = pool.acquire(m_keyChain, Name("/ndn/a"));
+  BOOST_CHECK_EQUAL(pool.getMissCount(), 0);
+  auto identity = m_keyChain.getPib().getIdentity(Name("/ndn/a"));
+  BOOST_CHECK_EQUAL(identity.getDefaultKey().getName(), key.getName());
+  BOOST_CHECK_EQUAL(key.getIdentity(), Name("/ndn/a"));
+
+  // the key works and has a self-signed certificate
+  auto cert = key.getDefaultCertificate();
+  BOOST_CHECK(security::verifySignature(cert, cert));
+  Data data(Name("/ndn/a/data"));
+  m_keyChain.sign(data, signingByKey(key.getName()));
+  BOOST_CHECK(security::verifySignature(data, cert));
+
+  m_keyChain.deleteIdentity(identity);
+}
+
+BOOST_AUTO_TEST_CASE(EmptyPool)
+{
+  KeyPairPool pool(0);
+  auto key = pool.acquire(m_keyChain, Name("/ndn/a"));
+  BOOST_CHECK_EQUAL(pool.getMissCount(), 1);
+  BOOST_CHECK_EQUAL(key.getIdentity(), Name("/ndn/a"));
+  BOOST_CHECK(security::verifySignature(key.getDefaultCertificate(), key.getDefaultCertificate()));
+  m_keyChain.deleteIdentity(m_keyChain.getPib().getIdentity(Name("/ndn/a")));
+}
+
+BOOST_AUTO_TEST_CASE(ReclaimOnEndSession)
+{
+  auto caCert = addIdentity(Name("/ndn")).getDefaultKey().getDefaultCertificate();
+  CaProfile profile;
+  profile.caPrefix = Name("/ndn");
+  profile.cert = std::make_shared<security::Certificate>(caCert);
+
+  KeyPairPool pool(1);
+  BOOST_REQUIRE(waitUntilFilled(pool));
+
+  Request request(m_keyChain, profile, RequestType::NEW);
+  request.setKeyPairPool(&pool);
+  auto now = time::system_clock::now();
+  BOOST_REQUIRE(request.genNewInterest(Name("/ndn/a"), now, now + time::days(1)) != nullptr);
+  auto publicKey = m_keyChain.getPib().getIdentity(Name("/ndn/a")).getDefaultKey().getPublicKey();
+
+  // the aborted session deletes the identity and hands its key pair to the next request
+  request.endSession();
+  BOOST_CHECK_THROW(m_keyChain.getPib().getIdentity(Name("/ndn/a")), security::Pib::Error);
+  auto key = pool.acquire(m_keyChain, Name("/ndn/b"));
+  BOOST_CHECK(key.getPublicKey() == publicKey);
+  m_keyChain.deleteIdentity(m_keyChain.getPib().getIdentity(Name("/ndn/b")));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndncert
+} // namespace ndn
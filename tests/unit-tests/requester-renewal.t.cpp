@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "requester-renewal.hpp"
+#include "test-common.hpp"
+
+#include <set>
+
+namespace ndn {
+namespace ndncert {
+namespace tests {
+
+using namespace requester;
+
+class RenewalFixture : public DatabaseFixture
+{
+public:
+  RenewalFixture()
+  {
+    caIdentity = addIdentity(Name("/ndn"));
+  }
+
+  security::Certificate
+  issueCertificate(const security::pib::Key& key, const security::pib::Identity& issuer,
+                   const time::system_clock::TimePoint& notBefore, const time::system_clock::TimePoint& notAfter)
+  {
+    security::Certificate cert;
+    cert.setName(Name(key.getName()).append("NDNCERT").appendVersion());
+    cert.setContentType(ndn::tlv::ContentType_Key);
+    cert.setContent(key.getPublicKey().data(), key.getPublicKey().size());
+    SignatureInfo signatureInfo;
+    signatureInfo.setValidityPeriod(security::ValidityPeriod(notBefore, notAfter));
+    m_keyChain.sign(cert, signingByIdentity(issuer).setSignatureInfo(signatureInfo));
+    m_keyChain.addCertificate(key, cert);
+    return cert;
+  }
+
+public:
+  security::pib::Identity caIdentity;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestRenewalScheduler, RenewalFixture)
+
+BOOST_AUTO_TEST_CASE(Scan)
+{
+  auto now = time::system_clock::now();
+  auto key1 = addIdentity(Name("/ndn/a")).getDefaultKey();
+  issueCertificate(key1, caIdentity, now - time::days(1), now + time::days(9));
+  auto newer = issueCertificate(key1, caIdentity, now, now + time::days(10));
+  // issued by a CA that is not configured
+  auto otherCa = addIdentity(Name("/other"));
+  auto key2 = addIdentity(Name("/other/b")).getDefaultKey();
+  issueCertificate(key2, otherCa, now, now + time::days(10));
+
+  RenewalScheduler renewals({Name("/ndn")});
+  BOOST_CHECK_EQUAL(renewals.scan(m_keyChain.getPib()), 1);
+  auto entry = renewals.find(Name("/ndn/a"));
+  BOOST_REQUIRE(entry != nullptr);
+  BOOST_CHECK_EQUAL(entry->certName, newer.getName());
+  BOOST_CHECK_EQUAL(entry->caPrefix, Name("/ndn"));
+  BOOST_CHECK(renewals.find(Name("/other/b")) == nullptr);
+  // the self-signed certificates of the fixture are not tracked
+  BOOST_CHECK(renewals.find(Name("/ndn")) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(JitteredDeadlines)
+{
+  RenewalOptions options;
+  options.renewAt = 0.5;
+  options.jitter = 0.2;
+  RenewalScheduler renewals({Name("/ndn")}, options);
+
+  auto now = time::system_clock::now();
+  security::ValidityPeriod validity(now, now + time::days(10));
+  std::set<time::system_clock::TimePoint> deadlines;
+  for (int i = 0; i < 50; i++) {
+    auto deadline = renewals.computeDeadline(validity, now);
+    BOOST_CHECK_LE(deadline, now + time::days(5));
+    BOOST_CHECK_GE(deadline, now + time::days(3) - time::seconds(1));
+    deadlines.insert(deadline);
+  }
+  BOOST_CHECK_GT(deadlines.size(), 1);
+
+  // past its renewal time, spread over the first half of the remaining period
+  security::ValidityPeriod late(now - time::days(9), now + time::days(1));
+  auto deadline = renewals.computeDeadline(late, now);
+  BOOST_CHECK_GE(deadline, now);
+  BOOST_CHECK_LE(deadline, now + time::hours(12));
+
+  security::ValidityPeriod expired(now - time::days(10), now - time::days(1));
+  BOOST_CHECK(renewals.computeDeadline(expired, now) == now);
+}
+
+BOOST_AUTO_TEST_CASE(PopDueAndRetry)
+{
+  RenewalOptions options;
+  options.minRetryDelay = time::seconds(60);
+  options.maxRetryDelay = time::seconds(200);
+  RenewalScheduler renewals({Name("/ndn")}, options);
+
+  auto now = time::system_clock::now();
+  for (int i = 0; i < 5; i++) {
+    auto key = addIdentity(Name("/ndn").append(std::to_string(i))).getDefaultKey();
+    // the later the identity, the earlier its certificate expires
+    issueCertificate(key, caIdentity, now - time::days(10), now + time::days(10 - i));
+  }
+  BOOST_CHECK_EQUAL(renewals.scan(m_keyChain.getPib()), 5);
+  BOOST_CHECK(renewals.popDue(now, 10).empty());
+  BOOST_REQUIRE(renewals.getNextDeadline());
+
+  auto due = renewals.popDue(now + time::days(20), 3);
+  BOOST_REQUIRE_EQUAL(due.size(), 3);
+  for (size_t i = 1; i < due.size(); i++) {
+    BOOST_CHECK_LE(due[i - 1].deadline, due[i].deadline);
+  }
+  // popped identities are not returned again until their renewal finishes
+  BOOST_CHECK_EQUAL(renewals.popDue(now + time::days(20), 10).size(), 2);
+  BOOST_CHECK(!renewals.getNextDeadline());
+
+  renewals.reportFailure(due[0].identityName, now);
+  BOOST_CHECK(*renewals.getNextDeadline() == now + time::seconds(60));
+  BOOST_REQUIRE_EQUAL(renewals.popDue(now + time::seconds(60), 10).size(), 1);
+  renewals.reportFailure(due[0].identityName, now);
+  BOOST_CHECK(*renewals.getNextDeadline() == now + time::seconds(120));
+  renewals.popDue(now + time::days(1), 10);
+  renewals.reportFailure(due[0].identityName, now);
+  BOOST_CHECK(*renewals.getNextDeadline() == now + time::seconds(200));
+  BOOST_CHECK_EQUAL(renewals.find(due[0].identityName)->nFailures, 3);
+
+  // a renewed certificate replaces the entry and clears the failures
+  auto key = m_keyChain.getPib().getIdentity(due[0].identityName).getDefaultKey();
+  auto renewed = issueCertificate(key, caIdentity, now, now + time::days(30));
+  BOOST_CHECK(renewals.add(renewed));
+  BOOST_CHECK_EQUAL(renewals.find(due[0].identityName)->nFailures, 0);
+  BOOST_CHECK_EQUAL(renewals.find(due[0].identityName)->certName, renewed.getName());
+  BOOST_CHECK_GT(*renewals.getNextDeadline(), now + time::days(10));
+}
+
+BOOST_AUTO_TEST_CASE(SaveAndLoad)
+{
+  auto now = time::system_clock::now();
+  auto key = addIdentity(Name("/ndn/a")).getDefaultKey();
+  auto cert = issueCertificate(key, caIdentity, now, now + time::days(10));
+  auto stateFile = (dbDir / "renewd.json").string();
+
+  RenewalScheduler renewals({Name("/ndn")});
+  renewals.scan(m_keyChain.getPib());
+  renewals.popDue(now + time::days(20), 1);
+  renewals.reportFailure(Name("/ndn/a"), now);
+  renewals.save(stateFile);
+
+  // the restarted scheduler keeps the deadline instead of drawing a new one
+  RenewalScheduler restarted({Name("/ndn")});
+  restarted.load(stateFile);
+  restarted.scan(m_keyChain.getPib());
+  auto entry = restarted.find(Name("/ndn/a"));
+  BOOST_REQUIRE(entry != nullptr);
+  BOOST_CHECK_EQUAL(entry->nFailures, 1);
+  BOOST_CHECK(time::toUnixTimestamp(entry->deadline) == time::toUnixTimestamp(now + time::seconds(60)));
+  BOOST_CHECK_EQUAL(entry->certName, cert.getName());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndncert
+} // namespace ndn
@@ -25,6 +25,10 @@
 #include "ca-module.hpp"
 #include "test-common.hpp"
 
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
 namespace ndn {
 namespace ndncert {
 namespace tests {
@@ -81,7 +85,7 @@ BOOST_AUTO_TEST_CASE(OnProbeResponse){
   Data reply;
   reply.setName(Name("/site/CA/PROBE"));
   reply.setFreshnessPeriod(time::seconds(100));
-  reply.setContent(probetlv::encodeDataContent(availableNames, 3, ca.m_config.redirection));
+  reply.setContent(probetlv::encodeDataContent(availableNames, 3, ca.getCaConf().redirection));
   m_keyChain.sign(reply, signingByIdentity(identity));
 
   std::vector<std::pair<Name, int>> names;
@@ -124,6 +128,111 @@ BOOST_AUTO_TEST_CASE(ErrorHandling)
   BOOST_CHECK_THROW(state.onChallengeResponse(errorPacket), std::runtime_error);
 }
 
+BOOST_AUTO_TEST_CASE(ResumeSavedSession)
+{
+  auto cert = addIdentity(Name("/ndn")).getDefaultKey().getDefaultCertificate();
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  ca::CaModule ca(face, m_keyChain, "tests/unit-tests/config-files/config-ca-1", "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+
+  CaProfile item;
+  item.caPrefix = Name("/ndn");
+  item.maxValidityPeriod = time::days(10);
+  item.cert = std::make_shared<security::Certificate>(cert);
+  auto stateFile = (boost::filesystem::path(TMP_TESTS_PATH) / "requester-state").string();
+
+  unique_ptr<Request> resumed;
+  face.onSendData.connect([&](const Data& response) {
+    if (Name("/ndn/CA/NEW").isPrefixOf(response.getName())) {
+      Request state(m_keyChain, item, RequestType::NEW);
+      // the state is encoded only once the CA has replied
+      BOOST_CHECK_THROW(state.encodeState(), std::runtime_error);
+    }
+    else if (Name("/ndn/CA/CHALLENGE").isPrefixOf(response.getName())) {
+      resumed->onChallengeResponse(response);
+      BOOST_CHECK(resumed->m_status == Status::CHALLENGE);
+      BOOST_CHECK_EQUAL(resumed->m_challengeStatus, "need-code");
+    }
+  });
+
+  Request state(m_keyChain, item, RequestType::NEW);
+  auto newInterest = state.genNewInterest(Name("/ndn/zhiyi"), time::system_clock::now(),
+                                          time::system_clock::now() + time::days(1));
+  face.receive(*newInterest);
+  advanceClocks(time::milliseconds(20), 60);
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 1);
+  state.onNewRenewRevokeResponse(face.sentData.back());
+  state.saveState(stateFile);
+
+  // another process picks the request up where it was left
+  resumed = Request::loadState(m_keyChain, stateFile);
+  BOOST_CHECK_EQUAL(resumed->m_caProfile.caPrefix, Name("/ndn"));
+  BOOST_CHECK_EQUAL(resumed->m_identityName, Name("/ndn/zhiyi"));
+  BOOST_CHECK(resumed->m_requestId == state.m_requestId);
+  BOOST_CHECK(resumed->m_aesKey == state.m_aesKey);
+  BOOST_CHECK(resumed->m_status == state.m_status);
+
+  auto paramList = resumed->selectOrContinueChallenge("pin");
+  face.receive(*resumed->genChallengeInterest(std::move(paramList)));
+  advanceClocks(time::milliseconds(20), 60);
+  BOOST_CHECK_EQUAL(face.sentData.size(), 2);
+
+  // a damaged state is rejected
+  std::ofstream(stateFile, std::ios::binary | std::ios::trunc) << "garbage";
+  BOOST_CHECK_THROW(Request::loadState(m_keyChain, stateFile), std::runtime_error);
+  boost::filesystem::remove(stateFile);
+}
+
+BOOST_AUTO_TEST_CASE(ResumeAfterCrash)
+{
+  auto cert = addIdentity(Name("/ndn")).getDefaultKey().getDefaultCertificate();
+  util::DummyClientFace face(io, m_keyChain, {true, true});
+  ca::CaModule ca(face, m_keyChain, "tests/unit-tests/config-files/config-ca-1", "ca-storage-memory");
+  advanceClocks(time::milliseconds(20), 60);
+
+  CaProfile item;
+  item.caPrefix = Name("/ndn");
+  item.maxValidityPeriod = time::days(10);
+  item.cert = std::make_shared<security::Certificate>(cert);
+  auto stateFile = (boost::filesystem::path(TMP_TESTS_PATH) / "requester-state").string();
+
+  auto getIv = [] (const Interest& interest) {
+    const auto& params = interest.getApplicationParameters();
+    params.parse();
+    const auto& iv = params.get(tlv::InitializationVector);
+    return std::vector<uint8_t>(iv.value_begin(), iv.value_end());
+  };
+
+  shared_ptr<Interest> sentInterest;
+  {
+    Request state(m_keyChain, item, RequestType::NEW);
+    state.setStateFile(stateFile);
+    face.receive(*state.genNewInterest(Name("/ndn/zhiyi"), time::system_clock::now(),
+                                       time::system_clock::now() + time::days(1)));
+    advanceClocks(time::milliseconds(20), 60);
+    BOOST_REQUIRE_EQUAL(face.sentData.size(), 1);
+    state.onNewRenewRevokeResponse(face.sentData.back());
+
+    // the process dies after the CHALLENGE interest is sent, before its reply arrives
+    auto paramList = state.selectOrContinueChallenge("pin");
+    sentInterest = state.genChallengeInterest(std::move(paramList));
+    face.receive(*sentInterest);
+    advanceClocks(time::milliseconds(20), 60);
+  }
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 2);
+
+  auto resumed = Request::loadState(m_keyChain, stateFile);
+  auto paramList = resumed->selectOrContinueChallenge("pin");
+  auto resentInterest = resumed->genChallengeInterest(std::move(paramList));
+  auto sentIv = getIv(*sentInterest);
+  auto resentIv = getIv(*resentInterest);
+  // same random part, counter moved past the one already used
+  BOOST_CHECK(std::equal(sentIv.begin(), sentIv.begin() + 8, resentIv.begin()));
+  BOOST_CHECK(std::lexicographical_compare(sentIv.begin() + 8, sentIv.end(),
+                                           resentIv.begin() + 8, resentIv.end()));
+  boost::filesystem::remove(stateFile);
+}
+
 BOOST_AUTO_TEST_SUITE_END() // TestRequester
 
 } // namespace tests
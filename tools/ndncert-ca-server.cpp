@@ -18,7 +18,8 @@
  * See AUTHORS.md for complete list of ndncert authors and contributors.
  */
 
-#include "ca-module.hpp"
+#include "ca-host.hpp"
+#include "detail/ca-audit-log.hpp"
 #include <boost/asio.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/program_options/options_description.hpp>
@@ -29,6 +30,7 @@
 #include <deque>
 #include <ndn-cxx/face.hpp>
 #include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
 
 namespace ndn {
 namespace ndncert {
@@ -39,6 +41,8 @@ security::KeyChain keyChain;
 std::string repoHost = "localhost";
 std::string repoPort = "7376";
 const size_t MAX_CACHED_CERT_NUM = 100;
+std::string metricsFile;
+time::seconds metricsInterval(10);
 
 static bool
 writeDataToRepo(const Data& data) {
@@ -59,6 +63,18 @@ writeDataToRepo(const Data& data) {
   return true;
 }
 
+static void
+writeMetrics(Scheduler& scheduler, const CaHost& host)
+{
+  try {
+    writePrometheusFile(metricsFile, host.collectMetrics());
+  }
+  catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+  }
+  scheduler.schedule(metricsInterval, [&] { writeMetrics(scheduler, host); });
+}
+
 static void
 handleSignal(const boost::system::error_code& error, int signalNum)
 {
@@ -88,15 +104,24 @@ main(int argc, char* argv[])
 
   std::string configFilePath(NDNCERT_SYSCONFDIR "/ndncert/ca.conf");
   bool wantRepoOut = false;
+  int metricsIntervalSeconds = metricsInterval.count();
+  std::string auditLogFile;
 
   namespace po = boost::program_options;
   po::options_description optsDesc("Options");
   optsDesc.add_options()
   ("help,h", "print this help message and exit")
-  ("config-file,c", po::value<std::string>(&configFilePath)->default_value(configFilePath), "path to configuration file")
+  ("config-file,c", po::value<std::string>(&configFilePath)->default_value(configFilePath),
+   "path to configuration file, either of one CA or listing the CAs to host in this process")
   ("repo-output,r", po::bool_switch(&wantRepoOut), "when enabled, all issued certificates will be published to repo-ng")
   ("repo-host,H", po::value<std::string>(&repoHost)->default_value(repoHost), "repo-ng host")
-  ("repo-port,P", po::value<std::string>(&repoPort)->default_value(repoPort), "repo-ng port");
+  ("repo-port,P", po::value<std::string>(&repoPort)->default_value(repoPort), "repo-ng port")
+  ("metrics-file,m", po::value<std::string>(&metricsFile),
+   "when set, runtime metrics are periodically written to this file in the Prometheus text format")
+  ("metrics-interval", po::value<int>(&metricsIntervalSeconds)->default_value(metricsIntervalSeconds),
+   "seconds between two writes of the metrics file")
+  ("audit-log,a", po::value<std::string>(&auditLogFile),
+   "when set, every status update of a request is appended to this file as a JSON Lines record");
 
   po::variables_map vm;
   try {
@@ -119,38 +144,63 @@ main(int argc, char* argv[])
     return 0;
   }
 
-  CaModule ca(face, keyChain, configFilePath);
+  if (metricsIntervalSeconds <= 0) {
+    std::cerr << "ERROR: metrics-interval must be positive" << std::endl;
+    return 2;
+  }
+  metricsInterval = time::seconds(metricsIntervalSeconds);
+
+  CaHost host(face, keyChain, configFilePath);
   std::deque<Data> cachedCertificates;
-  auto profileData = ca.getCaProfileData();
+
+  if (!auditLogFile.empty()) {
+    AuditLogWriter::attach(host.getEventBus(), auditLogFile);
+  }
 
   if (wantRepoOut) {
-    writeDataToRepo(profileData);
-    ca.setStatusUpdateCallback([&](const RequestState& request) {
+    host.forEachCa([] (CaModule& ca) {
+      writeDataToRepo(ca.getCaProfileData());
+    });
+    // runs on the thread of the subscriber, so a slow repo never holds up the CA; the certificates
+    // issued while its queue is full are not published, and are counted in the metrics as dropped
+    host.getEventBus().subscribe([] (const StatusEvent& event) {
+      const auto& request = event.request;
       if (request.status == Status::SUCCESS && request.requestType == RequestType::NEW) {
         writeDataToRepo(request.cert);
       }
     });
   }
   else {
-    ca.setStatusUpdateCallback([&](const RequestState& request) {
+    host.getEventBus().subscribe([&] (const StatusEvent& event) {
+      const auto& request = event.request;
       if (request.status == Status::SUCCESS && request.requestType == RequestType::NEW) {
-        cachedCertificates.push_front(request.cert);
-        if (cachedCertificates.size() > MAX_CACHED_CERT_NUM) {
-          cachedCertificates.pop_back();
-        }
+        // the cache is read by the Interest filters on the face thread
+        face.getIoService().post([&, cert = request.cert] {
+          cachedCertificates.push_front(cert);
+          if (cachedCertificates.size() > MAX_CACHED_CERT_NUM) {
+            cachedCertificates.pop_back();
+          }
+        });
       }
     });
-    face.setInterestFilter(
-        InterestFilter(ca.getCaConf().caProfile.caPrefix),
-        [&](const InterestFilter&, const Interest& interest) {
+    host.forEachCa([&] (CaModule& hostedCa) {
+      face.setInterestFilter(
+        InterestFilter(hostedCa.getCaConf().caProfile.caPrefix),
+        [&, &ca = hostedCa](const InterestFilter&, const Interest& interest) {
           const auto& interestName = interest.getName();
-          if (interestName.isPrefixOf(profileData.getName())) {
-            face.put(profileData);
+          // the filters of nested CA prefixes may all match; only the longest one answers
+          if (host.findCa(interestName) != &ca) {
+            return;
+          }
+          // the profile is cached by the CA and changes when its configuration is reloaded
+          auto caProfileData = ca.getCaProfileData();
+          if (interestName.isPrefixOf(caProfileData.getName())) {
+            face.put(caProfileData);
             return;
           }
-          for (const auto& item : cachedCertificates) {
-            if (interestName.isPrefixOf(item.getFullName())) {
-              face.put(item);
+          for (const auto& cert : cachedCertificates) {
+            if (interestName.isPrefixOf(cert.getFullName())) {
+              face.put(cert);
               return;
             }
           }
@@ -158,6 +208,36 @@ main(int argc, char* argv[])
         [](const Name&, const std::string& errorInfo) {
           std::cerr << "ERROR: " << errorInfo << std::endl;
         });
+    });
+  }
+
+  // SIGHUP reloads the configuration of every hosted CA, without dropping requests in progress
+  boost::asio::signal_set reloadSignals(face.getIoService(), SIGHUP);
+  function<void(const boost::system::error_code&, int)> onReloadSignal =
+    [&] (const boost::system::error_code& error, int) {
+      if (error) {
+        return;
+      }
+      host.forEachCa([&] (CaModule& hostedCa) {
+        hostedCa.reloadConfig([&, &ca = hostedCa] (const std::string& reloadError) {
+          if (!reloadError.empty()) {
+            std::cerr << "ERROR: Cannot reload the configuration of " << ca.getCaConf().caProfile.caPrefix
+                      << ": " << reloadError << std::endl;
+            return;
+          }
+          std::cerr << "Reloaded the configuration of " << ca.getCaConf().caProfile.caPrefix << std::endl;
+          if (wantRepoOut) {
+            writeDataToRepo(ca.getCaProfileData());
+          }
+        });
+      });
+      reloadSignals.async_wait(onReloadSignal);
+    };
+  reloadSignals.async_wait(onReloadSignal);
+
+  Scheduler scheduler(face.getIoService());
+  if (!metricsFile.empty()) {
+    writeMetrics(scheduler, host);
   }
 
   face.processEvents();
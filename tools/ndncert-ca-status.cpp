@@ -34,13 +34,16 @@ main(int argc, char* argv[])
 {
   namespace po = boost::program_options;
   std::string caNameString = "";
+  std::string dbPath = "";
   po::options_description description(
-    "Usage: ndncert-ca-status [-h] caName\n"
+    "Usage: ndncert-ca-status [-h] [-d dbPath] caName\n"
     "\n"
     "Options");
   description.add_options()
     ("help,h", "produce help message")
-    ("caName", po::value<std::string>(&caNameString), "CA Identity Name, e.g., /example");
+    ("caName", po::value<std::string>(&caNameString), "CA Identity Name, e.g., /example")
+    ("db-path,d", po::value<std::string>(&dbPath),
+     "database shared by the CAs hosted in one process, the storage-path of its configuration");
   po::positional_options_description p;
   p.add("caName", 1);
   po::variables_map vm;
@@ -61,9 +64,9 @@ main(int argc, char* argv[])
     return 2;
   }
 
-  CaSqlite storage(Name(caNameString), "");
+  CaSqlite storage(Name(caNameString), dbPath);
   std::list<RequestState> requestList;
-  requestList = storage.listAllRequests();
+  requestList = storage.listAllRequests(Name(caNameString));
   std::cerr << "The pending requests are :" << std::endl;
   for (const auto& entry : requestList) {
     std::cerr << "***************************************\n"
@@ -0,0 +1,281 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017-2020, Regents of the University of California.
+ *
+ * This file is part of ndncert, a certificate management system based on NDN.
+ *
+ * ndncert is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndncert is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndncert, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndncert authors and contributors.
+ */
+
+#include "requester-engine.hpp"
+#include "requester-renewal.hpp"
+#include "detail/profile-storage.hpp"
+#include <boost/asio.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <iostream>
+#include <ndn-cxx/face.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
+
+namespace ndn {
+namespace ndncert {
+namespace requester {
+
+Face face;
+security::KeyChain keyChain;
+
+/**
+ * @brief Renews the certificates tracked by a RenewalScheduler, one EnrollmentEngine per CA.
+ */
+class Renewer : noncopyable
+{
+public:
+  Renewer(const ProfileStorage& profiles, RenewalScheduler& renewals, const std::string& stateFile,
+          size_t maxInFlight, const std::string& challengeType,
+          const std::multimap<std::string, std::string>& challengeParameters)
+    : m_renewals(renewals)
+    , m_stateFile(stateFile)
+    , m_maxInFlight(maxInFlight)
+    , m_challengeType(challengeType)
+    , m_challengeParameters(challengeParameters)
+    , m_scheduler(face.getIoService())
+  {
+    EnrollmentOptions options;
+    options.maxInFlight = maxInFlight;
+    for (const auto& profile : profiles.getKnownProfiles()) {
+      auto engine = std::make_unique<EnrollmentEngine>(face, keyChain, profile, options);
+      engine->setResultCallback(bind(&Renewer::onResult, this, _1, _2, _3));
+      m_engines[profile.caPrefix] = std::move(engine);
+    }
+  }
+
+  /**
+   * @brief Start the renewals that are due, and wake up again at the next deadline.
+   */
+  void
+  run()
+  {
+    auto now = time::system_clock::now();
+    if (m_nInFlight < m_maxInFlight) {
+      for (auto& entry : m_renewals.popDue(now, m_maxInFlight - m_nInFlight)) {
+        std::cerr << "Renewing " << entry.certName << std::endl;
+        EnrollmentTask task;
+        task.identityName = entry.identityName;
+        task.challengeType = m_challengeType;
+        task.challengeParameters = m_challengeParameters;
+        m_nInFlight++;
+        m_engines.at(entry.caPrefix)->enroll({std::move(task)});
+      }
+    }
+
+    // with every slot taken, the next finished renewal wakes the renewer up
+    m_wakeup.cancel();
+    auto nextDeadline = m_renewals.getNextDeadline();
+    if (m_nInFlight < m_maxInFlight && nextDeadline) {
+      // wake up at least hourly, in case the system clock is adjusted
+      auto delay = std::min(time::duration_cast<time::milliseconds>(*nextDeadline - now),
+                            time::milliseconds(time::hours(1)));
+      m_wakeup = m_scheduler.schedule(std::max(delay, time::milliseconds::zero()), [this] { run(); });
+    }
+  }
+
+  void
+  saveState() const
+  {
+    try {
+      m_renewals.save(m_stateFile);
+    }
+    catch (const std::exception& e) {
+      std::cerr << "ERROR: Cannot save the renewal state: " << e.what() << std::endl;
+    }
+  }
+
+private:
+  void
+  onResult(const Name& identityName, const shared_ptr<security::Certificate>& cert, const std::string& error)
+  {
+    m_nInFlight--;
+    if (error.empty() && cert != nullptr) {
+      try {
+        auto key = keyChain.getPib().getIdentity(identityName).getKey(cert->getKeyName());
+        keyChain.setDefaultCertificate(key, *cert);
+      }
+      catch (const std::exception& e) {
+        std::cerr << "ERROR: Cannot make " << cert->getName() << " the default certificate: " << e.what()
+                  << std::endl;
+      }
+      m_renewals.add(*cert);
+      std::cerr << "Renewed " << cert->getName() << std::endl;
+    }
+    else {
+      m_renewals.reportFailure(identityName, time::system_clock::now());
+      std::cerr << "ERROR: Cannot renew the certificate of " << identityName << ": " << error << std::endl;
+    }
+    saveState();
+    run();
+  }
+
+private:
+  RenewalScheduler& m_renewals;
+  std::string m_stateFile;
+  size_t m_maxInFlight;
+  size_t m_nInFlight = 0;
+  std::string m_challengeType;
+  std::multimap<std::string, std::string> m_challengeParameters;
+  std::map<Name, unique_ptr<EnrollmentEngine>> m_engines;
+  Scheduler m_scheduler;
+  scheduler::ScopedEventId m_wakeup;
+};
+
+static void
+handleSignal(const boost::system::error_code& error, int signalNum)
+{
+  if (error) {
+    return;
+  }
+  const char* signalName = ::strsignal(signalNum);
+  std::cerr << "Exiting on signal ";
+  if (signalName == nullptr) {
+    std::cerr << signalNum;
+  }
+  else {
+    std::cerr << signalName;
+  }
+  std::cerr << std::endl;
+  face.getIoService().stop();
+}
+
+static int
+main(int argc, char* argv[])
+{
+  boost::asio::signal_set terminateSignals(face.getIoService());
+  terminateSignals.add(SIGINT);
+  terminateSignals.add(SIGTERM);
+  terminateSignals.async_wait(handleSignal);
+
+  std::string configFilePath(NDNCERT_SYSCONFDIR "/ndncert/client.conf");
+  std::string stateFilePath(NDNCERT_LOCALSTATEDIR "/lib/ndncert/renewd.json");
+  size_t maxInFlight = 16;
+  std::string challengeType;
+  std::vector<std::string> challengeParameterStrings;
+  RenewalOptions renewalOptions;
+
+  namespace po = boost::program_options;
+  po::options_description optsDesc("Options");
+  optsDesc.add_options()
+  ("help,h", "print this help message and exit")
+  ("config-file,c", po::value<std::string>(&configFilePath)->default_value(configFilePath),
+   "path to the client configuration file listing the CAs whose certificates are renewed")
+  ("state-file,s", po::value<std::string>(&stateFilePath)->default_value(stateFilePath),
+   "file keeping the renewal deadlines across restarts")
+  ("max-in-flight,n", po::value<size_t>(&maxInFlight)->default_value(maxInFlight),
+   "maximum number of renewals in progress at the same time")
+  ("challenge,C", po::value<std::string>(&challengeType), "challenge used for every renewal")
+  ("parameter,p", po::value<std::vector<std::string>>(&challengeParameterStrings)->composing(),
+   "challenge parameter as key=value, may be repeated")
+  ("renew-at", po::value<double>(&renewalOptions.renewAt)->default_value(renewalOptions.renewAt),
+   "fraction of the validity period after which a certificate is renewed")
+  ("jitter", po::value<double>(&renewalOptions.jitter)->default_value(renewalOptions.jitter),
+   "fraction of the validity period over which renewals are randomly spread");
+
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, optsDesc), vm);
+    po::notify(vm);
+  }
+  catch (const po::error& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 2;
+  }
+  catch (const boost::bad_any_cast& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 2;
+  }
+
+  if (vm.count("help") != 0) {
+    std::cout << "Usage: " << argv[0] << " [options]\n"
+              << "\n"
+              << optsDesc;
+    return 0;
+  }
+
+  if (challengeType.empty()) {
+    std::cerr << "ERROR: you must specify a challenge." << std::endl;
+    return 2;
+  }
+  if (maxInFlight == 0) {
+    std::cerr << "ERROR: max-in-flight must be positive" << std::endl;
+    return 2;
+  }
+  if (renewalOptions.renewAt <= 0.0 || renewalOptions.renewAt >= 1.0 ||
+      renewalOptions.jitter < 0.0 || renewalOptions.jitter > renewalOptions.renewAt) {
+    std::cerr << "ERROR: renew-at must be between 0 and 1, and jitter between 0 and renew-at" << std::endl;
+    return 2;
+  }
+  std::multimap<std::string, std::string> challengeParameters;
+  for (const auto& parameter : challengeParameterStrings) {
+    auto pos = parameter.find('=');
+    if (pos == std::string::npos) {
+      std::cerr << "ERROR: challenge parameter " << parameter << " is not in the form key=value" << std::endl;
+      return 2;
+    }
+    challengeParameters.emplace(parameter.substr(0, pos), parameter.substr(pos + 1));
+  }
+
+  ProfileStorage profiles;
+  try {
+    profiles.load(configFilePath);
+  }
+  catch (const std::exception& e) {
+    std::cerr << "ERROR: Cannot load the configuration file: " << e.what() << std::endl;
+    return 1;
+  }
+  std::vector<Name> caPrefixes;
+  for (const auto& profile : profiles.getKnownProfiles()) {
+    caPrefixes.push_back(profile.caPrefix);
+  }
+
+  RenewalScheduler renewals(caPrefixes, renewalOptions);
+  if (boost::filesystem::exists(stateFilePath)) {
+    try {
+      renewals.load(stateFilePath);
+    }
+    catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << ", starting afresh" << std::endl;
+    }
+  }
+  // the only full scan of the KeyChain; renewed certificates are added as they are issued
+  std::cerr << "Tracking " << renewals.scan(keyChain.getPib()) << " identities" << std::endl;
+
+  Renewer renewer(profiles, renewals, stateFilePath, maxInFlight, challengeType, challengeParameters);
+  renewer.saveState();
+  renewer.run();
+
+  face.processEvents();
+  renewer.saveState();
+  return 0;
+}
+
+} // namespace requester
+} // namespace ndncert
+} // namespace ndn
+
+int
+main(int argc, char* argv[])
+{
+  return ndn::ndncert::requester::main(argc, argv);
+}